@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2023 Maikel Nadolski
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares concrete sender pipelines with type-erased ones.
+//
+// usage: any_sender [iterations]
+//
+// Every pipeline starts with a schedule on one of inline_scheduler, run_loop or
+// static_thread_pool and produces an int. It is measured in three variants:
+//
+//   concrete: the pipeline as it is, on the concrete scheduler
+//   erased:   the whole pipeline in one any_sender, on an any_scheduler
+//   stages:   every stage of the pipeline in its own any_sender, on an any_scheduler
+//
+// One iteration builds the sender, connects it, starts it and waits for its completion. The
+// table shows the time and the number of heap allocations per iteration and the size of the
+// outermost operation state.
+
+#include "exec/any_sender_of.hpp"
+#include "exec/inline_scheduler.hpp"
+#include "exec/static_thread_pool.hpp"
+
+#include "stdexec/execution.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <utility>
+
+namespace {
+  std::atomic<std::size_t> n_allocations{0};
+}
+
+void* operator new(std::size_t size) {
+  n_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* pointer = std::malloc(size)) {
+    return pointer;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+namespace {
+  using namespace stdexec;
+
+  using int_sender = exec::any_receiver_ref<completion_signatures<
+    set_value_t(int),
+    set_error_t(std::exception_ptr),
+    set_stopped_t()>>::any_sender<>;
+
+  using any_scheduler = exec::any_receiver_ref<
+    completion_signatures<set_error_t(std::exception_ptr), set_stopped_t()>>::any_sender<>::
+    any_scheduler<>;
+
+  enum class variant {
+    concrete,
+    erased,
+    stages
+  };
+
+  const char* name_of(variant v) {
+    switch (v) {
+    case variant::concrete:
+      return "concrete";
+    case variant::erased:
+      return "erased";
+    case variant::stages:
+      return "stages";
+    }
+    return "";
+  }
+
+  struct receiver {
+    using is_receiver = void;
+    std::atomic<bool>* done;
+
+    void complete() noexcept {
+      done->store(true, std::memory_order_release);
+    }
+
+    friend void tag_invoke(set_value_t, receiver&& self, int) noexcept {
+      self.complete();
+    }
+
+    friend void tag_invoke(set_error_t, receiver&& self, std::exception_ptr) noexcept {
+      self.complete();
+    }
+
+    friend void tag_invoke(set_stopped_t, receiver&& self) noexcept {
+      self.complete();
+    }
+
+    friend empty_env tag_invoke(get_env_t, const receiver&) noexcept {
+      return {};
+    }
+  };
+
+  // Applies a stage to a sender and erases the result for the stages variant
+  template <variant V, class Sender, class Stage>
+  auto apply_stage(Sender&& sender, Stage stage) {
+    if constexpr (V == variant::stages) {
+      return int_sender{stage((Sender&&) sender)};
+    } else {
+      return stage((Sender&&) sender);
+    }
+  }
+
+  template <variant V, class Sender>
+  auto finish(Sender&& sender) {
+    if constexpr (V == variant::concrete) {
+      return (Sender&&) sender;
+    } else {
+      return int_sender{(Sender&&) sender};
+    }
+  }
+
+  template <variant V, class Scheduler>
+  auto source(Scheduler sched) {
+    return apply_stage<V>(schedule(sched), [](auto&& sender) {
+      return (decltype(sender)&&) sender | then([] { return 0; });
+    });
+  }
+
+  template <variant V, int Depth, class Scheduler>
+  auto then_chain(Scheduler sched) {
+    if constexpr (Depth == 0) {
+      return source<V>(sched);
+    } else {
+      return apply_stage<V>(then_chain<V, Depth - 1>(sched), [](auto&& sender) {
+        return (decltype(sender)&&) sender | then([](int value) { return value + 1; });
+      });
+    }
+  }
+
+  template <variant V, int Depth, class Scheduler>
+  auto let_value_chain(Scheduler sched) {
+    if constexpr (Depth == 0) {
+      return source<V>(sched);
+    } else {
+      return apply_stage<V>(let_value_chain<V, Depth - 1>(sched), [](auto&& sender) {
+        return (decltype(sender)&&) sender | let_value([](int value) { return just(value + 1); });
+      });
+    }
+  }
+
+  template <variant V, class Scheduler, std::size_t... Is>
+  auto when_all_of(Scheduler sched, std::index_sequence<Is...>) {
+    return when_all(((void) Is, source<V>(sched))...)
+         | then([](auto... values) { return (values + ...); });
+  }
+
+  struct result {
+    double nanoseconds;
+    double allocations;
+    std::size_t op_size;
+  };
+
+  // Runs the pipeline that is returned by make_sender iterations times. The driver is called
+  // after start and runs the scheduler until the operation has completed.
+  template <class MakeSender, class Drive>
+  result measure(std::size_t iterations, MakeSender make_sender, Drive drive) {
+    using op_t = connect_result_t<decltype(make_sender()), receiver>;
+    std::atomic<bool> done{false};
+    const std::size_t allocations_before = n_allocations.load();
+    const auto start_time = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+      done.store(false, std::memory_order_relaxed);
+      auto op = connect(make_sender(), receiver{&done});
+      start(op);
+      drive(done);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start_time;
+    const std::size_t allocations = n_allocations.load() - allocations_before;
+    return {
+      std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations),
+      static_cast<double>(allocations) / static_cast<double>(iterations),
+      sizeof(op_t)};
+  }
+
+  void print(const char* scheduler, const std::string& pipeline, variant v, result r) {
+    std::printf(
+      "%-18s %-14s %-9s %10.1f %10.2f %10zu\n",
+      scheduler,
+      pipeline.c_str(),
+      name_of(v),
+      r.nanoseconds,
+      r.allocations,
+      r.op_size);
+  }
+
+  template <variant V, class Scheduler, class Drive>
+  void run_pipelines(
+    const char* name,
+    Scheduler concrete_sched,
+    std::size_t iterations,
+    Drive drive) {
+    auto sched = [&] {
+      if constexpr (V == variant::concrete) {
+        return concrete_sched;
+      } else {
+        return any_scheduler{concrete_sched};
+      }
+    }();
+    auto bench = [&](const std::string& pipeline, auto make_sender) {
+      print(name, pipeline, V, measure(iterations, make_sender, drive));
+    };
+    bench("then x1", [&] { return finish<V>(then_chain<V, 1>(sched)); });
+    bench("then x4", [&] { return finish<V>(then_chain<V, 4>(sched)); });
+    bench("then x16", [&] { return finish<V>(then_chain<V, 16>(sched)); });
+    bench("let_value x1", [&] { return finish<V>(let_value_chain<V, 1>(sched)); });
+    bench("let_value x4", [&] { return finish<V>(let_value_chain<V, 4>(sched)); });
+    bench("when_all x2", [&] {
+      return finish<V>(when_all_of<V>(sched, std::make_index_sequence<2>{}));
+    });
+    bench("when_all x4", [&] {
+      return finish<V>(when_all_of<V>(sched, std::make_index_sequence<4>{}));
+    });
+  }
+
+  template <class Scheduler, class Drive>
+  void run_all_variants(
+    const char* name,
+    Scheduler sched,
+    std::size_t iterations,
+    Drive drive) {
+    run_pipelines<variant::concrete>(name, sched, iterations, drive);
+    run_pipelines<variant::erased>(name, sched, iterations, drive);
+    run_pipelines<variant::stages>(name, sched, iterations, drive);
+  }
+}
+
+int main(int argc, char** argv) {
+  const std::size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000;
+
+  std::printf(
+    "%-18s %-14s %-9s %10s %10s %10s\n",
+    "scheduler",
+    "pipeline",
+    "variant",
+    "ns/op",
+    "allocs/op",
+    "op size");
+
+  run_all_variants(
+    "inline_scheduler", exec::inline_scheduler{}, iterations, [](std::atomic<bool>&) {
+    });
+
+  // After finish, run drains the queue and returns as soon as it is empty
+  run_loop loop;
+  loop.finish();
+  run_all_variants("run_loop", loop.get_scheduler(), iterations, [&](std::atomic<bool>&) {
+    loop.run();
+  });
+
+  exec::static_thread_pool pool{1};
+  run_all_variants(
+    "static_thread_pool", pool.get_scheduler(), iterations, [](std::atomic<bool>& done) {
+      while (!done.load(std::memory_order_acquire)) {
+      }
+    });
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2023 Maikel Nadolski
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares the throughput of buffered and direct sequential reads of a local file.
+//
+// usage: io_uring_direct_io [directory] [file size in MiB] [block size in KiB] [queue depth]
+//
+// The file is created in the given directory, which has to be on a file system that supports
+// O_DIRECT. Buffered reads are measured twice: once with a cold page cache and once with a warm
+// one. Direct reads bypass the page cache and use buffers that are registered with the ring.
+
+#include "exec/async_scope.hpp"
+#include "exec/linux/aligned_buffer_pool.hpp"
+#include "exec/linux/io_uring_context.hpp"
+
+#include "stdexec/execution.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+  struct options {
+    const char* directory = ".";
+    std::size_t file_size = std::size_t{256} << 20;
+    std::size_t block_size = std::size_t{64} << 10;
+    std::size_t queue_depth = 16;
+  };
+
+  options parse_options(int argc, char** argv) {
+    options opts{};
+    if (argc > 1) {
+      opts.directory = argv[1];
+    }
+    if (argc > 2) {
+      opts.file_size = std::strtoull(argv[2], nullptr, 10) << 20;
+    }
+    if (argc > 3) {
+      opts.block_size = std::strtoull(argv[3], nullptr, 10) << 10;
+    }
+    if (argc > 4) {
+      opts.queue_depth = std::strtoull(argv[4], nullptr, 10);
+    }
+    return opts;
+  }
+
+  // Reads the whole file with up to queue_depth reads in flight and returns the throughput in
+  // MiB/s.
+  template <class ReadBlock>
+  double measure(const options& opts, ReadBlock read_block) {
+    exec::async_scope scope;
+    const std::size_t n_blocks = opts.file_size / opts.block_size;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t first = 0; first < n_blocks; first += opts.queue_depth) {
+      const std::size_t last = std::min(first + opts.queue_depth, n_blocks);
+      for (std::size_t block = first; block < last; ++block) {
+        scope.spawn(read_block(block - first, block * opts.block_size));
+      }
+      stdexec::sync_wait(scope.on_empty());
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(opts.file_size >> 20) / elapsed.count();
+  }
+
+  void drop_page_cache(int fd) {
+    ::fdatasync(fd);
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  }
+}
+
+int main(int argc, char** argv) {
+  const options opts = parse_options(argc, argv);
+  exec::safe_file_descriptor file{::open(opts.directory, O_TMPFILE | O_RDWR, 0600)};
+  if (!file) {
+    std::cerr << "Cannot create a temporary file in " << opts.directory << ": "
+              << std::strerror(errno) << '\n';
+    return EXIT_FAILURE;
+  }
+  const std::string path = "/proc/self/fd/" + std::to_string(static_cast<int>(file));
+  exec::safe_file_descriptor direct_file{::open(path.c_str(), O_RDONLY | O_DIRECT)};
+  if (!direct_file) {
+    std::cerr << "The file system of " << opts.directory
+              << " does not support O_DIRECT: " << std::strerror(errno) << '\n';
+    return EXIT_FAILURE;
+  }
+
+  std::vector<char> block(opts.block_size, 'x');
+  for (std::size_t offset = 0; offset < opts.file_size; offset += block.size()) {
+    if (::pwrite(file, block.data(), block.size(), static_cast<::off_t>(offset)) < 0) {
+      std::cerr << "Cannot write the file: " << std::strerror(errno) << '\n';
+      return EXIT_FAILURE;
+    }
+  }
+
+  exec::io_uring_context context;
+  exec::aligned_buffer_pool pool{opts.queue_depth, opts.block_size};
+  context.register_buffers(pool.iovecs());
+  std::vector<exec::aligned_buffer> buffers;
+  for (std::size_t i = 0; i < opts.queue_depth; ++i) {
+    buffers.push_back(pool.try_acquire());
+  }
+  std::thread io_thread{[&] {
+    context.run_until_stopped();
+  }};
+  auto scheduler = context.get_scheduler();
+
+  auto buffered_read = [&](std::size_t slot, std::size_t offset) {
+    return exec::async_read(
+             scheduler, file, buffers[slot].data(), static_cast<std::int64_t>(offset))
+         | stdexec::then([](std::size_t) {});
+  };
+  auto direct_read = [&](std::size_t slot, std::size_t offset) {
+    return exec::async_read_direct(
+             scheduler,
+             direct_file,
+             buffers[slot].data(),
+             static_cast<std::int64_t>(offset),
+             pool.alignment(),
+             buffers[slot].index())
+         | stdexec::then([](std::size_t) {});
+  };
+
+  drop_page_cache(file);
+  const double buffered_cold = measure(opts, buffered_read);
+  const double buffered_warm = measure(opts, buffered_read);
+  drop_page_cache(file);
+  const double direct = measure(opts, direct_read);
+
+  context.request_stop();
+  io_thread.join();
+
+  std::cout << "file size:     " << (opts.file_size >> 20) << " MiB\n"
+            << "block size:    " << (opts.block_size >> 10) << " KiB\n"
+            << "queue depth:   " << opts.queue_depth << '\n'
+            << "buffered cold: " << buffered_cold << " MiB/s\n"
+            << "buffered warm: " << buffered_warm << " MiB/s\n"
+            << "direct:        " << direct << " MiB/s\n";
+}
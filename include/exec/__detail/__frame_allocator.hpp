@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../../stdexec/concepts.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace exec {
+  // Coroutine frames are allocated in units of __frame_block, so that the memory behind a frame
+  // is suitably aligned for the bookkeeping that is stored there.
+  struct alignas(std::max_align_t) __frame_block {
+    std::byte __storage_[alignof(std::max_align_t)];
+  };
+
+  constexpr std::size_t __frame_blocks(std::size_t __bytes) noexcept {
+    return (__bytes + sizeof(__frame_block) - 1) / sizeof(__frame_block);
+  }
+
+  // A cache of coroutine frames for the calling thread. Freed frames are kept in a free list per
+  // size class and are handed out again to frames of the same class. Frames that are larger than
+  // the largest class come from the global operator new.
+  class __frame_pool {
+    static constexpr std::size_t __blocks_per_class = 64 / sizeof(__frame_block);
+    static constexpr std::size_t __n_classes = 32;
+    static constexpr std::size_t __max_free_per_class = 16;
+
+    struct __free_frame {
+      __free_frame* __next_;
+    };
+
+    __free_frame* __free_[__n_classes]{};
+    std::size_t __n_free_[__n_classes]{};
+
+    static constexpr std::size_t __class_of(std::size_t __bytes) noexcept {
+      return (__frame_blocks(__bytes) + __blocks_per_class - 1) / __blocks_per_class - 1;
+    }
+
+   public:
+    __frame_pool() = default;
+    __frame_pool(__frame_pool&&) = delete;
+
+    ~__frame_pool() {
+      for (__free_frame*& __head: __free_) {
+        while (__head != nullptr) {
+          ::operator delete(std::exchange(__head, __head->__next_));
+        }
+      }
+    }
+
+    // Frames may be freed by the destructors of other thread_local objects after the pool of the
+    // thread has been destroyed. There is no pool then, and frames come from the global operator
+    // new and delete.
+    static __frame_pool* __this_thread() noexcept {
+      static thread_local bool __is_destroyed = false;
+
+      struct __thread_pool : __frame_pool {
+        ~__thread_pool() {
+          __is_destroyed = true;
+        }
+      };
+
+      static thread_local __thread_pool __pool;
+      return __is_destroyed ? nullptr : &__pool;
+    }
+
+    void* __allocate(std::size_t __bytes) {
+      const std::size_t __class = __class_of(__bytes);
+      if (__class >= __n_classes) {
+        return ::operator new(__bytes);
+      }
+      if (__free_frame* __frame = __free_[__class]) {
+        __free_[__class] = __frame->__next_;
+        --__n_free_[__class];
+        return __frame;
+      }
+      return ::operator new((__class + 1) * __blocks_per_class * sizeof(__frame_block));
+    }
+
+    void __deallocate(void* __pointer, std::size_t __bytes) noexcept {
+      const std::size_t __class = __class_of(__bytes);
+      if (__class < __n_classes && __n_free_[__class] < __max_free_per_class) {
+        __free_[__class] = ::new (__pointer) __free_frame{__free_[__class]};
+        ++__n_free_[__class];
+      } else {
+        ::operator delete(__pointer);
+      }
+    }
+  };
+
+  // Allocation functions for the promise type of a coroutine. A coroutine whose leading
+  // parameters are std::allocator_arg_t and an allocator (after the object parameter of a member
+  // function) allocates its frame with that allocator. All other frames come from the
+  // __frame_pool of the calling thread.
+  //
+  // The function that frees a frame is stored behind the frame, followed by the allocator if
+  // there is one.
+  struct __frame_allocator {
+    static void* operator new(std::size_t __size) {
+      __frame_pool* __pool = __frame_pool::__this_thread();
+      void* __frame = __pool ? __pool->__allocate(__pooled_size(__size))
+                             : ::operator new(__pooled_size(__size));
+      __deallocate_fn_of(__frame, __size) = &__deallocate_pooled;
+      return __frame;
+    }
+
+    template <class _Allocator, class... _Args>
+    STDEXEC_INLINE_OPERATOR_NEW static void* operator new(
+      std::size_t __size,
+      std::allocator_arg_t,
+      const _Allocator& __alloc,
+      const _Args&...) {
+      using _BlockAllocator = __block_allocator_t<_Allocator>;
+      using _Traits = std::allocator_traits<_BlockAllocator>;
+      static_assert(alignof(_BlockAllocator) <= alignof(std::max_align_t));
+      _BlockAllocator __block_alloc(__alloc);
+      void* __frame =
+        std::to_address(_Traits::allocate(__block_alloc, __allocated_blocks<_Allocator>(__size)));
+      ::new (__allocator_address<_Allocator>(__frame, __size))
+        _BlockAllocator((_BlockAllocator&&) __block_alloc);
+      __deallocate_fn_of(__frame, __size) = &__deallocate_with<_Allocator>;
+      return __frame;
+    }
+
+    template <class _Self, class _Allocator, class... _Args>
+      requires(!stdexec::same_as<_Self, std::allocator_arg_t>)
+    STDEXEC_INLINE_OPERATOR_NEW static void* operator new(
+      std::size_t __size,
+      const _Self&,
+      std::allocator_arg_t,
+      const _Allocator& __alloc,
+      const _Args&...) {
+      return __frame_allocator::operator new(__size, std::allocator_arg, __alloc);
+    }
+
+    static void operator delete(void* __frame, std::size_t __size) noexcept {
+      __deallocate_fn_of(__frame, __size)(__frame, __size);
+    }
+
+   private:
+    using __deallocate_fn = void(void*, std::size_t) noexcept;
+
+    template <class _Allocator>
+    using __block_allocator_t =
+      typename std::allocator_traits<_Allocator>::template rebind_alloc<__frame_block>;
+
+    static constexpr std::size_t __trailer_offset(std::size_t __size) noexcept {
+      return __frame_blocks(__size) * sizeof(__frame_block);
+    }
+
+    static constexpr std::size_t __pooled_size(std::size_t __size) noexcept {
+      return __trailer_offset(__size) + sizeof(__deallocate_fn*);
+    }
+
+    template <class _Allocator>
+    static constexpr std::size_t __allocator_offset(std::size_t __size) noexcept {
+      constexpr std::size_t __align = alignof(__block_allocator_t<_Allocator>);
+      return __trailer_offset(__size)
+           + (sizeof(__deallocate_fn*) > __align ? sizeof(__deallocate_fn*) : __align);
+    }
+
+    template <class _Allocator>
+    static constexpr std::size_t __allocated_blocks(std::size_t __size) noexcept {
+      return __frame_blocks(
+        __allocator_offset<_Allocator>(__size) + sizeof(__block_allocator_t<_Allocator>));
+    }
+
+    static __deallocate_fn*& __deallocate_fn_of(void* __frame, std::size_t __size) noexcept {
+      return *static_cast<__deallocate_fn**>(
+        static_cast<void*>(static_cast<std::byte*>(__frame) + __trailer_offset(__size)));
+    }
+
+    template <class _Allocator>
+    static void* __allocator_address(void* __frame, std::size_t __size) noexcept {
+      return static_cast<std::byte*>(__frame) + __allocator_offset<_Allocator>(__size);
+    }
+
+    static void __deallocate_pooled(void* __frame, std::size_t __size) noexcept {
+      if (__frame_pool* __pool = __frame_pool::__this_thread()) {
+        __pool->__deallocate(__frame, __pooled_size(__size));
+      } else {
+        ::operator delete(__frame);
+      }
+    }
+
+    template <class _Allocator>
+    static void __deallocate_with(void* __frame, std::size_t __size) noexcept {
+      using _BlockAllocator = __block_allocator_t<_Allocator>;
+      using _Traits = std::allocator_traits<_BlockAllocator>;
+      void* __address = __allocator_address<_Allocator>(__frame, __size);
+      auto* __stored = std::launder(static_cast<_BlockAllocator*>(__address));
+      _BlockAllocator __block_alloc((_BlockAllocator&&) *__stored);
+      __stored->~_BlockAllocator();
+      _Traits::deallocate(
+        __block_alloc,
+        static_cast<__frame_block*>(__frame),
+        __allocated_blocks<_Allocator>(__size));
+    }
+  };
+} // namespace exec
@@ -290,6 +290,22 @@ namespace exec {
           }
         }
 
+        template <class _Tp, class... _Args>
+          requires __callable<__create_vtable_t, __mtype<_Vtable>, __mtype<_Tp>>
+        __t(
+          std::allocator_arg_t,
+          const _Allocator& __alloc,
+          std::in_place_type_t<_Tp>,
+          _Args&&... __args)
+          : __vtable_{__get_vtable_of_type<_Tp>()}
+          , __allocator_{__alloc} {
+          if constexpr (__is_small<_Tp>) {
+            __construct_small<_Tp>((_Args&&) __args...);
+          } else {
+            __construct_large<_Tp>((_Args&&) __args...);
+          }
+        }
+
         ~__t() {
           __reset();
         }
@@ -464,6 +480,15 @@ namespace exec {
         return __object_pointer_;
       }
 
+      // Returns the stored object if it has the type _Tp, otherwise nullptr
+      template <class _Tp>
+      const _Tp* __target() const noexcept {
+        if (__vtable_ != __get_vtable_of_type<_Tp>()) {
+          return nullptr;
+        }
+        return static_cast<const _Tp*>(__object_pointer_);
+      }
+
      private:
       template <class _Tp, class... _As>
       void __construct_small(_As&&... __args) {
@@ -756,7 +781,120 @@ namespace exec {
       }
     };
 
-    using __immovable_operation_storage = __immovable_storage_t<__operation_vtable>;
+    inline constexpr std::size_t __default_inline_size = 3 * sizeof(void*);
+
+    // The schedule operations of the thread pool, the run loop and the io contexts take a few
+    // pointers. An any_scheduler constructs them in place and only allocates the operations of
+    // larger schedulers.
+    inline constexpr std::size_t __schedule_inline_size = 16 * sizeof(void*);
+
+    // A type-erased allocator for operation states that do not fit into the inline storage of
+    // a type-erased operation. Allocations are counted in blocks of std::max_align_t.
+    struct __operation_resource {
+      void* (*__allocate_)(__operation_resource*, std::size_t);
+      void (*__deallocate_)(__operation_resource*, void*, std::size_t) noexcept;
+    };
+
+    // The resource that uses the allocator of the receiver's environment, if there is one.
+    template <class _Env>
+    struct __env_resource {
+      explicit __env_resource(const _Env&) noexcept {
+      }
+
+      __operation_resource* __get() noexcept {
+        return nullptr;
+      }
+    };
+
+    template <class _Env>
+      requires __callable<get_allocator_t, const _Env&>
+    struct __env_resource<_Env> : __operation_resource {
+      using _Allocator = __decay_t<__call_result_t<get_allocator_t, const _Env&>>;
+      using _BlockAllocator =
+        typename std::allocator_traits<_Allocator>::template rebind_alloc<std::max_align_t>;
+      using _Traits = std::allocator_traits<_BlockAllocator>;
+
+      STDEXEC_NO_UNIQUE_ADDRESS _BlockAllocator __alloc_;
+
+      explicit __env_resource(const _Env& __env) noexcept
+        : __operation_resource{&__allocate, &__deallocate}
+        , __alloc_(get_allocator(__env)) {
+      }
+
+      __operation_resource* __get() noexcept {
+        return this;
+      }
+
+      static void* __allocate(__operation_resource* __self, std::size_t __n_blocks) {
+        __env_resource* __resource = static_cast<__env_resource*>(__self);
+        return std::to_address(_Traits::allocate(__resource->__alloc_, __n_blocks));
+      }
+
+      static void
+        __deallocate(__operation_resource* __self, void* __ptr, std::size_t __n_blocks) noexcept {
+        __env_resource* __resource = static_cast<__env_resource*>(__self);
+        _Traits::deallocate(
+          __resource->__alloc_,
+          std::pointer_traits<typename _Traits::pointer>::pointer_to(
+            *static_cast<std::max_align_t*>(__ptr)),
+          __n_blocks);
+      }
+    };
+
+    // The allocator of type-erased operation states. Without a resource or for over-aligned
+    // types it falls back to std::allocator.
+    template <class _Tp>
+    struct __operation_allocator {
+      using value_type = _Tp;
+
+      __operation_resource* __resource_{nullptr};
+
+      __operation_allocator() = default;
+
+      explicit __operation_allocator(__operation_resource* __resource) noexcept
+        : __resource_{__resource} {
+      }
+
+      template <class _Up>
+      __operation_allocator(const __operation_allocator<_Up>& __other) noexcept
+        : __resource_{__other.__resource_} {
+      }
+
+      static constexpr std::size_t __n_blocks(std::size_t __n) noexcept {
+        return (__n * sizeof(_Tp) + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+      }
+
+      _Tp* allocate(std::size_t __n) {
+        if constexpr (alignof(_Tp) <= alignof(std::max_align_t)) {
+          if (__resource_) {
+            return static_cast<_Tp*>(__resource_->__allocate_(__resource_, __n_blocks(__n)));
+          }
+        }
+        return std::allocator<_Tp>{}.allocate(__n);
+      }
+
+      void deallocate(_Tp* __ptr, std::size_t __n) noexcept {
+        if constexpr (alignof(_Tp) <= alignof(std::max_align_t)) {
+          if (__resource_) {
+            __resource_->__deallocate_(__resource_, __ptr, __n_blocks(__n));
+            return;
+          }
+        }
+        std::allocator<_Tp>{}.deallocate(__ptr, __n);
+      }
+
+      friend bool
+        operator==(const __operation_allocator&, const __operation_allocator&) noexcept = default;
+    };
+
+    template <std::size_t _InlineSize>
+    using __immovable_operation_storage_t = __t<__immovable_storage<
+      __operation_vtable,
+      __operation_allocator<std::byte>,
+      alignof(std::max_align_t),
+      _InlineSize>>;
+
+    using __immovable_operation_storage = __immovable_operation_storage_t<__default_inline_size>;
 
     template <class _Sigs, class _Queries>
     using __receiver_ref = __mapply<__mbind_front<__q<__rec::__ref>, _Sigs>, _Queries>;
@@ -829,7 +967,7 @@ namespace exec {
     template <class _ReceiverId>
     using __stoppable_receiver_t = stdexec::__t<__stoppable_receiver<_ReceiverId>>;
 
-    template <class _ReceiverId, bool>
+    template <class _ReceiverId, bool, std::size_t _InlineSize = __default_inline_size>
     struct __operation {
       using _Receiver = stdexec::__t<_ReceiverId>;
 
@@ -841,12 +979,14 @@ namespace exec {
         __t(_Sender&& __sender, _Receiver&& __receiver)
           : __operation_base<_Receiver>{static_cast<_Receiver&&>(__receiver)}
           , __rec_{this}
-          , __storage_{__sender.__connect(__rec_)} {
+          , __resource_{get_env(this->__rcvr_)}
+          , __storage_{__sender.__connect(__rec_, __resource_.__get())} {
         }
 
        private:
         __stoppable_receiver_t<_ReceiverId> __rec_;
-        __immovable_operation_storage __storage_{};
+        STDEXEC_NO_UNIQUE_ADDRESS __env_resource<env_of_t<_Receiver>> __resource_;
+        __immovable_operation_storage_t<_InlineSize> __storage_{};
 
         friend void tag_invoke(start_t, __t& __self) noexcept {
           __self.__on_stop_.emplace(
@@ -858,8 +998,8 @@ namespace exec {
       };
     };
 
-    template <class _ReceiverId>
-    struct __operation<_ReceiverId, false> {
+    template <class _ReceiverId, std::size_t _InlineSize>
+    struct __operation<_ReceiverId, false, _InlineSize> {
       using _Receiver = stdexec::__t<_ReceiverId>;
 
       class __t {
@@ -869,12 +1009,14 @@ namespace exec {
         template <class _Sender>
         __t(_Sender&& __sender, _Receiver&& __receiver)
           : __rec_{static_cast<_Receiver&&>(__receiver)}
-          , __storage_{__sender.__connect(__rec_)} {
+          , __resource_{get_env(__rec_)}
+          , __storage_{__sender.__connect(__rec_, __resource_.__get())} {
         }
 
        private:
         STDEXEC_NO_UNIQUE_ADDRESS _Receiver __rec_;
-        __immovable_operation_storage __storage_{};
+        STDEXEC_NO_UNIQUE_ADDRESS __env_resource<env_of_t<_Receiver>> __resource_;
+        __immovable_operation_storage_t<_InlineSize> __storage_{};
 
         friend void tag_invoke(start_t, __t& __self) noexcept {
           STDEXEC_ASSERT(__self.__storage_.__get_vtable()->__start_);
@@ -901,9 +1043,14 @@ namespace exec {
       }
     };
 
-    template <class _Sigs, class _SenderQueries = __types<>, class _ReceiverQueries = __types<>>
+    template <
+      class _Sigs,
+      class _SenderQueries = __types<>,
+      class _ReceiverQueries = __types<>,
+      std::size_t _InlineSize = __default_inline_size>
     struct __sender {
       using __receiver_ref_t = __receiver_ref<_Sigs, _ReceiverQueries>;
+      using __operation_storage_t = __immovable_operation_storage_t<_InlineSize>;
       static constexpr bool __with_in_place_stop_token =
         __v<__mapply<__mall_of<__q<__is_not_stop_token_query_v>>, _ReceiverQueries>>;
 
@@ -915,19 +1062,23 @@ namespace exec {
           return *this;
         }
 
-        __immovable_operation_storage (*__connect_)(void*, __receiver_ref_t);
+        __operation_storage_t (*__connect_)(void*, __receiver_ref_t, __operation_resource*);
        private:
         template <sender_to<__receiver_ref_t> _Sender>
         friend const __vtable*
           tag_invoke(__create_vtable_t, __mtype<__vtable>, __mtype<_Sender>) noexcept {
           static const __vtable __vtable_{
             {*__create_vtable(__mtype<__query_vtable<_SenderQueries>>{}, __mtype<_Sender>{})},
-            [](void* __object_pointer, __receiver_ref_t __receiver)
-              -> __immovable_operation_storage {
+            [](void* __object_pointer,
+               __receiver_ref_t __receiver,
+               __operation_resource* __resource) -> __operation_storage_t {
               _Sender& __sender = *static_cast<_Sender*>(__object_pointer);
               using __op_state_t = connect_result_t<_Sender, __receiver_ref_t>;
-              return __immovable_operation_storage{
-                std::in_place_type<__op_state_t>, __conv{[&] {
+              return __operation_storage_t{
+                std::allocator_arg,
+                __operation_allocator<std::byte>{__resource},
+                std::in_place_type<__op_state_t>,
+                __conv{[&] {
                   return stdexec::connect((_Sender&&) __sender, (__receiver_ref_t&&) __receiver);
                 }}};
             }};
@@ -972,9 +1123,10 @@ namespace exec {
           : __storage_{(_Sender&&) __sndr} {
         }
 
-        __immovable_operation_storage __connect(__receiver_ref_t __receiver) {
+        __operation_storage_t
+          __connect(__receiver_ref_t __receiver, __operation_resource* __resource) {
           return __storage_.__get_vtable()->__connect_(
-            __storage_.__get_object_pointer(), (__receiver_ref_t&&) __receiver);
+            __storage_.__get_object_pointer(), (__receiver_ref_t&&) __receiver, __resource);
         }
 
         explicit operator bool() const noexcept {
@@ -985,7 +1137,8 @@ namespace exec {
         __unique_storage_t<__vtable> __storage_;
 
         template <receiver_of<_Sigs> _Rcvr>
-        friend stdexec::__t<__operation<stdexec::__id<__decay_t<_Rcvr>>, __with_in_place_stop_token>>
+        friend stdexec::__t<
+          __operation<stdexec::__id<__decay_t<_Rcvr>>, __with_in_place_stop_token, _InlineSize>>
           tag_invoke(connect_t, __t&& __self, _Rcvr&& __rcvr) {
           return {(__t&&) __self, (_Rcvr&&) __rcvr};
         }
@@ -1069,6 +1222,15 @@ namespace exec {
         return !(__self == __other);
       }
 
+     public:
+      // Compares with a scheduler of a concrete type without erasing it first
+      template <class _Scheduler>
+      bool __equal_to(const _Scheduler& __other) const noexcept {
+        const _Scheduler* __self = __storage_.template __target<_Scheduler>();
+        return __self != nullptr && *__self == __other;
+      }
+
+     private:
       __copyable_storage_t<__vtable> __storage_{};
     };
   } // namepsace __any
@@ -1102,13 +1264,19 @@ namespace exec {
       : __receiver_(__receiver) {
     }
 
-    template <auto... _SenderQueries>
-    class any_sender {
-      using __sender_base = stdexec::__t<
-        __any::__sender<_Completions, queries<_SenderQueries...>, queries<_ReceiverQueries...>>>;
+    // An any_sender whose connect constructs operation states of up to _InlineSize bytes
+    // in place. Larger operation states are allocated with the allocator of the receiver's
+    // environment, if it has one.
+    template <std::size_t _InlineSize, auto... _SenderQueries>
+    class basic_any_sender {
+      using __sender_base = stdexec::__t<__any::__sender<
+        _Completions,
+        queries<_SenderQueries...>,
+        queries<_ReceiverQueries...>,
+        _InlineSize>>;
       __sender_base __sender_;
 
-      template <class _Tag, stdexec::__decays_to<any_sender> Self, class... _As>
+      template <class _Tag, stdexec::__decays_to<basic_any_sender> Self, class... _As>
         requires stdexec::tag_invocable< _Tag, stdexec::__copy_cvref_t<Self, __sender_base>, _As...>
       friend auto tag_invoke(_Tag, Self&& __self, _As&&... __as) noexcept(
         std::is_nothrow_invocable_v< _Tag, stdexec::__copy_cvref_t<Self, __sender_base>, _As...>) {
@@ -1118,9 +1286,9 @@ namespace exec {
       using is_sender = void;
       using completion_signatures = typename __sender_base::completion_signatures;
 
-      template <stdexec::__not_decays_to<any_sender> _Sender>
+      template <stdexec::__not_decays_to<basic_any_sender> _Sender>
         requires stdexec::sender_to<_Sender, __receiver_base>
-      any_sender(_Sender&& __sender) noexcept(
+      basic_any_sender(_Sender&& __sender) noexcept(
         stdexec::__nothrow_constructible_from<__sender_base, _Sender>)
         : __sender_((_Sender&&) __sender) {
       }
@@ -1147,7 +1315,8 @@ namespace exec {
           decltype(_SenderQueries)...>;
 
         template <class... _Queries>
-        using __schedule_sender_fn = typename __schedule_receiver::template any_sender<
+        using __schedule_sender_fn = typename __schedule_receiver::template basic_any_sender<
+          __any::__schedule_inline_size,
           stdexec::get_completion_scheduler<stdexec::set_value_t>.template signature<any_scheduler() noexcept>>;
         using __schedule_sender =
           stdexec::__mapply<stdexec::__q<__schedule_sender_fn>, schedule_sender_queries>;
@@ -1181,7 +1350,17 @@ namespace exec {
 
         friend bool
           operator==(const any_scheduler& __self, const any_scheduler& __other) noexcept = default;
+
+        template <class _Scheduler>
+          requires(
+            !stdexec::__decays_to<_Scheduler, any_scheduler> && stdexec::scheduler<_Scheduler>)
+        friend bool operator==(const any_scheduler& __self, const _Scheduler& __other) noexcept {
+          return __self.__scheduler_.__equal_to(__other);
+        }
       };
     };
+
+    template <auto... _SenderQueries>
+    using any_sender = basic_any_sender<__any::__default_inline_size, _SenderQueries...>;
   };
 } // namespace exec
@@ -19,6 +19,8 @@
 #include "../stdexec/__detail/__intrusive_queue.hpp"
 #include "env.hpp"
 
+#include <atomic>
+
 namespace exec {
   /////////////////////////////////////////////////////////////////////////////
   // async_scope
@@ -37,17 +39,80 @@ namespace exec {
     template <class _BaseEnv>
     using __env_t = make_env_t< _BaseEnv, with_t<get_stop_token_t, in_place_stop_token>>;
 
+    // The operation states of spawn and spawn_future are allocated with the allocator of the
+    // environment, if it has one.
+    template <class _Env>
+    auto __get_allocator(const _Env& __env) noexcept {
+      if constexpr (__callable<get_allocator_t, const _Env&>) {
+        return get_allocator(__env);
+      } else {
+        return std::allocator<std::byte>{};
+      }
+    }
+
+    template <class _Tp, class _Env>
+    using __allocator_for_t = typename std::allocator_traits<
+      decltype(__scope::__get_allocator(__declval<const _Env&>()))>::template rebind_alloc<_Tp>;
+
+    template <class _Env, class _Allocator>
+    using __with_allocator_t = make_env_t<_Env, with_t<get_allocator_t, _Allocator>>;
+
+    template <class _Tp, class _Env, class... _Args>
+    _Tp* __allocate(const _Env& __env, _Args&&... __args) {
+      using _Traits = std::allocator_traits<__allocator_for_t<_Tp, _Env>>;
+      __allocator_for_t<_Tp, _Env> __alloc(__scope::__get_allocator(__env));
+      _Tp* __pointer = std::to_address(_Traits::allocate(__alloc, 1));
+      try {
+        _Traits::construct(__alloc, __pointer, (_Args&&) __args...);
+      } catch (...) {
+        _Traits::deallocate(__alloc, __pointer, 1);
+        throw;
+      }
+      return __pointer;
+    }
+
+    // The allocator is taken from the environment of the object before it is destroyed
+    template <class _Tp, class _Env>
+    void __deallocate(_Tp* __pointer, const _Env& __env) noexcept {
+      using _Traits = std::allocator_traits<__allocator_for_t<_Tp, _Env>>;
+      __allocator_for_t<_Tp, _Env> __alloc(__scope::__get_allocator(__env));
+      _Traits::destroy(__alloc, __pointer);
+      _Traits::deallocate(__alloc, __pointer, 1);
+    }
+
+    // The number of active operations is changed without the lock, except for the transition
+    // to zero. That one is serialized with the waiters, since the scope may be destroyed as soon
+    // as a waiter has been notified.
     struct __impl {
       in_place_stop_source __stop_source_{};
       mutable std::mutex __lock_{};
-      mutable std::ptrdiff_t __active_ = 0;
+      mutable std::atomic<std::ptrdiff_t> __active_{0};
       mutable __intrusive_queue<&__task::__next_> __waiters_{};
 
       ~__impl() {
         std::unique_lock __guard{__lock_};
-        STDEXEC_ASSERT(__active_ == 0);
+        STDEXEC_ASSERT(__active_.load(std::memory_order_relaxed) == 0);
         STDEXEC_ASSERT(__waiters_.empty());
       }
+
+      void __increment() const noexcept {
+        __active_.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      // Returns the waiters that have to be notified, if this was the last active operation.
+      [[nodiscard]] __intrusive_queue<&__task::__next_> __decrement() const noexcept {
+        std::ptrdiff_t __n = __active_.load(std::memory_order_relaxed);
+        while (__n > 1) {
+          if (__active_.compare_exchange_weak(__n, __n - 1, std::memory_order_release)) {
+            return {};
+          }
+        }
+        std::unique_lock __guard{__lock_};
+        if (__active_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+          return {};
+        }
+        return std::move(__waiters_);
+      }
     };
 
     ////////////////////////////////////////////////////////////////////////////
@@ -77,7 +142,7 @@ namespace exec {
         std::unique_lock __guard{this->__scope_->__lock_};
         auto& __active = this->__scope_->__active_;
         auto& __waiters = this->__scope_->__waiters_;
-        if (__active != 0) {
+        if (__active.load(std::memory_order_acquire) != 0) {
           __waiters.push_back(this);
           return;
         }
@@ -140,18 +205,13 @@ namespace exec {
       __nest_op_base<_ReceiverId>* __op_;
 
       static void __complete(const __impl* __scope) noexcept {
-        std::unique_lock __guard{__scope->__lock_};
-        auto& __active = __scope->__active_;
-        if (--__active == 0) {
-          auto __local = std::move(__scope->__waiters_);
-          __guard.unlock();
-          __scope = nullptr;
-          // do not access __scope
-          while (!__local.empty()) {
-            auto* __next = __local.pop_front();
-            __next->__notify_waiter(__next);
-            // __scope must be considered deleted
-          }
+        auto __local = __scope->__decrement();
+        __scope = nullptr;
+        // do not access __scope
+        while (!__local.empty()) {
+          auto* __next = __local.pop_front();
+          __next->__notify_waiter(__next);
+          // __scope must be considered deleted
         }
       }
 
@@ -188,10 +248,7 @@ namespace exec {
      private:
       void __start_() noexcept {
         STDEXEC_ASSERT(this->__scope_);
-        std::unique_lock __guard{this->__scope_->__lock_};
-        auto& __active = this->__scope_->__active_;
-        ++__active;
-        __guard.unlock();
+        this->__scope_->__increment();
         start(__op_);
       }
 
@@ -234,17 +291,52 @@ namespace exec {
 
     ////////////////////////////////////////////////////////////////////////////
     // async_scope::spawn_future implementation
+    // The result handoff between the spawned operation and the future is a state machine on a
+    // single atomic. The future (or the operation that it was connected to) owns the state
+    // until it is abandoned, then the spawned operation deletes it when it completes.
+    //
+    //   __empty    -> __ready      the spawned operation has stored its result
+    //   __empty    -> __waiting    the consumer has been started and stored itself in the state
+    //   __waiting  -> __ready      the spawned operation completes the waiting consumer
+    //   __empty    -> __abandoned  the future has been dropped before the result arrived
     enum class __future_step {
-      __invalid = 0,
-      __created,
-      __future,
-      __no_future,
-      __deleted
+      __empty,
+      __waiting,
+      __ready,
+      __abandoned
     };
 
     template <class _Sender, class _Env>
     struct __future_state;
 
+    struct __delete_future_state {
+      template <class _State>
+      void operator()(_State* __state) const noexcept {
+        __state->__delete_(__state);
+      }
+    };
+
+    template <class _Sender, class _Env>
+    using __future_state_ptr =
+      std::unique_ptr<__future_state<_Sender, _Env>, __delete_future_state>;
+
+    // Drops the ownership of a future state that has not been consumed. If the spawned operation
+    // has not completed yet, it deletes the state when it does.
+    template <class _Sender, class _Env>
+    void __abandon(__future_state_ptr<_Sender, _Env>& __state) noexcept {
+      if (__state != nullptr) {
+        auto __step = __future_step::__empty;
+        if (__state->__step_.compare_exchange_strong(
+              __step, __future_step::__abandoned, std::memory_order_acq_rel)) {
+          (void) __state.release();
+        } else {
+          // the result has arrived and is not needed anymore
+          STDEXEC_ASSERT(__step == __future_step::__ready);
+          __state.reset();
+        }
+      }
+    }
+
     struct __forward_stopped {
       in_place_stop_source* __stop_source_;
 
@@ -259,8 +351,6 @@ namespace exec {
       void __complete() noexcept {
         __complete_(this);
       }
-
-      __subscription* __next_ = nullptr;
     };
 
     template <class _SenderId, class _EnvId, class _ReceiverId>
@@ -280,27 +370,19 @@ namespace exec {
         try {
           auto __state = std::move(__state_);
           STDEXEC_ASSERT(__state != nullptr);
-          std::unique_lock __guard{__state->__mutex_};
-          // either the future is still in use or it has passed ownership to __state->__no_future_
-          if (
-            __state->__no_future_.get() != nullptr || __state->__step_ != __future_step::__future) {
-            // invalid state - there is a code bug in the state machine
-            std::terminate();
-          } else if (get_stop_token(get_env(__rcvr_)).stop_requested()) {
-            __guard.unlock();
+          STDEXEC_ASSERT(
+            __state->__step_.load(std::memory_order_relaxed) == __future_step::__ready);
+          if (get_stop_token(get_env(__rcvr_)).stop_requested()) {
             set_stopped((_Receiver&&) __rcvr_);
-            __guard.lock();
           } else {
             std::visit(
-              [this, &__guard]<class _Tup>(_Tup& __tup) {
+              [this]<class _Tup>(_Tup& __tup) {
                 if constexpr (same_as<_Tup, std::monostate>) {
                   std::terminate();
                 } else {
                   std::apply(
-                    [this, &__guard]<class... _As>(auto tag, _As&... __as) {
-                      __guard.unlock();
+                    [this]<class... _As>(auto tag, _As&... __as) {
                       tag((_Receiver&&) __rcvr_, (_As&&) __as...);
-                      __guard.lock();
                     },
                     __tup);
                 }
@@ -313,44 +395,29 @@ namespace exec {
       }
 
       void __start_() noexcept {
-        try {
-          if (!!__state_) {
-            std::unique_lock __guard{__state_->__mutex_};
-            if (__state_->__data_.index() != 0) {
-              __guard.unlock();
-              __complete_();
-            } else {
-              __state_->__subscribers_.push_back(this);
-            }
+        if (!!__state_) {
+          __state_->__subscriber_ = this;
+          auto __step = __future_step::__empty;
+          if (!__state_->__step_.compare_exchange_strong(
+                __step, __future_step::__waiting, std::memory_order_acq_rel)) {
+            // the result is already there
+            STDEXEC_ASSERT(__step == __future_step::__ready);
+            __complete_();
           }
-        } catch (...) {
-          set_error((_Receiver&&) __rcvr_, std::current_exception());
         }
       }
 
       STDEXEC_NO_UNIQUE_ADDRESS _Receiver __rcvr_;
-      std::unique_ptr<__future_state<_Sender, _Env>> __state_;
+      __future_state_ptr<_Sender, _Env> __state_;
       STDEXEC_NO_UNIQUE_ADDRESS __forward_consumer __forward_consumer_;
 
      public:
       ~__future_op() noexcept {
-        if (__state_ != nullptr) {
-          auto __raw_state = __state_.get();
-          std::unique_lock __guard{__raw_state->__mutex_};
-          if (__raw_state->__data_.index() > 0) {
-            // completed given sender
-            // state is no longer needed
-            return;
-          }
-          __raw_state->__no_future_ = std::move(__state_);
-          __raw_state->__step_from_to_(
-            __guard, __future_step::__future, __future_step::__no_future);
-        }
+        __scope::__abandon(__state_);
       }
 
       template <class _Receiver2>
-      explicit __future_op(
-        _Receiver2&& __rcvr, std::unique_ptr<__future_state<_Sender, _Env>> __state)
+      explicit __future_op(_Receiver2&& __rcvr, __future_state_ptr<_Sender, _Env> __state)
         : __subscription{{},
           [](__subscription* __self) noexcept -> void {
             static_cast<__future_op*>(__self)->__complete_();
@@ -402,67 +469,26 @@ namespace exec {
         __transform< __q<__completion_as_tuple_t>, __mbind_front_q<std::variant, std::monostate>>,
         _Completions>;
 
-    template <class _Ty>
-    struct __dynamic_delete {
-      __dynamic_delete()
-        : __delete_([](_Ty* __p) { delete __p; }) {
-      }
-
-      template <class _Uy>
-        requires convertible_to<_Uy*, _Ty*>
-      __dynamic_delete(std::default_delete<_Uy>)
-        : __delete_([](_Ty* __p) { delete static_cast<_Uy*>(__p); }) {
-      }
-
-      template <class _Uy>
-        requires convertible_to<_Uy*, _Ty*>
-      __dynamic_delete& operator=(std::default_delete<_Uy> __d) {
-        __delete_ = __dynamic_delete{__d}.__delete_;
-        return *this;
-      }
-
-      void operator()(_Ty* __p) {
-        __delete_(__p);
-      }
-
-      void (*__delete_)(_Ty*);
-    };
-
     template <class _Completions, class _Env>
     struct __future_state_base {
-      __future_state_base(_Env __env, const __impl* __scope)
-        : __forward_scope_{std::in_place, __scope->__stop_source_.get_token(), __forward_stopped{&__stop_source_}}
+      using __delete_fn = void(__future_state_base*) noexcept;
+
+      __future_state_base(__delete_fn* __delete, _Env __env, const __impl* __scope)
+        : __delete_{__delete}
+        , __forward_scope_{
+            std::in_place,
+            __scope->__stop_source_.get_token(),
+            __forward_stopped{&__stop_source_}}
         , __env_(
             make_env((_Env&&) __env, with(get_stop_token, __scope->__stop_source_.get_token()))) {
       }
 
-      ~__future_state_base() {
-        std::unique_lock __guard{__mutex_};
-        if (__step_ == __future_step::__created) {
-          // exception during connect() will end up here
-          __step_from_to_(__guard, __future_step::__created, __future_step::__deleted);
-        } else if (__step_ != __future_step::__deleted) {
-          // completing the given sender before the future is dropped will end here
-          __step_from_to_(__guard, __future_step::__future, __future_step::__deleted);
-        }
-      }
-
-      void __step_from_to_(
-        std::unique_lock<std::mutex>& __guard,
-        __future_step __from,
-        __future_step __to) {
-        STDEXEC_ASSERT(__guard.owns_lock());
-        auto actual = std::exchange(__step_, __to);
-        STDEXEC_ASSERT(actual == __from);
-      }
-
+      __delete_fn* __delete_;
       in_place_stop_source __stop_source_;
       std::optional<in_place_stop_callback<__forward_stopped>> __forward_scope_;
-      std::mutex __mutex_;
-      __future_step __step_ = __future_step::__created;
-      std::unique_ptr<__future_state_base, __dynamic_delete<__future_state_base>> __no_future_;
+      std::atomic<__future_step> __step_{__future_step::__empty};
+      __subscription* __subscriber_ = nullptr;
       __completions_as_variant<_Completions> __data_;
-      __intrusive_queue<&__subscription::__next_> __subscribers_;
       __env_t<_Env> __env_;
     };
 
@@ -474,23 +500,24 @@ namespace exec {
       __future_state_base<_Completions, _Env>* __state_;
       const __impl* __scope_;
 
+      // Publishes the result that has been stored in the state. This is the last access of the
+      // state by the spawned operation, unless nobody is left to consume the result.
       void __dispatch_result_() noexcept {
         auto& __state = *__state_;
-        std::unique_lock __guard{__state.__mutex_};
-        auto __local = std::move(__state.__subscribers_);
         __state.__forward_scope_ = std::nullopt;
-        if (__state.__no_future_.get() != nullptr) {
-          // nobody is waiting for the results
-          // delete this and return
-          __state.__step_from_to_(__guard, __future_step::__no_future, __future_step::__deleted);
-          __guard.unlock();
-          __state.__no_future_.reset();
-          return;
-        }
-        __guard.unlock();
-        while (!__local.empty()) {
-          auto* __sub = __local.pop_front();
-          __sub->__complete();
+        switch (__state.__step_.exchange(__future_step::__ready, std::memory_order_acq_rel)) {
+        case __future_step::__empty:
+          // the future picks up the result when it is started
+          break;
+        case __future_step::__waiting:
+          __state.__subscriber_->__complete();
+          break;
+        case __future_step::__abandoned:
+          // nobody is waiting for the result
+          __delete_future_state{}(&__state);
+          break;
+        case __future_step::__ready:
+          STDEXEC_ASSERT(false);
         }
       }
 
@@ -498,15 +525,13 @@ namespace exec {
       friend void tag_invoke(_Tag, __future_rcvr&& __self, _As&&... __as) noexcept {
         auto& __state = *__self.__state_;
         try {
-          std::unique_lock __guard{__state.__mutex_};
           using _Tuple = __decayed_tuple<_Tag, _As...>;
           __state.__data_.template emplace<_Tuple>(_Tag{}, (_As&&) __as...);
-          __guard.unlock();
-          __self.__dispatch_result_();
         } catch (...) {
           using _Tuple = std::tuple<set_error_t, std::exception_ptr>;
           __state.__data_.template emplace<_Tuple>(set_error_t{}, std::current_exception());
         }
+        __self.__dispatch_result_();
       }
 
       friend const __env_t<_Env>& tag_invoke(get_env_t, const __future_rcvr& __self) noexcept {
@@ -523,12 +548,17 @@ namespace exec {
       using _Completions = __future_completions_t<_Sender, _Env>;
 
       __future_state(_Sender __sndr, _Env __env, const __impl* __scope)
-        : __future_state_base<_Completions, _Env>((_Env&&) __env, __scope)
+        : __future_state_base<_Completions, _Env>(&__delete, (_Env&&) __env, __scope)
         , __op_(stdexec::connect(
             (_Sender&&) __sndr,
             __future_receiver_t<_Sender, _Env>{this, __scope})) {
       }
 
+      static void __delete(__future_state_base<_Completions, _Env>* __base) noexcept {
+        __future_state* __self = static_cast<__future_state*>(__base);
+        __scope::__deallocate(__self, __self->__env_);
+      }
+
       connect_result_t<_Sender, __future_receiver_t<_Sender, _Env>> __op_;
     };
 
@@ -544,27 +574,14 @@ namespace exec {
       __future& operator=(__future&&) = default;
 
       ~__future() noexcept {
-        if (__state_ != nullptr) {
-          auto __raw_state = __state_.get();
-          std::unique_lock __guard{__raw_state->__mutex_};
-          if (__raw_state->__data_.index() != 0) {
-            // completed given sender
-            // state is no longer needed
-            return;
-          }
-          __raw_state->__no_future_ = std::move(__state_);
-          __raw_state->__step_from_to_(
-            __guard, __future_step::__future, __future_step::__no_future);
-        }
+        __scope::__abandon(__state_);
       }
      private:
       template <class _Self>
       using __completions_t = __future_completions_t<__mfront<_Sender, _Self>, _Env>;
 
-      explicit __future(std::unique_ptr<__future_state<_Sender, _Env>> __state) noexcept
+      explicit __future(__future_state_ptr<_Sender, _Env> __state) noexcept
         : __state_(std::move(__state)) {
-        std::unique_lock __guard{__state_->__mutex_};
-        __state_->__step_from_to_(__guard, __future_step::__created, __future_step::__future);
       }
 
       template <__decays_to<__future> _Self, receiver _Receiver>
@@ -583,7 +600,7 @@ namespace exec {
         return {};
       }
 
-      std::unique_ptr<__future_state<_Sender, _Env>> __state_;
+      __future_state_ptr<_Sender, _Env> __state_;
     };
 
     template <class _Sender, class _Env>
@@ -635,7 +652,8 @@ namespace exec {
         : __spawn_op_base<_EnvId>{make_env((_Env&&) __env,
                                     with(get_stop_token, __scope->__stop_source_.get_token())),
           [](__spawn_op_base<_EnvId>* __op) {
-            delete static_cast<__spawn_op*>(__op);
+            __spawn_op* __self = static_cast<__spawn_op*>(__op);
+            __scope::__deallocate(__self, __self->__env_);
           }}
         , __op_(stdexec::connect((_Sndr&&) __sndr, __spawn_receiver_t<_Env>{this, __scope})) {
       }
@@ -676,6 +694,7 @@ namespace exec {
         return nest_result_t<_Constrained>{&__impl_, (_Constrained&&) __c};
       }
 
+      // The operation state is allocated with the allocator of the environment, if it has one.
       template <__movable_value _Env = empty_env, sender_in<__env_t<_Env>> _Sender>
         requires sender_to<nest_result_t<_Sender>, __spawn_receiver_t<_Env>>
       void spawn(_Sender&& __sndr, _Env __env = {}) {
@@ -683,18 +702,43 @@ namespace exec {
         // start is noexcept so we can assume that the operation will complete
         // after this, which means we can rely on its self-ownership to ensure
         // that it is eventually deleted
-        stdexec::start(*new __op_t{nest((_Sender&&) __sndr), (_Env&&) __env, &__impl_});
+        const auto& __env_ref = __env;
+        stdexec::start(*__scope::__allocate<__op_t>(
+          __env_ref, nest((_Sender&&) __sndr), (_Env&&) __env, &__impl_));
       }
 
+      // Allocates the operation state with the given allocator, which is also added to the
+      // environment of the spawned sender.
+      template <class _Allocator, __movable_value _Env = empty_env, sender _Sender>
+      void spawn(
+        std::allocator_arg_t,
+        const _Allocator& __alloc,
+        _Sender&& __sndr,
+        _Env __env = {}) {
+        spawn((_Sender&&) __sndr, make_env((_Env&&) __env, with(get_allocator, __alloc)));
+      }
+
+      // The shared state is allocated with the allocator of the environment, if it has one.
       template <__movable_value _Env = empty_env, sender_in<__env_t<_Env>> _Sender>
       __future_t<_Sender, _Env> spawn_future(_Sender&& __sndr, _Env __env = {}) {
         using __state_t = __future_state<nest_result_t<_Sender>, _Env>;
-        auto __state = std::make_unique<__state_t>(
-          nest((_Sender&&) __sndr), (_Env&&) __env, &__impl_);
+        const auto& __env_ref = __env;
+        __future_state_ptr<nest_result_t<_Sender>, _Env> __state{__scope::__allocate<__state_t>(
+          __env_ref, nest((_Sender&&) __sndr), (_Env&&) __env, &__impl_)};
         stdexec::start(__state->__op_);
         return __future_t<_Sender, _Env>{std::move(__state)};
       }
 
+      template <class _Allocator, __movable_value _Env = empty_env, sender _Sender>
+      __future_t<_Sender, __with_allocator_t<_Env, _Allocator>> spawn_future(
+        std::allocator_arg_t,
+        const _Allocator& __alloc,
+        _Sender&& __sndr,
+        _Env __env = {}) {
+        return spawn_future(
+          (_Sender&&) __sndr, make_env((_Env&&) __env, with(get_allocator, __alloc)));
+      }
+
       in_place_stop_source& get_stop_source() noexcept {
         return __impl_.__stop_source_;
       }
@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../stdexec/execution.hpp"
+#include "../stdexec/__detail/__intrusive_queue.hpp"
+#include "async_scope.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+namespace exec {
+  /////////////////////////////////////////////////////////////////////////////
+  // bounded_async_scope
+  namespace __bounded_scope {
+    using namespace stdexec;
+
+    // An operation that waits for a free slot
+    struct __waiter {
+      __waiter* __next_ = nullptr;
+      void (*__admit_)(__waiter*) noexcept;
+    };
+
+    // Hands out a limited number of slots to waiters in the order of their arrival.
+    class __admission {
+     public:
+      explicit __admission(std::size_t __max_active) noexcept
+        : __max_active_{std::max(__max_active, std::size_t{1})} {
+      }
+
+      std::size_t __max_active() const noexcept {
+        return __max_active_;
+      }
+
+      void __acquire(__waiter* __op) noexcept {
+        std::unique_lock __guard{__mutex_};
+        if (__active_ == __max_active_ || !__queue_.empty()) {
+          __queue_.push_back(__op);
+          return;
+        }
+        ++__active_;
+        __guard.unlock();
+        __op->__admit_(__op);
+      }
+
+      // The slot is handed over to the next waiter, if there is one. The waiter is returned, and
+      // the caller admits it with __hand_off once it is done with its own completion.
+      [[nodiscard]] __waiter* __release() noexcept {
+        std::lock_guard __guard{__mutex_};
+        if (__queue_.empty()) {
+          --__active_;
+          return nullptr;
+        }
+        return __queue_.pop_front();
+      }
+
+      // Admitted operations may complete synchronously and release their slot to the next
+      // waiter. Nested hand-offs on the same thread are queued and run by the outermost one,
+      // such that a long queue of waiters does not grow the stack. Operations that find a free
+      // slot are started inline, since they may block on another scope from within a hand-off.
+      // Waiters do not go away before they are admitted, so this does not need to access the
+      // scope.
+      static void __hand_off(__waiter* __op) noexcept {
+        if (__op == nullptr) {
+          return;
+        }
+        thread_local __intrusive_queue<&__waiter::__next_> __ready{};
+        thread_local bool __is_admitting = false;
+        __ready.push_back(__op);
+        if (__is_admitting) {
+          return;
+        }
+        __is_admitting = true;
+        while (!__ready.empty()) {
+          __waiter* __next = __ready.pop_front();
+          __next->__admit_(__next);
+        }
+        __is_admitting = false;
+      }
+
+     private:
+      std::size_t __max_active_;
+      std::mutex __mutex_{};
+      std::size_t __active_{0};
+      __intrusive_queue<&__waiter::__next_> __queue_{};
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    // A sender that occupies a slot while it runs
+    template <class _ReceiverId>
+    struct __slot_op_base : __waiter {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+      __admission* __admission_;
+      STDEXEC_NO_UNIQUE_ADDRESS _Receiver __rcvr_;
+    };
+
+    template <class _ReceiverId>
+    struct __slot_rcvr {
+      using is_receiver = void;
+      using _Receiver = stdexec::__t<_ReceiverId>;
+      __slot_op_base<_ReceiverId>* __op_;
+
+      // The slot is released before the completion is forwarded, since the receiver may end the
+      // lifetime of the scope. The next waiter is admitted afterwards, such that the receiver
+      // does not wait for the waiters that complete synchronously.
+      template <__completion_tag _Tag, class... _As>
+        requires __callable<_Tag, _Receiver, _As...>
+      friend void tag_invoke(_Tag, __slot_rcvr&& __self, _As&&... __as) noexcept {
+        __waiter* __next = __self.__op_->__admission_->__release();
+        _Tag{}((_Receiver&&) __self.__op_->__rcvr_, (_As&&) __as...);
+        __admission::__hand_off(__next);
+      }
+
+      friend env_of_t<_Receiver> tag_invoke(get_env_t, const __slot_rcvr& __self) noexcept {
+        return get_env(__self.__op_->__rcvr_);
+      }
+    };
+
+    template <class _SenderId, class _ReceiverId, bool _Acquire>
+    struct __slot_op : __slot_op_base<_ReceiverId> {
+      using _Sender = stdexec::__t<_SenderId>;
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      template <__decays_to<_Sender> _Sndr>
+      __slot_op(__admission* __admission, _Sndr&& __sndr, _Receiver __rcvr)
+        : __slot_op_base<_ReceiverId>{{nullptr, &__admit}, __admission, (_Receiver&&) __rcvr}
+        , __op_(stdexec::connect((_Sndr&&) __sndr, __slot_rcvr<_ReceiverId>{this})) {
+      }
+
+     private:
+      static void __admit(__waiter* __self) noexcept {
+        start(static_cast<__slot_op*>(__self)->__op_);
+      }
+
+      friend void tag_invoke(start_t, __slot_op& __self) noexcept {
+        if constexpr (_Acquire) {
+          __self.__admission_->__acquire(&__self);
+        } else {
+          start(__self.__op_);
+        }
+      }
+
+      STDEXEC_IMMOVABLE_NO_UNIQUE_ADDRESS connect_result_t<_Sender, __slot_rcvr<_ReceiverId>>
+        __op_;
+    };
+
+    // With _Acquire, the sender waits for a free slot when it is started. Otherwise the slot has
+    // been acquired before.
+    template <class _SenderId, bool _Acquire>
+    struct __slot_sender {
+      using _Sender = stdexec::__t<_SenderId>;
+      using is_sender = void;
+
+      __admission* __admission_;
+      STDEXEC_NO_UNIQUE_ADDRESS _Sender __sndr_;
+
+      template <class _Self, class _Receiver>
+      using __slot_op_t = __slot_op<__x<__copy_cvref_t<_Self, _Sender>>, __x<_Receiver>, _Acquire>;
+
+      template <__decays_to<__slot_sender> _Self, receiver _Receiver>
+        requires sender_to<__copy_cvref_t<_Self, _Sender>, __slot_rcvr<__x<_Receiver>>>
+      friend __slot_op_t<_Self, _Receiver>
+        tag_invoke(connect_t, _Self&& __self, _Receiver __rcvr) {
+        return __slot_op_t<_Self, _Receiver>{
+          __self.__admission_, ((_Self&&) __self).__sndr_, (_Receiver&&) __rcvr};
+      }
+
+      template <__decays_to<__slot_sender> _Self, class _Env>
+      friend auto tag_invoke(get_completion_signatures_t, _Self&&, _Env&&)
+        -> completion_signatures_of_t<__copy_cvref_t<_Self, _Sender>, _Env>;
+
+      friend empty_env tag_invoke(get_env_t, const __slot_sender&) noexcept {
+        return {};
+      }
+    };
+
+    template <class _Sender, bool _Acquire>
+    using __slot_sender_t = __slot_sender<__x<__decay_t<_Sender>>, _Acquire>;
+
+    ////////////////////////////////////////////////////////////////////////////
+    // bounded_async_scope::async_spawn implementation
+    template <class _SenderId, class _EnvId, class _ReceiverId>
+    struct __async_spawn_op : __waiter, __immovable {
+      using _Sender = stdexec::__t<_SenderId>;
+      using _Env = stdexec::__t<_EnvId>;
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      __async_spawn_op(
+        __admission* __admission,
+        async_scope* __scope,
+        _Sender __sndr,
+        _Env __env,
+        _Receiver __rcvr)
+        : __waiter{nullptr, &__admit}
+        , __admission_{__admission}
+        , __scope_{__scope}
+        , __sndr_((_Sender&&) __sndr)
+        , __env_((_Env&&) __env)
+        , __rcvr_((_Receiver&&) __rcvr) {
+      }
+
+     private:
+      static void __admit(__waiter* __op) noexcept {
+        __async_spawn_op* __self = static_cast<__async_spawn_op*>(__op);
+        try {
+          __self->__scope_->spawn(
+            __slot_sender_t<_Sender, false>{__self->__admission_, (_Sender&&) __self->__sndr_},
+            (_Env&&) __self->__env_);
+        } catch (...) {
+          __waiter* __next = __self->__admission_->__release();
+          stdexec::set_error((_Receiver&&) __self->__rcvr_, std::current_exception());
+          __admission::__hand_off(__next);
+          return;
+        }
+        stdexec::set_value((_Receiver&&) __self->__rcvr_);
+      }
+
+      friend void tag_invoke(start_t, __async_spawn_op& __self) noexcept {
+        __self.__admission_->__acquire(&__self);
+      }
+
+      __admission* __admission_;
+      async_scope* __scope_;
+      _Sender __sndr_;
+      _Env __env_;
+      STDEXEC_NO_UNIQUE_ADDRESS _Receiver __rcvr_;
+    };
+
+    template <class _SenderId, class _EnvId>
+    struct __async_spawn_sender {
+      using _Sender = stdexec::__t<_SenderId>;
+      using _Env = stdexec::__t<_EnvId>;
+      using is_sender = void;
+      using completion_signatures = stdexec::completion_signatures<
+        set_value_t(),
+        set_error_t(std::exception_ptr)>;
+
+      __admission* __admission_;
+      async_scope* __scope_;
+      _Sender __sndr_;
+      _Env __env_;
+
+      template <class _Receiver>
+      using __async_spawn_op_t = __async_spawn_op<_SenderId, _EnvId, __x<_Receiver>>;
+
+      template <receiver_of<completion_signatures> _Receiver>
+      friend __async_spawn_op_t<_Receiver>
+        tag_invoke(connect_t, __async_spawn_sender&& __self, _Receiver __rcvr) {
+        return __async_spawn_op_t<_Receiver>{
+          __self.__admission_,
+          __self.__scope_,
+          (_Sender&&) __self.__sndr_,
+          (_Env&&) __self.__env_,
+          (_Receiver&&) __rcvr};
+      }
+
+      friend empty_env tag_invoke(get_env_t, const __async_spawn_sender&) noexcept {
+        return {};
+      }
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    // bounded_async_scope
+    //
+    // An async_scope that runs at most a fixed number of its operations at the same time. The
+    // other operations wait without blocking a thread and are admitted in the order in which
+    // they were started. Nested and spawned operations count as active while they wait, so
+    // on_empty waits for them, too.
+    // A stop request does not remove waiting operations from the queue, they see the stop
+    // request once they are admitted.
+    class bounded_async_scope : __immovable {
+     public:
+      explicit bounded_async_scope(std::size_t __max_active) noexcept
+        : __admission_{__max_active} {
+      }
+
+      std::size_t max_active() const noexcept {
+        return __admission_.__max_active();
+      }
+
+      template <sender _Constrained>
+      [[nodiscard]] auto when_empty(_Constrained&& __c) const {
+        return __scope_.when_empty((_Constrained&&) __c);
+      }
+
+      [[nodiscard]] auto on_empty() const {
+        return __scope_.on_empty();
+      }
+
+      template <sender _Constrained>
+      using nest_result_t = async_scope::nest_result_t<__slot_sender_t<_Constrained, true>>;
+
+      // The returned sender waits for a free slot when it is started
+      template <sender _Constrained>
+      [[nodiscard]] nest_result_t<_Constrained> nest(_Constrained&& __c) {
+        return __scope_.nest(
+          __slot_sender_t<_Constrained, true>{&__admission_, (_Constrained&&) __c});
+      }
+
+      // Starts the sender as soon as a slot is free. The operation state is allocated right
+      // away, use async_spawn to limit the number of allocated operations.
+      template <__movable_value _Env = empty_env, sender _Sender>
+      void spawn(_Sender&& __sndr, _Env __env = {}) {
+        __scope_.spawn(
+          __slot_sender_t<_Sender, true>{&__admission_, (_Sender&&) __sndr}, (_Env&&) __env);
+      }
+
+      // async_spawn(sender, env)
+      //   returns a sender that waits for a free slot, spawns the given sender into the scope and
+      //   completes with set_value(). Producers that await it are throttled by the scope.
+      template <__movable_value _Env = empty_env, sender _Sender>
+      [[nodiscard]] __async_spawn_sender<__x<__decay_t<_Sender>>, __x<_Env>>
+        async_spawn(_Sender&& __sndr, _Env __env = {}) {
+        return {&__admission_, &__scope_, (_Sender&&) __sndr, (_Env&&) __env};
+      }
+
+      in_place_stop_source& get_stop_source() noexcept {
+        return __scope_.get_stop_source();
+      }
+
+      in_place_stop_token get_stop_token() const noexcept {
+        return __scope_.get_stop_token();
+      }
+
+      bool request_stop() noexcept {
+        return __scope_.request_stop();
+      }
+
+     private:
+      __admission __admission_;
+      async_scope __scope_{};
+    };
+  } // namespace __bounded_scope
+
+  using __bounded_scope::bounded_async_scope;
+} // namespace exec
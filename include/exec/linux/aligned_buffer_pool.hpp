@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2023 Maikel Nadolski
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <sys/uio.h>
+
+namespace exec {
+  namespace __aligned_buffers {
+    struct __free_deleter {
+      void operator()(std::byte* __ptr) const noexcept {
+        std::free(__ptr);
+      }
+    };
+
+    class __pool;
+
+    // A buffer that is borrowed from an aligned buffer pool. The buffer is returned to the pool
+    // when this handle is destroyed.
+    class __buffer {
+     public:
+      __buffer() = default;
+
+      __buffer(__buffer&& __other) noexcept
+        : __pool_{std::exchange(__other.__pool_, nullptr)}
+        , __data_{__other.__data_}
+        , __index_{__other.__index_} {
+      }
+
+      __buffer& operator=(__buffer __other) noexcept {
+        std::swap(__pool_, __other.__pool_);
+        std::swap(__data_, __other.__data_);
+        std::swap(__index_, __other.__index_);
+        return *this;
+      }
+
+      ~__buffer();
+
+      explicit operator bool() const noexcept {
+        return __pool_ != nullptr;
+      }
+
+      std::span<std::byte> data() const noexcept {
+        return __data_;
+      }
+
+      // The index of this buffer in the iovecs of its pool. This is the index of the buffer if
+      // the pool has been registered with an io_uring_context.
+      int index() const noexcept {
+        return __index_;
+      }
+
+     private:
+      friend class __pool;
+
+      __buffer(__pool* __owner, std::span<std::byte> __data, int __index) noexcept
+        : __pool_{__owner}
+        , __data_{__data}
+        , __index_{__index} {
+      }
+
+      __pool* __pool_{nullptr};
+      std::span<std::byte> __data_{};
+      int __index_{-1};
+    };
+
+    // A fixed number of equally sized buffers in one contiguous allocation. The address and the
+    // size of each buffer are multiples of the alignment, which makes them usable for direct io.
+    class __pool {
+     public:
+      __pool(std::size_t __n_buffers, std::size_t __buffer_size, std::size_t __alignment = 4096)
+        : __alignment_{__alignment} {
+        if (__alignment == 0 || (__alignment & (__alignment - 1)) != 0) {
+          throw std::invalid_argument("aligned_buffer_pool: alignment must be a power of two");
+        }
+        __buffer_size_ = (std::max(__buffer_size, std::size_t{1}) + __alignment - 1)
+                       & ~(__alignment - 1);
+        __storage_.reset(
+          static_cast<std::byte*>(std::aligned_alloc(__alignment, __n_buffers * __buffer_size_)));
+        if (__n_buffers != 0 && !__storage_) {
+          throw std::bad_alloc();
+        }
+        __iovecs_.reserve(__n_buffers);
+        __free_list_.reserve(__n_buffers);
+        for (std::size_t __i = 0; __i < __n_buffers; ++__i) {
+          __iovecs_.push_back(::iovec{__storage_.get() + __i * __buffer_size_, __buffer_size_});
+          __free_list_.push_back(static_cast<int>(__n_buffers - __i - 1));
+        }
+      }
+
+      __pool(__pool&&) = delete;
+
+      std::size_t size() const noexcept {
+        return __iovecs_.size();
+      }
+
+      std::size_t buffer_size() const noexcept {
+        return __buffer_size_;
+      }
+
+      std::size_t alignment() const noexcept {
+        return __alignment_;
+      }
+
+      // The buffers of this pool, in a form that can be passed to register_buffers of an
+      // io_uring_context.
+      std::span<const ::iovec> iovecs() const noexcept {
+        return __iovecs_;
+      }
+
+      // Returns an empty buffer if all buffers are in use.
+      __buffer try_acquire() noexcept {
+        std::scoped_lock __lock{__mutex_};
+        if (__free_list_.empty()) {
+          return __buffer{};
+        }
+        const int __index = __free_list_.back();
+        __free_list_.pop_back();
+        return __buffer{
+          this, {__storage_.get() + __index * __buffer_size_, __buffer_size_}, __index};
+      }
+
+     private:
+      friend class __buffer;
+
+      void __release(int __index) noexcept {
+        std::scoped_lock __lock{__mutex_};
+        // Does not allocate since the capacity covers all buffers.
+        __free_list_.push_back(__index);
+      }
+
+      std::size_t __alignment_;
+      std::size_t __buffer_size_{0};
+      std::unique_ptr<std::byte[], __free_deleter> __storage_{};
+      std::vector<::iovec> __iovecs_{};
+      std::mutex __mutex_{};
+      std::vector<int> __free_list_{};
+    };
+
+    inline __buffer::~__buffer() {
+      if (__pool_) {
+        __pool_->__release(__index_);
+      }
+    }
+  }
+
+  using aligned_buffer_pool = __aligned_buffers::__pool;
+  using aligned_buffer = __aligned_buffers::__buffer;
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2023 Maikel Nadolski
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../../stdexec/execution.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <sys/uio.h>
+
+namespace exec {
+  namespace __async_io {
+    using namespace stdexec;
+
+    // The customization point objects in this file take an io scheduler as their first argument
+    // and return a sender that performs the io operation on the execution context of that
+    // scheduler. File offsets of -1 refer to the current file position.
+    template <class _Tag>
+    struct __io_cpo {
+      template <class _Scheduler, class... _Args>
+        requires tag_invocable<_Tag, const _Scheduler&, _Args...>
+      auto operator()(const _Scheduler& __sched, _Args&&... __args) const
+        noexcept(nothrow_tag_invocable<_Tag, const _Scheduler&, _Args...>)
+          -> tag_invoke_result_t<_Tag, const _Scheduler&, _Args...> {
+        static_assert(sender<tag_invoke_result_t<_Tag, const _Scheduler&, _Args...>>);
+        return tag_invoke(_Tag{}, __sched, (_Args&&) __args...);
+      }
+    };
+
+    // async_read(sched, fd, std::span<std::byte> buffer, std::int64_t offset = -1)
+    //   completes with set_value(std::size_t n_bytes_read)
+    struct async_read_t : __io_cpo<async_read_t> { };
+
+    // async_write(sched, fd, std::span<const std::byte> buffer, std::int64_t offset = -1)
+    //   completes with set_value(std::size_t n_bytes_written)
+    struct async_write_t : __io_cpo<async_write_t> { };
+
+    // async_writev(sched, fd, std::span<const ::iovec> buffers, std::int64_t offset = -1)
+    //   completes with set_value(std::size_t n_bytes_written). Writes the buffers in order with
+    //   one operation. The iovecs have to stay valid until the sender completes.
+    struct async_writev_t : __io_cpo<async_writev_t> { };
+
+    // async_poll(sched, fd, short events)
+    //   completes with set_value(short revents) as soon as the file descriptor is ready for any
+    //   of the given poll events, such as POLLIN or POLLOUT.
+    struct async_poll_t : __io_cpo<async_poll_t> { };
+
+    // The following customization point objects operate on sockets.
+
+    // async_accept(sched, socket, int flags = 0)
+    //   completes with set_value(int fd) for the next connection of a listening socket. The
+    //   caller owns the returned file descriptor. The flags are those of accept4, such as
+    //   SOCK_CLOEXEC.
+    struct async_accept_t : __io_cpo<async_accept_t> { };
+
+    // async_connect(sched, socket, const sockaddr* address, socklen_t address_length)
+    //   completes with set_value() once the socket is connected to the address. The address has
+    //   to stay valid until the sender completes.
+    struct async_connect_t : __io_cpo<async_connect_t> { };
+
+    // async_send(sched, socket, std::span<const std::byte> buffer, int flags = 0)
+    //   completes with set_value(std::size_t n_bytes_sent). The flags are those of send, such as
+    //   MSG_NOSIGNAL.
+    struct async_send_t : __io_cpo<async_send_t> { };
+
+    // async_recv(sched, socket, std::span<std::byte> buffer, int flags = 0)
+    //   completes with set_value(std::size_t n_bytes_received). The flags are those of recv.
+    struct async_recv_t : __io_cpo<async_recv_t> { };
+
+    // async_read_direct(sched, fd, std::span<std::byte> buffer, std::int64_t offset,
+    //                   std::size_t alignment = 4096, int buffer_index = -1)
+    //   completes with set_value(std::size_t n_bytes_read). Reads from a file that is opened with
+    //   O_DIRECT. The address and the size of the buffer and the offset have to be multiples of
+    //   alignment. Otherwise the sender fails with EINVAL without performing the read.
+    //   A non-negative buffer_index refers to a buffer that is registered with the execution
+    //   context of sched and has to contain the given buffer.
+    struct async_read_direct_t : __io_cpo<async_read_direct_t> { };
+
+    // async_write_direct(sched, fd, std::span<const std::byte> buffer, std::int64_t offset,
+    //                    std::size_t alignment = 4096, int buffer_index = -1)
+    //   completes with set_value(std::size_t n_bytes_written). The counterpart of
+    //   async_read_direct for writes.
+    struct async_write_direct_t : __io_cpo<async_write_direct_t> { };
+
+    // async_send_zc(sched, socket, std::span<const std::byte> buffer, int flags = 0)
+    //   completes with set_value(std::size_t n_bytes_sent) once the buffer can be reused.
+    //   The data is sent without copying it into the kernel.
+    struct async_send_zc_t : __io_cpo<async_send_zc_t> { };
+
+    // async_splice(sched, fd_in, std::int64_t offset_in, fd_out, std::int64_t offset_out,
+    //              std::size_t n_bytes, unsigned flags = 0)
+    //   completes with set_value(std::size_t n_bytes_spliced). One of the file descriptors must
+    //   refer to a pipe. Its offset has to be -1.
+    struct async_splice_t : __io_cpo<async_splice_t> { };
+
+    // async_tee(sched, fd_in, fd_out, std::size_t n_bytes, unsigned flags = 0)
+    //   completes with set_value(std::size_t n_bytes_duplicated). Both file descriptors must refer
+    //   to pipes. The data is not consumed from fd_in.
+    struct async_tee_t : __io_cpo<async_tee_t> { };
+
+    // The following customization point objects refer to paths. The caller has to keep a path
+    // alive until the returned sender completes. Paths are relative to dirfd, which may be
+    // AT_FDCWD.
+
+    // async_openat(sched, dirfd, const char* path, int flags, mode_t mode = 0)
+    //   completes with set_value(int fd). The caller owns the returned file descriptor.
+    struct async_openat_t : __io_cpo<async_openat_t> { };
+
+    // async_statx(sched, dirfd, const char* path, int flags, unsigned mask, struct statx* buffer)
+    //   completes with set_value() after the kernel has filled the buffer.
+    struct async_statx_t : __io_cpo<async_statx_t> { };
+
+    // async_close(sched, fd)
+    //   completes with set_value() after the file descriptor has been closed.
+    struct async_close_t : __io_cpo<async_close_t> { };
+
+    // async_fsync(sched, fd, unsigned flags = 0)
+    //   completes with set_value() after the data of the file has been flushed to the storage.
+    //   IORING_FSYNC_DATASYNC gives the semantics of fdatasync.
+    struct async_fsync_t : __io_cpo<async_fsync_t> { };
+
+    // async_fallocate(sched, fd, int mode, std::int64_t offset, std::int64_t length)
+    //   completes with set_value() after the disk space has been manipulated as by fallocate.
+    struct async_fallocate_t : __io_cpo<async_fallocate_t> { };
+
+    // async_fadvise(sched, fd, std::int64_t offset, std::int64_t length, int advice)
+    //   completes with set_value() after the advice has been given as by posix_fadvise.
+    //   io_uring passes the length in 32 bits. Longer or negative lengths complete with
+    //   std::system_error(EINVAL). A length of 0 means to the end of the file.
+    struct async_fadvise_t : __io_cpo<async_fadvise_t> { };
+
+    // async_renameat(sched, old_dirfd, const char* old_path, new_dirfd, const char* new_path,
+    //                unsigned flags = 0)
+    //   completes with set_value() after the file has been renamed as by renameat2.
+    struct async_renameat_t : __io_cpo<async_renameat_t> { };
+
+    // The following customization point objects wait for events of the process, which lets the
+    // thread that drives an execution context handle them instead of a dedicated thread.
+
+    // async_wait_signal(sched, signal_fd)
+    //   completes with set_value(signalfd_siginfo) for the next signal that is read from a file
+    //   descriptor created by signalfd. The signals have to be blocked with pthread_sigmask in
+    //   all threads, otherwise they are delivered the usual way.
+    struct async_wait_signal_t : __io_cpo<async_wait_signal_t> { };
+
+    // async_eventfd_read(sched, eventfd)
+    //   completes with set_value(std::uint64_t counter) as soon as the counter of the eventfd is
+    //   non-zero. The counter is reset by the read, or decremented by one for EFD_SEMAPHORE.
+    struct async_eventfd_read_t : __io_cpo<async_eventfd_read_t> { };
+
+    // async_eventfd_write(sched, eventfd, std::uint64_t value = 1)
+    //   completes with set_value() after value has been added to the counter of the eventfd.
+    struct async_eventfd_write_t : __io_cpo<async_eventfd_write_t> { };
+  }
+
+  using __async_io::async_read_t;
+  inline constexpr async_read_t async_read{};
+
+  using __async_io::async_write_t;
+  inline constexpr async_write_t async_write{};
+
+  using __async_io::async_writev_t;
+  inline constexpr async_writev_t async_writev{};
+
+  using __async_io::async_poll_t;
+  inline constexpr async_poll_t async_poll{};
+
+  using __async_io::async_accept_t;
+  inline constexpr async_accept_t async_accept{};
+
+  using __async_io::async_connect_t;
+  inline constexpr async_connect_t async_connect{};
+
+  using __async_io::async_send_t;
+  inline constexpr async_send_t async_send{};
+
+  using __async_io::async_recv_t;
+  inline constexpr async_recv_t async_recv{};
+
+  using __async_io::async_read_direct_t;
+  inline constexpr async_read_direct_t async_read_direct{};
+
+  using __async_io::async_write_direct_t;
+  inline constexpr async_write_direct_t async_write_direct{};
+
+  using __async_io::async_send_zc_t;
+  inline constexpr async_send_zc_t async_send_zc{};
+
+  using __async_io::async_splice_t;
+  inline constexpr async_splice_t async_splice{};
+
+  using __async_io::async_tee_t;
+  inline constexpr async_tee_t async_tee{};
+
+  using __async_io::async_openat_t;
+  inline constexpr async_openat_t async_openat{};
+
+  using __async_io::async_statx_t;
+  inline constexpr async_statx_t async_statx{};
+
+  using __async_io::async_close_t;
+  inline constexpr async_close_t async_close{};
+
+  using __async_io::async_fsync_t;
+  inline constexpr async_fsync_t async_fsync{};
+
+  using __async_io::async_fallocate_t;
+  inline constexpr async_fallocate_t async_fallocate{};
+
+  using __async_io::async_fadvise_t;
+  inline constexpr async_fadvise_t async_fadvise{};
+
+  using __async_io::async_renameat_t;
+  inline constexpr async_renameat_t async_renameat{};
+
+  using __async_io::async_wait_signal_t;
+  inline constexpr async_wait_signal_t async_wait_signal{};
+
+  using __async_io::async_eventfd_read_t;
+  inline constexpr async_eventfd_read_t async_eventfd_read{};
+
+  using __async_io::async_eventfd_write_t;
+  inline constexpr async_eventfd_write_t async_eventfd_write{};
+}
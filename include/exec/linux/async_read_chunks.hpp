@@ -0,0 +1,441 @@
+/*
+ * Copyright (c) 2023 Maikel Nadolski
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../../stdexec/execution.hpp"
+#include "../sequence_senders.hpp"
+#include "./async_io.hpp"
+
+#include <memory>
+#include <mutex>
+
+namespace exec {
+  namespace __read_chunks {
+    using namespace stdexec;
+
+    using __chunk_t = std::span<const std::byte>;
+    using __item_sender_t = decltype(stdexec::just(__chunk_t{}));
+
+    template <class _Scheduler>
+    using __read_sender_t =
+      __call_result_t<async_read_t, const _Scheduler&, int, std::span<std::byte>, std::int64_t>;
+
+    using __completion_sigs = stdexec::completion_signatures<
+      set_value_t(__chunk_t),
+      set_error_t(std::exception_ptr),
+      set_stopped_t()>;
+
+    template <class _Scheduler, class _Receiver>
+    struct __operation_base;
+
+    struct __read_env {
+      in_place_stop_token __token_;
+
+      friend in_place_stop_token tag_invoke(get_stop_token_t, const __read_env& __env) noexcept {
+        return __env.__token_;
+      }
+    };
+
+    // Receives the completion of the read into one slot of the read-ahead window.
+    template <class _Scheduler, class _ReceiverId>
+    struct __read_receiver {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t {
+        using is_receiver = void;
+        using __id = __read_receiver;
+
+        __operation_base<_Scheduler, _Receiver>* __op_;
+        std::size_t __slot_;
+
+        template <same_as<set_value_t> _SetValue, same_as<__t> _Self>
+        friend void tag_invoke(_SetValue, _Self&& __self, std::size_t __n_bytes) noexcept {
+          __self.__op_->__on_read(__self.__slot_, __n_bytes, nullptr, false);
+        }
+
+        template <same_as<set_error_t> _SetError, same_as<__t> _Self>
+        friend void tag_invoke(_SetError, _Self&& __self, std::exception_ptr __error) noexcept {
+          __self.__op_->__on_read(__self.__slot_, 0, (std::exception_ptr&&) __error, false);
+        }
+
+        template <same_as<set_stopped_t> _SetStopped, same_as<__t> _Self>
+        friend void tag_invoke(_SetStopped, _Self&& __self) noexcept {
+          __self.__op_->__on_read(__self.__slot_, 0, nullptr, true);
+        }
+
+        template <same_as<get_env_t> _GetEnv, same_as<__t> _Self>
+        friend __read_env tag_invoke(_GetEnv, const _Self& __self) noexcept {
+          return {__self.__op_->__stop_source_.get_token()};
+        }
+      };
+    };
+
+    // Receives the completion of the next-sender of the item that is currently emitted.
+    template <class _Scheduler, class _ReceiverId>
+    struct __item_receiver {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t {
+        using is_receiver = void;
+        using __id = __item_receiver;
+
+        __operation_base<_Scheduler, _Receiver>* __op_;
+
+        template <same_as<set_value_t> _SetValue, same_as<__t> _Self>
+        friend void tag_invoke(_SetValue, _Self&& __self) noexcept {
+          __self.__op_->__on_item_done(false);
+        }
+
+        template <same_as<set_stopped_t> _SetStopped, same_as<__t> _Self>
+        friend void tag_invoke(_SetStopped, _Self&& __self) noexcept {
+          __self.__op_->__on_item_done(true);
+        }
+
+        template <same_as<get_env_t> _GetEnv, same_as<__t> _Self>
+        friend env_of_t<_Receiver> tag_invoke(_GetEnv, const _Self& __self) noexcept {
+          return stdexec::get_env(__self.__op_->__rcvr_);
+        }
+      };
+    };
+
+    template <class _Scheduler, class _Receiver>
+    struct __operation_base {
+      using __read_receiver_t = stdexec::__t<__read_receiver<_Scheduler, __id<_Receiver>>>;
+      using __item_receiver_t = stdexec::__t<__item_receiver<_Scheduler, __id<_Receiver>>>;
+      using __read_op_t = connect_result_t<__read_sender_t<_Scheduler>, __read_receiver_t>;
+      using __item_op_t =
+        connect_result_t<__next_sender_of_t<_Receiver, __item_sender_t>, __item_receiver_t>;
+
+      struct __on_stop {
+        __operation_base* __op_;
+
+        void operator()() const noexcept {
+          __op_->__stop();
+        }
+      };
+
+      using __on_stop_t = typename stop_token_of_t<env_of_t<_Receiver>&>::template callback_type<
+        __on_stop>;
+
+      // Each slot of the read-ahead window owns a chunk of the buffer and the read into it.
+      // A slot is reused for the next chunk as soon as the item of its current chunk is done.
+      struct __slot_state {
+        std::optional<__read_op_t> __read_op_{};
+        std::size_t __chunk_index_{0};
+        std::size_t __n_bytes_{0};
+        bool __is_ready_{false};
+        // The read has been cancelled. Its zero bytes do not mean that the file has ended.
+        bool __is_stopped_{false};
+      };
+
+      _Receiver __rcvr_;
+      _Scheduler __sched_;
+      int __fd_;
+      std::size_t __chunk_size_;
+      std::size_t __n_slots_;
+      std::int64_t __offset_;
+      std::unique_ptr<std::byte[]> __buffer_;
+      std::unique_ptr<__slot_state[]> __slots_;
+      std::optional<__item_op_t> __item_op_{};
+      std::optional<__on_stop_t> __on_receiver_stop_{};
+      in_place_stop_source __stop_source_{};
+
+      std::mutex __mutex_{};
+      std::size_t __next_chunk_{0};
+      std::size_t __n_reads_in_flight_{0};
+      bool __is_emitting_{false};
+      bool __is_eof_{false};
+      bool __is_stopped_{false};
+      // A read has been cancelled although we did not ask for it, e.g. because the io context
+      // has been stopped. The sequence is incomplete and completes with set_stopped.
+      bool __is_cancelled_{false};
+      bool __is_completed_{false};
+      std::exception_ptr __error_{};
+
+      __operation_base(
+        _Receiver&& __rcvr,
+        _Scheduler __sched,
+        int __fd,
+        std::size_t __chunk_size,
+        std::size_t __n_slots,
+        std::int64_t __offset)
+        : __rcvr_((_Receiver&&) __rcvr)
+        , __sched_((_Scheduler&&) __sched)
+        , __fd_{__fd}
+        , __chunk_size_{std::max(__chunk_size, std::size_t{1})}
+        , __n_slots_{std::max(__n_slots, std::size_t{1})}
+        , __offset_{__offset}
+        , __buffer_{std::make_unique<std::byte[]>(__chunk_size_ * __n_slots_)}
+        , __slots_{std::make_unique<__slot_state[]>(__n_slots_)} {
+      }
+
+      std::span<std::byte> __buffer_of(std::size_t __slot) const noexcept {
+        return {__buffer_.get() + __slot * __chunk_size_, __chunk_size_};
+      }
+
+      // Must be called with the mutex held. The read is started by __start_read.
+      void __prepare_read(std::size_t __slot, std::size_t __chunk_index) noexcept {
+        __slots_[__slot].__chunk_index_ = __chunk_index;
+        __slots_[__slot].__is_ready_ = false;
+        __slots_[__slot].__is_stopped_ = false;
+        ++__n_reads_in_flight_;
+      }
+
+      void __start_read(std::size_t __slot) noexcept {
+        __slot_state& __s = __slots_[__slot];
+        const std::int64_t __offset = __offset_
+                                    + static_cast<std::int64_t>(__s.__chunk_index_ * __chunk_size_);
+        try {
+          __s.__read_op_.emplace(__conv{[&] {
+            return stdexec::connect(
+              async_read(__sched_, __fd_, __buffer_of(__slot), __offset),
+              __read_receiver_t{this, __slot});
+          }});
+        } catch (...) {
+          __on_read(__slot, 0, std::current_exception(), false);
+          return;
+        }
+        stdexec::start(*__s.__read_op_);
+      }
+
+      void __start() noexcept {
+        auto __token = stdexec::get_stop_token(stdexec::get_env(__rcvr_));
+        if (__token.stop_requested()) {
+          stdexec::set_stopped((_Receiver&&) __rcvr_);
+          return;
+        }
+        // The reads are counted as in flight before the stop callback is registered. A stop
+        // request during the registration therefore cannot complete the receiver before the
+        // reads have been started and have been cancelled in turn.
+        {
+          std::lock_guard __lock{__mutex_};
+          for (std::size_t __slot = 0; __slot < __n_slots_; ++__slot) {
+            __prepare_read(__slot, __slot);
+          }
+        }
+        __on_receiver_stop_.emplace(__token, __on_stop{this});
+        // The completion of the last read may complete the receiver, which may destroy *this.
+        const std::size_t __n_slots = __n_slots_;
+        for (std::size_t __slot = 0; __slot < __n_slots; ++__slot) {
+          __start_read(__slot);
+        }
+      }
+
+      void __stop() noexcept {
+        {
+          std::lock_guard __lock{__mutex_};
+          __is_stopped_ = true;
+        }
+        __stop_source_.request_stop();
+        __pump();
+      }
+
+      void __on_read(
+        std::size_t __slot,
+        std::size_t __n_bytes,
+        std::exception_ptr __error,
+        bool __is_stopped) noexcept {
+        const bool __has_error = __error != nullptr;
+        {
+          std::lock_guard __lock{__mutex_};
+          --__n_reads_in_flight_;
+          __slots_[__slot].__n_bytes_ = __n_bytes;
+          __slots_[__slot].__is_ready_ = true;
+          __slots_[__slot].__is_stopped_ = __is_stopped;
+          if (__error && !__error_) {
+            __error_ = (std::exception_ptr&&) __error;
+            __is_stopped_ = true;
+          }
+          // Only the io context cancels reads that we did not stop. It cancels the others, too.
+          if (__is_stopped && !__is_stopped_) {
+            __is_cancelled_ = true;
+            __is_stopped_ = true;
+          }
+        }
+        if (__has_error) {
+          __stop_source_.request_stop();
+        }
+        __pump();
+      }
+
+      void __on_item_done(bool __is_stopped) noexcept {
+        std::size_t __slot = __next_chunk_ % __n_slots_;
+        bool __read_next = false;
+        {
+          std::lock_guard __lock{__mutex_};
+          __is_emitting_ = false;
+          __is_stopped_ |= __is_stopped;
+          ++__next_chunk_;
+          if (!__is_eof_ && !__is_stopped_) {
+            __prepare_read(__slot, __next_chunk_ + __n_slots_ - 1);
+            __read_next = true;
+          }
+        }
+        if (__is_stopped) {
+          __stop_source_.request_stop();
+        }
+        if (__read_next) {
+          __start_read(__slot);
+        }
+        __pump();
+      }
+
+      // Emits the next chunk if it is ready or completes the receiver if we are done.
+      // Only one thread emits an item at a time.
+      void __pump() noexcept {
+        std::unique_lock __lock{__mutex_};
+        if (__is_emitting_ || __is_completed_) {
+          return;
+        }
+        __slot_state& __next = __slots_[__next_chunk_ % __n_slots_];
+        if (
+          !__is_stopped_ && !__is_eof_ && __next.__is_ready_ && !__next.__is_stopped_
+          && __next.__chunk_index_ == __next_chunk_) {
+          if (__next.__n_bytes_ == 0) {
+            __is_eof_ = true;
+          } else {
+            // A short read of a regular file means that we reached its end.
+            __is_eof_ = __next.__n_bytes_ < __chunk_size_;
+            __is_emitting_ = true;
+            const std::size_t __slot = __next_chunk_ % __n_slots_;
+            __lock.unlock();
+            __emit(__slot);
+            return;
+          }
+        }
+        if ((__is_stopped_ || __is_eof_) && __n_reads_in_flight_ == 0) {
+          __is_completed_ = true;
+          __lock.unlock();
+          __complete();
+        }
+      }
+
+      void __emit(std::size_t __slot) noexcept {
+        const __chunk_t __chunk{__buffer_of(__slot).data(), __slots_[__slot].__n_bytes_};
+        try {
+          __item_op_.emplace(__conv{[&] {
+            return stdexec::connect(
+              exec::set_next(__rcvr_, stdexec::just(__chunk)), __item_receiver_t{this});
+          }});
+        } catch (...) {
+          {
+            std::lock_guard __lock{__mutex_};
+            __error_ = std::current_exception();
+            __is_stopped_ = true;
+            __is_emitting_ = false;
+          }
+          __stop_source_.request_stop();
+          __pump();
+          return;
+        }
+        stdexec::start(*__item_op_);
+      }
+
+      void __complete() noexcept {
+        __on_receiver_stop_.reset();
+        if (__error_) {
+          stdexec::set_error((_Receiver&&) __rcvr_, (std::exception_ptr&&) __error_);
+        } else if (
+          __is_cancelled_ || stdexec::get_stop_token(stdexec::get_env(__rcvr_)).stop_requested()) {
+          stdexec::set_stopped((_Receiver&&) __rcvr_);
+        } else {
+          stdexec::set_value((_Receiver&&) __rcvr_);
+        }
+      }
+    };
+
+    template <class _Scheduler, class _ReceiverId>
+    struct __operation {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t : __operation_base<_Scheduler, _Receiver> {
+        using __id = __operation;
+        using __operation_base<_Scheduler, _Receiver>::__operation_base;
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          __self.__start();
+        }
+      };
+    };
+
+    template <class _Scheduler>
+    struct __sender {
+      struct __t {
+        using __id = __sender;
+        using is_sender = sequence_tag;
+        using completion_signatures = __completion_sigs;
+
+        _Scheduler __sched_;
+        int __fd_;
+        std::size_t __chunk_size_;
+        std::size_t __n_reads_in_flight_;
+        std::int64_t __offset_;
+
+        template <class _Receiver>
+        using __operation_t = stdexec::__t<__operation<_Scheduler, stdexec::__id<_Receiver>>>;
+
+        template <__decays_to<__t> _Self, receiver _Receiver>
+          requires sequence_receiver_of<_Receiver, completion_signatures>
+                && receiver_of<
+                     _Receiver,
+                     stdexec::completion_signatures<
+                       set_value_t(),
+                       set_error_t(std::exception_ptr),
+                       set_stopped_t()>>
+        friend auto tag_invoke(subscribe_t, _Self&& __self, _Receiver __rcvr)
+          -> __operation_t<_Receiver> {
+          return {
+            (_Receiver&&) __rcvr,
+            __self.__sched_,
+            __self.__fd_,
+            __self.__chunk_size_,
+            __self.__n_reads_in_flight_,
+            __self.__offset_};
+        }
+      };
+    };
+
+    struct async_read_chunks_t {
+      template <class _Scheduler>
+        requires __callable<
+          async_read_t,
+          const _Scheduler&,
+          int,
+          std::span<std::byte>,
+          std::int64_t>
+      auto operator()(
+        _Scheduler __sched,
+        int __fd,
+        std::size_t __chunk_size,
+        std::size_t __n_reads_in_flight = 4,
+        std::int64_t __offset = 0) const -> stdexec::__t<__sender<_Scheduler>> {
+        return {(_Scheduler&&) __sched, __fd, __chunk_size, __n_reads_in_flight, __offset};
+      }
+    };
+  }
+
+  // async_read_chunks(sched, fd, chunk_size, n_reads_in_flight = 4, offset = 0)
+  //
+  // Returns a sequence sender that reads the file from the given offset to its end in chunks of
+  // chunk_size bytes with async_read on the given scheduler. It keeps up to n_reads_in_flight
+  // reads in flight and emits the chunks in order as items that complete with
+  // set_value(std::span<const std::byte>). A chunk is valid until the next-sender of its item
+  // completes. Only then its buffer is reused for another read. If a read is cancelled, e.g.
+  // because the io context has been stopped, the sequence completes with set_stopped.
+  using __read_chunks::async_read_chunks_t;
+  inline constexpr async_read_chunks_t async_read_chunks{};
+}
@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2023 Maikel Nadolski
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../../stdexec/execution.hpp"
+#include "../../stdexec/__detail/__intrusive_queue.hpp"
+#include "./async_io.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <vector>
+
+#include <sys/uio.h>
+
+namespace exec {
+  namespace __coalescing {
+    using namespace stdexec;
+
+#ifdef IOV_MAX
+    inline constexpr std::size_t __iov_max = IOV_MAX;
+#else
+    inline constexpr std::size_t __iov_max = 1024;
+#endif
+
+    // The type-erased part of a write that waits in the queue of a writer.
+    struct __write_base {
+      using __complete_fn = void(__write_base*, std::exception_ptr, bool) noexcept;
+
+      __write_base* __next_{nullptr};
+      std::span<const std::byte> __buffer_{};
+      std::size_t __n_written_{0};
+      __complete_fn* __complete_{nullptr};
+
+      std::size_t __remaining() const noexcept {
+        return __buffer_.size() - __n_written_;
+      }
+    };
+
+    using __write_queue = __intrusive_queue<&__write_base::__next_>;
+
+    template <class _Scheduler>
+    class __writer;
+
+    template <class _Scheduler, class _ReceiverId>
+    struct __operation {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t : __write_base {
+        using __id = __operation;
+
+        __writer<_Scheduler>* __writer_;
+        _Receiver __rcvr_;
+
+        __t(__writer<_Scheduler>* __writer, std::span<const std::byte> __buffer, _Receiver&& __rcvr)
+          : __write_base{.__buffer_ = __buffer, .__complete_ = &__complete}
+          , __writer_{__writer}
+          , __rcvr_((_Receiver&&) __rcvr) {
+        }
+
+        static void
+          __complete(__write_base* __base, std::exception_ptr __error, bool __is_stopped) noexcept {
+          __t* __self = static_cast<__t*>(__base);
+          if (__error) {
+            stdexec::set_error((_Receiver&&) __self->__rcvr_, (std::exception_ptr&&) __error);
+          } else if (__is_stopped) {
+            stdexec::set_stopped((_Receiver&&) __self->__rcvr_);
+          } else {
+            stdexec::set_value((_Receiver&&) __self->__rcvr_, __self->__n_written_);
+          }
+        }
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          __self.__writer_->__enqueue(&__self);
+        }
+      };
+    };
+
+    template <class _Scheduler>
+    struct __sender {
+      struct __t {
+        using __id = __sender;
+        using is_sender = void;
+        using completion_signatures = stdexec::completion_signatures<
+          set_value_t(std::size_t),
+          set_error_t(std::exception_ptr),
+          set_stopped_t()>;
+
+        __writer<_Scheduler>* __writer_;
+        std::span<const std::byte> __buffer_;
+
+        template <receiver_of<completion_signatures> _Receiver>
+        friend auto tag_invoke(connect_t, const __t& __self, _Receiver __rcvr)
+          -> stdexec::__t<__operation<_Scheduler, stdexec::__id<_Receiver>>> {
+          return {__self.__writer_, __self.__buffer_, (_Receiver&&) __rcvr};
+        }
+      };
+    };
+
+    // Gathers the writes that are queued while a write is in flight into a single vectored
+    // write. The writes of one writer are performed in the order in which they were started and
+    // each of them completes with its own number of bytes. The writer has to outlive all of its
+    // writes.
+    template <class _Scheduler>
+    class __writer {
+     public:
+      // An offset of -1 writes at the current file position, which is the only choice for pipes
+      // and sockets. Otherwise the writer advances the offset by the number of written bytes.
+      __writer(
+        _Scheduler __sched,
+        int __fd,
+        std::int64_t __offset = -1,
+        std::size_t __max_batch_size = __iov_max)
+        : __sched_((_Scheduler&&) __sched)
+        , __fd_{__fd}
+        , __offset_{__offset}
+        , __max_batch_size_{std::clamp(__max_batch_size, std::size_t{1}, __iov_max)} {
+        __iovecs_.reserve(__max_batch_size_);
+      }
+
+      __writer(__writer&&) = delete;
+
+      // async_write(std::span<const std::byte> buffer)
+      //   completes with set_value(std::size_t n_bytes_written) after the whole buffer has been
+      //   written. The buffer has to stay valid until then.
+      stdexec::__t<__sender<_Scheduler>> async_write(std::span<const std::byte> __buffer) noexcept {
+        return {this, __buffer};
+      }
+
+      void __enqueue(__write_base* __write) noexcept {
+        std::unique_lock __lock{__mutex_};
+        __queue_.push_back(__write);
+        if (__is_writing_) {
+          return;
+        }
+        __is_writing_ = true;
+        const std::int64_t __offset = __prepare_batch();
+        __lock.unlock();
+        __start_writev(__offset);
+      }
+
+     private:
+      struct __writev_state;
+
+      struct __receiver {
+        using is_receiver = void;
+
+        __writev_state* __state_;
+
+        template <same_as<set_value_t> _SetValue, same_as<__receiver> _Self>
+        friend void tag_invoke(_SetValue, _Self&& __self, std::size_t __n_bytes) noexcept {
+          __self.__state_->__finish(__n_bytes, nullptr, false);
+        }
+
+        template <same_as<set_error_t> _SetError, same_as<__receiver> _Self>
+        friend void tag_invoke(_SetError, _Self&& __self, std::exception_ptr __error) noexcept {
+          __self.__state_->__finish(0, (std::exception_ptr&&) __error, false);
+        }
+
+        template <same_as<set_stopped_t> _SetStopped, same_as<__receiver> _Self>
+        friend void tag_invoke(_SetStopped, _Self&& __self) noexcept {
+          __self.__state_->__finish(0, nullptr, true);
+        }
+
+        friend empty_env tag_invoke(get_env_t, const __receiver&) noexcept {
+          return {};
+        }
+      };
+
+      using __writev_sender_t = __call_result_t<
+        async_writev_t,
+        const _Scheduler&,
+        int,
+        std::span<const ::iovec>,
+        std::int64_t>;
+      using __writev_op_t = connect_result_t<__writev_sender_t, __receiver>;
+
+      // The operation state of one vectored write. It is allocated per batch and deletes itself
+      // on completion, since the completion may start the next batch on another thread.
+      struct __writev_state {
+        __writer* __writer_;
+        std::optional<__writev_op_t> __op_{};
+
+        void
+          __finish(std::size_t __n_bytes, std::exception_ptr __error, bool __is_stopped) noexcept {
+          __writer* __self = __writer_;
+          delete this;
+          __self->__on_written(__n_bytes, (std::exception_ptr&&) __error, __is_stopped);
+        }
+      };
+
+      // Moves the front of the queue into the current batch and returns the offset of the write.
+      // Must be called with the mutex held.
+      std::int64_t __prepare_batch() noexcept {
+        __iovecs_.clear();
+        while (!__queue_.empty() && __iovecs_.size() < __max_batch_size_) {
+          __write_base* __write = __queue_.pop_front();
+          std::span<const std::byte> __rest = __write->__buffer_.subspan(__write->__n_written_);
+          __iovecs_.push_back(::iovec{const_cast<std::byte*>(__rest.data()), __rest.size()});
+          __batch_.push_back(__write);
+        }
+        return __offset_;
+      }
+
+      void __start_writev(std::int64_t __offset) noexcept {
+        try {
+          __writev_state* __state = new __writev_state{this};
+          try {
+            __state->__op_.emplace(__conv{[&] {
+              return stdexec::connect(
+                async_writev(__sched_, __fd_, std::span<const ::iovec>{__iovecs_}, __offset),
+                __receiver{__state});
+            }});
+          } catch (...) {
+            delete __state;
+            throw;
+          }
+          stdexec::start(*__state->__op_);
+        } catch (...) {
+          __on_written(0, std::current_exception(), false);
+        }
+      }
+
+      void
+        __on_written(std::size_t __n_bytes, std::exception_ptr __error, bool __is_stopped) noexcept {
+        __write_queue __done{};
+        __write_queue __failed{};
+        std::unique_lock __lock{__mutex_};
+        if (!__error && !__is_stopped && __n_bytes == 0 && __has_remaining_bytes()) {
+          // No progress is possible. Reporting a partial write as success would break the
+          // promise that a write completes after its whole buffer has been written.
+          __error = std::make_exception_ptr(std::system_error(EIO, std::system_category()));
+        }
+        if (__error || __is_stopped) {
+          // The writes after a failed one must not be performed, otherwise the order of the
+          // data would be broken. We fail all queued writes.
+          __failed.append((__write_queue&&) __batch_);
+          __failed.append((__write_queue&&) __queue_);
+        } else {
+          if (__offset_ >= 0) {
+            __offset_ += static_cast<std::int64_t>(__n_bytes);
+          }
+          while (!__batch_.empty()) {
+            __write_base* __write = __batch_.pop_front();
+            const std::size_t __n = std::min(__n_bytes, __write->__remaining());
+            __write->__n_written_ += __n;
+            __n_bytes -= __n;
+            if (__write->__remaining() == 0) {
+              __done.push_back(__write);
+            } else {
+              // A short write. The rest of the batch goes first into the next batch.
+              __batch_.push_front(__write);
+              __queue_.prepend((__write_queue&&) __batch_);
+              break;
+            }
+          }
+        }
+        bool __start_next = false;
+        std::int64_t __offset = -1;
+        if (__queue_.empty()) {
+          __is_writing_ = false;
+        } else {
+          __start_next = true;
+          __offset = __prepare_batch();
+        }
+        __lock.unlock();
+        if (__start_next) {
+          __start_writev(__offset);
+        }
+        while (!__done.empty()) {
+          __write_base* __write = __done.pop_front();
+          __write->__complete_(__write, nullptr, false);
+        }
+        while (!__failed.empty()) {
+          __write_base* __write = __failed.pop_front();
+          __write->__complete_(__write, __error, __is_stopped);
+        }
+      }
+
+      // Must be called with the mutex held. The iovecs describe the rest of the current batch.
+      bool __has_remaining_bytes() const noexcept {
+        return std::ranges::any_of(__iovecs_, [](const ::iovec& __iov) {
+          return __iov.iov_len != 0;
+        });
+      }
+
+      _Scheduler __sched_;
+      int __fd_;
+      std::int64_t __offset_;
+      std::size_t __max_batch_size_;
+      std::mutex __mutex_{};
+      __write_queue __queue_{};
+      __write_queue __batch_{};
+      std::vector<::iovec> __iovecs_{};
+      bool __is_writing_{false};
+    };
+  }
+
+  template <class _Scheduler>
+  using coalescing_writer = __coalescing::__writer<_Scheduler>;
+}
@@ -0,0 +1,1332 @@
+/*
+ * Copyright (c) 2023 Maikel Nadolski
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../../stdexec/execution.hpp"
+#include "../../stdexec/__detail/__intrusive_queue.hpp"
+#include "../timed_scheduler.hpp"
+
+#include "../__detail/__atomic_intrusive_queue.hpp"
+
+#include "./safe_file_descriptor.hpp"
+#include "./async_io.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// An execution context that is driven by epoll. It provides the same scheduler interface as the
+// io_uring_context, i.e. schedule, the timed scheduling of exec::timed_scheduler and the io
+// senders of async_io.hpp that operate on file descriptors with a readiness notion, such as
+// pipes, sockets, eventfds and signalfds. It is meant as a fallback for systems where io_uring
+// is not available.
+//
+// The supported io senders are async_read, async_write, async_writev, async_poll, async_accept,
+// async_connect, async_send, async_recv, async_wait_signal, async_eventfd_read and
+// async_eventfd_write. The others, such as async_send_zc, async_splice, async_openat or
+// async_fsync, have no readiness notion and are only provided by the io_uring_context.
+//
+// Each io operation waits for the readiness of its file descriptor and then performs a single
+// system call on the driving thread. async_connect starts the connection before it waits. File
+// descriptors should be non-blocking, a blocking system call blocks the driving thread. Regular
+// files are always ready, their io is performed synchronously.
+namespace exec {
+  namespace __epoll {
+    inline void __throw_error_code_if(bool __cond, int __ec) {
+      if (__cond) {
+        throw std::system_error(__ec, std::system_category());
+      }
+    }
+
+    class __context;
+
+    // This is the base class of all operations that are submitted to an epoll context.
+    // __execute_ is called on the thread that drives the context. If __is_stopped is true, the
+    // context has been stopped and the task must complete without waiting for events.
+    struct __task : stdexec::__immovable {
+      using __execute_fn = void(__task*, bool __is_stopped) noexcept;
+
+      __task* __next_{nullptr};
+      __execute_fn* __execute_;
+
+      explicit __task(__execute_fn* __execute) noexcept
+        : __execute_{__execute} {
+      }
+    };
+
+    using __task_queue = stdexec::__intrusive_queue<&__task::__next_>;
+    using __atomic_task_queue = __atomic_intrusive_queue<&__task::__next_>;
+
+    struct __op_base;
+
+    struct __op_vtable {
+      // Registers the operation with the context. Returns false if it has completed right away.
+      bool (*__wait_)(__op_base*) noexcept;
+      // Unregisters a waiting operation from the context.
+      void (*__cancel_)(__op_base*) noexcept;
+      // Installs the stop callbacks of the operation once it waits.
+      void (*__arm_)(__op_base*) noexcept;
+      // Removes the stop callbacks and completes the receiver.
+      void (*__complete_)(__op_base*) noexcept;
+    };
+
+    // This is the base class of all operations that wait for an event, i.e. for a timer or for
+    // the readiness of a file descriptor.
+    //
+    // An operation completes once its wait has ended and, if a stop has been requested, once its
+    // stop task has been executed. __n_ops_ counts both of them.
+    struct __op_base : __task {
+      struct __stop_task : __task {
+        __op_base* __op_;
+
+        explicit __stop_task(__op_base* __op) noexcept
+          : __task{&__execute}
+          , __op_{__op} {
+        }
+
+        static void __execute(__task* __pointer, bool __is_stopped) noexcept {
+          __op_base* __op = static_cast<__stop_task*>(__pointer)->__op_;
+          // If the context has been stopped the wait of the operation is ended by the context
+          if (!__is_stopped && __op->__is_waiting_) {
+            __op->__vtable_->__cancel_(__op);
+            __op->__is_waiting_ = false;
+            __op->__is_cancelled_ = true;
+            __op->__finish();
+          }
+          __op->__finish();
+        }
+      };
+
+      const __op_vtable* __vtable_;
+      __context* __context_;
+      __stop_task __stop_task_{this};
+      std::atomic<int> __n_ops_{1};
+      bool __is_waiting_{false};
+      bool __is_cancelled_{false};
+
+      __op_base(const __op_vtable& __vtable, __context& __context) noexcept
+        : __task{&__execute}
+        , __vtable_{&__vtable}
+        , __context_{&__context} {
+      }
+
+      static void __execute(__task* __pointer, bool __is_stopped) noexcept {
+        __op_base* __self = static_cast<__op_base*>(__pointer);
+        if (__is_stopped) {
+          __self->__is_cancelled_ = true;
+          __self->__finish();
+        } else if (__self->__vtable_->__wait_(__self)) {
+          __self->__is_waiting_ = true;
+          __self->__vtable_->__arm_(__self);
+        } else {
+          __self->__finish();
+        }
+      }
+
+      // Called by the context when the event has occurred.
+      void __wake() noexcept {
+        __is_waiting_ = false;
+        __finish();
+      }
+
+      // Called by the context when it has been stopped while the operation waits.
+      void __stop() noexcept {
+        __is_waiting_ = false;
+        __is_cancelled_ = true;
+        __finish();
+      }
+
+      void __finish() noexcept {
+        if (__n_ops_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          __vtable_->__complete_(this);
+        }
+      }
+
+      // This is the stop callback. It may be called on any thread.
+      void __request_stop() noexcept;
+    };
+
+    // A timer waits in a binary heap of the context, which is ordered by the deadlines.
+    struct __timer_base : __op_base {
+      std::chrono::steady_clock::time_point __deadline_;
+      std::size_t __heap_index_{0};
+
+      __timer_base(
+        const __op_vtable& __vtable,
+        __context& __context,
+        std::chrono::steady_clock::time_point __deadline) noexcept
+        : __op_base{__vtable, __context}
+        , __deadline_{__deadline} {
+      }
+
+      static bool __wait(__op_base* __op) noexcept;
+      static void __cancel(__op_base* __op) noexcept;
+    };
+
+    // An io operation waits in the list of waiters of its file descriptor. Once the descriptor is
+    // ready for any of the requested events, __perform_ performs the system call and returns its
+    // result, or the negated errno on failure. If there is a __begin_ function, it is called
+    // before the operation waits. The operation only waits if it returns -EINPROGRESS.
+    struct __io_base : __op_base {
+      using __perform_fn = ::ssize_t(__io_base*, std::uint32_t __revents) noexcept;
+      using __begin_fn = ::ssize_t(__io_base*) noexcept;
+
+      int __fd_;
+      std::uint32_t __events_;
+      __perform_fn* __perform_;
+      __begin_fn* __begin_;
+      __io_base* __prev_waiter_{nullptr};
+      __io_base* __next_waiter_{nullptr};
+      ::ssize_t __result_{0};
+
+      __io_base(
+        const __op_vtable& __vtable,
+        __context& __context,
+        int __fd,
+        std::uint32_t __events,
+        __perform_fn* __perform,
+        __begin_fn* __begin) noexcept
+        : __op_base{__vtable, __context}
+        , __fd_{__fd}
+        , __events_{__events}
+        , __perform_{__perform}
+        , __begin_{__begin} {
+      }
+
+      static bool __wait(__op_base* __op) noexcept;
+      static void __cancel(__op_base* __op) noexcept;
+    };
+
+    class __scheduler;
+
+    class __context : stdexec::__immovable {
+     public:
+      __context()
+        : __epoll_fd_{::epoll_create1(EPOLL_CLOEXEC)}
+        , __eventfd_{::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)}
+        , __timerfd_{::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK)} {
+        __throw_error_code_if(!__epoll_fd_ || !__eventfd_ || !__timerfd_, errno);
+        ::epoll_event __event{};
+        __event.events = EPOLLIN;
+        __event.data.fd = __eventfd_;
+        __throw_error_code_if(
+          ::epoll_ctl(__epoll_fd_, EPOLL_CTL_ADD, __eventfd_, &__event) < 0, errno);
+        __event.data.fd = __timerfd_;
+        __throw_error_code_if(
+          ::epoll_ctl(__epoll_fd_, EPOLL_CTL_ADD, __timerfd_, &__event) < 0, errno);
+      }
+
+      __scheduler get_scheduler() noexcept;
+
+      void request_stop() {
+        __stop_source_.request_stop();
+        __signal();
+      }
+
+      bool stop_requested() const noexcept {
+        return __stop_source_.stop_requested();
+      }
+
+      stdexec::in_place_stop_token get_stop_token() const noexcept {
+        return __stop_source_.get_token();
+      }
+
+      bool is_running() const noexcept {
+        return __is_running_.load(std::memory_order_relaxed);
+      }
+
+      /// @brief Returns the epoll file descriptor of this context.
+      int native_handle() const noexcept {
+        return __epoll_fd_;
+      }
+
+      /// @brief Drives the context on the calling thread until request_stop() is called. All
+      /// pending operations are then completed with set_stopped.
+      void run_until_stopped() {
+        __run(false);
+      }
+
+      /// @brief Drives the context on the calling thread until no operation is pending.
+      void run_until_empty() {
+        __run(true);
+      }
+
+      /// \brief Submits the given task to the driving thread.
+      /// \returns false if the context has been stopped. The task must then complete inline.
+      bool submit(__task* __op) noexcept {
+        int __n = 0;
+        while (__n != __no_new_submissions
+               && !__n_submissions_in_flight_.compare_exchange_weak(
+                 __n, __n + 1, std::memory_order_acquire, std::memory_order_relaxed))
+          ;
+        if (__n == __no_new_submissions) {
+          return false;
+        }
+        __requests_.push_front(__op);
+        __n_submissions_in_flight_.fetch_sub(1, std::memory_order_release);
+        wakeup();
+        return true;
+      }
+
+      /// @brief Wakes up the thread that drives this context to take new submissions.
+      void wakeup() {
+        if (__current_context_ == this) {
+          return;
+        }
+        if (!__wakeup_pending_.exchange(true)) {
+          __signal();
+        }
+      }
+
+      // The number of operations that have been started and have not completed yet
+      std::atomic<std::ptrdiff_t> __n_outstanding_{0};
+
+     private:
+      friend struct __timer_base;
+      friend struct __io_base;
+
+      static constexpr int __no_new_submissions = -1;
+      static constexpr int __max_events = 64;
+
+      struct __fd_state {
+        __io_base* __head_{nullptr};
+        __io_base* __tail_{nullptr};
+        std::uint32_t __events_{0};
+      };
+
+      void __signal() {
+        std::uint64_t __wakeup = 1;
+        __throw_error_code_if(::write(__eventfd_, &__wakeup, sizeof(__wakeup)) == -1, errno);
+      }
+
+      void __run(bool __until_empty) {
+        __context* __previous = std::exchange(__current_context_, this);
+        __is_running_.store(true, std::memory_order_relaxed);
+        ::epoll_event __events[__max_events];
+        while (true) {
+          __wakeup_pending_.store(true, std::memory_order_release);
+          __execute_requests();
+          __fire_timers();
+          if (stop_requested() || (__until_empty && __n_outstanding_.load() == 0)) {
+            break;
+          }
+          // A submission after this point either sees the flag cleared and signals the eventfd or
+          // is visible in the queue of requests.
+          __wakeup_pending_.store(false);
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          int __timeout = __requests_.empty() ? -1 : 0;
+          __arm_timer();
+          int __n = ::epoll_wait(__epoll_fd_, __events, __max_events, __timeout);
+          if (__n < 0) {
+            __throw_error_code_if(errno != EINTR, errno);
+            __n = 0;
+          }
+          for (int __i = 0; __i < __n; ++__i) {
+            const int __fd = __events[__i].data.fd;
+            if (__fd == __eventfd_ || __fd == __timerfd_) {
+              std::uint64_t __count;
+              [[maybe_unused]] auto __rc = ::read(__fd, &__count, sizeof(__count));
+            } else {
+              __on_ready(__fd, __events[__i].events);
+            }
+          }
+        }
+        if (stop_requested()) {
+          __stop_all();
+        }
+        __is_running_.store(false, std::memory_order_relaxed);
+        __current_context_ = __previous;
+      }
+
+      void __execute_requests() noexcept {
+        __task_queue __tasks = __requests_.pop_all();
+        while (!__tasks.empty()) {
+          __task* __op = __tasks.pop_front();
+          __op->__execute_(__op, false);
+        }
+      }
+
+      // Closes the context for new submissions and completes all pending operations.
+      void __stop_all() noexcept {
+        int __n = 0;
+        while (!__n_submissions_in_flight_.compare_exchange_weak(
+          __n, __no_new_submissions, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+          __n = 0;
+        }
+        __task_queue __tasks = __requests_.pop_all();
+        while (!__tasks.empty()) {
+          __task* __op = __tasks.pop_front();
+          __op->__execute_(__op, true);
+        }
+        std::vector<__timer_base*> __timers = std::move(__timers_);
+        __timers_.clear();
+        for (__timer_base* __timer: __timers) {
+          __timer->__stop();
+        }
+        std::vector<__io_base*> __waiters;
+        for (auto& [__fd, __state]: __fds_) {
+          ::epoll_ctl(__epoll_fd_, EPOLL_CTL_DEL, __fd, nullptr);
+          for (__io_base* __op = __state.__head_; __op; __op = __op->__next_waiter_) {
+            __waiters.push_back(__op);
+          }
+        }
+        __fds_.clear();
+        for (__io_base* __op: __waiters) {
+          __op->__stop();
+        }
+      }
+
+      // timers
+
+      static bool __earlier(const __timer_base* __lhs, const __timer_base* __rhs) noexcept {
+        return __lhs->__deadline_ < __rhs->__deadline_;
+      }
+
+      void __place(std::size_t __index, __timer_base* __timer) noexcept {
+        __timers_[__index] = __timer;
+        __timer->__heap_index_ = __index;
+      }
+
+      void __sift_up(std::size_t __index) noexcept {
+        __timer_base* __timer = __timers_[__index];
+        while (__index > 0) {
+          const std::size_t __parent = (__index - 1) / 2;
+          if (!__earlier(__timer, __timers_[__parent])) {
+            break;
+          }
+          __place(__index, __timers_[__parent]);
+          __index = __parent;
+        }
+        __place(__index, __timer);
+      }
+
+      void __sift_down(std::size_t __index) noexcept {
+        __timer_base* __timer = __timers_[__index];
+        const std::size_t __size = __timers_.size();
+        while (true) {
+          std::size_t __child = 2 * __index + 1;
+          if (__child >= __size) {
+            break;
+          }
+          if (__child + 1 < __size && __earlier(__timers_[__child + 1], __timers_[__child])) {
+            ++__child;
+          }
+          if (!__earlier(__timers_[__child], __timer)) {
+            break;
+          }
+          __place(__index, __timers_[__child]);
+          __index = __child;
+        }
+        __place(__index, __timer);
+      }
+
+      bool __push_timer(__timer_base* __timer) noexcept {
+        try {
+          __timers_.push_back(__timer);
+        } catch (...) {
+          return false;
+        }
+        __sift_up(__timers_.size() - 1);
+        return true;
+      }
+
+      void __erase_timer(__timer_base* __timer) noexcept {
+        const std::size_t __index = __timer->__heap_index_;
+        __timer_base* __last = __timers_.back();
+        __timers_.pop_back();
+        if (__last != __timer) {
+          __place(__index, __last);
+          __sift_up(__index);
+          __sift_down(__last->__heap_index_);
+        }
+      }
+
+      void __fire_timers() noexcept {
+        const auto __now = std::chrono::steady_clock::now();
+        while (!__timers_.empty() && __timers_.front()->__deadline_ <= __now) {
+          __timer_base* __timer = __timers_.front();
+          __erase_timer(__timer);
+          __timer->__wake();
+        }
+      }
+
+      // Sets the timerfd to the earliest deadline if it has changed.
+      void __arm_timer() {
+        const auto __deadline = __timers_.empty() ? std::chrono::steady_clock::time_point{}
+                                                  : __timers_.front()->__deadline_;
+        if (__deadline == __armed_deadline_) {
+          return;
+        }
+        __armed_deadline_ = __deadline;
+        ::itimerspec __spec{};
+        if (!__timers_.empty()) {
+          auto __since_epoch = __deadline.time_since_epoch();
+          auto __sec = std::chrono::duration_cast<std::chrono::seconds>(__since_epoch);
+          auto __nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(__since_epoch - __sec);
+          __spec.it_value.tv_sec = std::max<std::int64_t>(__sec.count(), 0);
+          // A zero it_value disarms the timer
+          __spec.it_value.tv_nsec = std::max<std::int64_t>(__nsec.count(), 1);
+        }
+        __throw_error_code_if(
+          ::timerfd_settime(__timerfd_, TFD_TIMER_ABSTIME, &__spec, nullptr) < 0, errno);
+      }
+
+      // file descriptors
+
+      // Returns false if the operation has completed right away.
+      bool __add_waiter(__io_base* __op) noexcept {
+        try {
+          auto [__it, __inserted] = __fds_.try_emplace(__op->__fd_);
+          __fd_state& __state = __it->second;
+          const std::uint32_t __events = __state.__events_ | __op->__events_;
+          if (__events != __state.__events_) {
+            ::epoll_event __event{};
+            __event.events = __events;
+            __event.data.fd = __op->__fd_;
+            const int __ctl = __inserted ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+            if (::epoll_ctl(__epoll_fd_, __ctl, __op->__fd_, &__event) < 0) {
+              const int __ec = errno;
+              if (__inserted) {
+                __fds_.erase(__it);
+              }
+              // Regular files do not support epoll. They are always ready.
+              __op->__result_ = __ec == EPERM ? __op->__perform_(__op, __op->__events_) : -__ec;
+              return false;
+            }
+            __state.__events_ = __events;
+          }
+          __op->__prev_waiter_ = __state.__tail_;
+          __op->__next_waiter_ = nullptr;
+          (__state.__tail_ ? __state.__tail_->__next_waiter_ : __state.__head_) = __op;
+          __state.__tail_ = __op;
+          return true;
+        } catch (...) {
+          __op->__result_ = -ENOMEM;
+          return false;
+        }
+      }
+
+      void __unlink_waiter(__fd_state& __state, __io_base* __op) noexcept {
+        (__op->__prev_waiter_ ? __op->__prev_waiter_->__next_waiter_ : __state.__head_) =
+          __op->__next_waiter_;
+        (__op->__next_waiter_ ? __op->__next_waiter_->__prev_waiter_ : __state.__tail_) =
+          __op->__prev_waiter_;
+        __op->__prev_waiter_ = nullptr;
+        __op->__next_waiter_ = nullptr;
+      }
+
+      // Registers the union of the events of the remaining waiters with epoll.
+      void __update_interest(int __fd) noexcept {
+        auto __it = __fds_.find(__fd);
+        if (__it == __fds_.end()) {
+          return;
+        }
+        __fd_state& __state = __it->second;
+        std::uint32_t __events = 0;
+        for (__io_base* __op = __state.__head_; __op; __op = __op->__next_waiter_) {
+          __events |= __op->__events_;
+        }
+        if (__events == 0) {
+          ::epoll_ctl(__epoll_fd_, EPOLL_CTL_DEL, __fd, nullptr);
+          __fds_.erase(__it);
+        } else if (__events != __state.__events_) {
+          ::epoll_event __event{};
+          __event.events = __events;
+          __event.data.fd = __fd;
+          ::epoll_ctl(__epoll_fd_, EPOLL_CTL_MOD, __fd, &__event);
+          __state.__events_ = __events;
+        }
+      }
+
+      void __remove_waiter(__io_base* __op) noexcept {
+        auto __it = __fds_.find(__op->__fd_);
+        STDEXEC_ASSERT(__it != __fds_.end());
+        __unlink_waiter(__it->second, __op);
+        __update_interest(__op->__fd_);
+      }
+
+      // Performs the operations that wait for the reported events in FIFO order. Only the first
+      // waiter for each event is performed, such that a blocking file descriptor does not block
+      // the driving thread. The others are performed after the next notification.
+      void __on_ready(int __fd, std::uint32_t __revents) noexcept {
+        auto __it = __fds_.find(__fd);
+        if (__it == __fds_.end()) {
+          return;
+        }
+        __fd_state& __state = __it->second;
+        const bool __is_error = __revents & (EPOLLERR | EPOLLHUP);
+        std::uint32_t __consumed = 0;
+        __task_queue __done{};
+        __io_base* __next = __state.__head_;
+        while (__next) {
+          __io_base* __op = std::exchange(__next, __next->__next_waiter_);
+          const std::uint32_t __wanted = __op->__events_ & ~__consumed;
+          if (!(__wanted & __revents) && !(__is_error && __wanted)) {
+            continue;
+          }
+          const ::ssize_t __rc = __op->__perform_(__op, __revents);
+          __consumed |= __op->__events_;
+          if (__rc == -EAGAIN || __rc == -EWOULDBLOCK) {
+            continue;
+          }
+          __op->__result_ = __rc;
+          __unlink_waiter(__state, __op);
+          __done.push_back(__op);
+        }
+        if (!__done.empty()) {
+          __update_interest(__fd);
+        }
+        while (!__done.empty()) {
+          static_cast<__io_base*>(__done.pop_front())->__wake();
+        }
+      }
+
+      inline static thread_local __context* __current_context_ = nullptr;
+
+      safe_file_descriptor __epoll_fd_;
+      safe_file_descriptor __eventfd_;
+      safe_file_descriptor __timerfd_;
+      stdexec::in_place_stop_source __stop_source_{};
+      std::atomic<bool> __is_running_{false};
+      std::atomic<bool> __wakeup_pending_{false};
+      std::atomic<int> __n_submissions_in_flight_{0};
+      __atomic_task_queue __requests_{};
+      // The following members are only accessed by the driving thread
+      std::vector<__timer_base*> __timers_{};
+      std::chrono::steady_clock::time_point __armed_deadline_{};
+      std::unordered_map<int, __fd_state> __fds_{};
+    };
+
+    inline void __op_base::__request_stop() noexcept {
+      int __expected = 1;
+      if (__n_ops_.compare_exchange_strong(__expected, 2, std::memory_order_relaxed)) {
+        if (!__context_->submit(&__stop_task_)) {
+          __stop_task::__execute(&__stop_task_, true);
+        }
+      }
+    }
+
+    inline bool __timer_base::__wait(__op_base* __op) noexcept {
+      __timer_base* __self = static_cast<__timer_base*>(__op);
+      if (__self->__deadline_ <= std::chrono::steady_clock::now()) {
+        return false;
+      }
+      return __self->__context_->__push_timer(__self);
+    }
+
+    inline void __timer_base::__cancel(__op_base* __op) noexcept {
+      __timer_base* __self = static_cast<__timer_base*>(__op);
+      __self->__context_->__erase_timer(__self);
+    }
+
+    inline bool __io_base::__wait(__op_base* __op) noexcept {
+      __io_base* __self = static_cast<__io_base*>(__op);
+      if (__self->__begin_) {
+        const ::ssize_t __rc = __self->__begin_(__self);
+        if (__rc != -EINPROGRESS) {
+          __self->__result_ = __rc;
+          return false;
+        }
+      }
+      return __self->__context_->__add_waiter(__self);
+    }
+
+    inline void __io_base::__cancel(__op_base* __op) noexcept {
+      __io_base* __self = static_cast<__io_base*>(__op);
+      __self->__context_->__remove_waiter(__self);
+    }
+
+    template <class _ReceiverId>
+    struct __schedule_operation {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t : __task {
+        using __id = __schedule_operation;
+
+        __context& __context_;
+        STDEXEC_NO_UNIQUE_ADDRESS _Receiver __receiver_;
+
+        __t(__context& __context, _Receiver&& __receiver)
+          : __task{&__execute}
+          , __context_{__context}
+          , __receiver_{(_Receiver&&) __receiver} {
+        }
+
+        static void __execute(__task* __pointer, bool __is_stopped) noexcept {
+          __t* __self = static_cast<__t*>(__pointer);
+          __self->__context_.__n_outstanding_.fetch_sub(1, std::memory_order_relaxed);
+          auto __token = stdexec::get_stop_token(stdexec::get_env(__self->__receiver_));
+          if (__is_stopped || __self->__context_.stop_requested() || __token.stop_requested()) {
+            stdexec::set_stopped((_Receiver&&) __self->__receiver_);
+          } else {
+            stdexec::set_value((_Receiver&&) __self->__receiver_);
+          }
+        }
+
+        friend void tag_invoke(stdexec::start_t, __t& __self) noexcept {
+          __self.__context_.__n_outstanding_.fetch_add(1, std::memory_order_relaxed);
+          if (!__self.__context_.submit(&__self)) {
+            __execute(&__self, true);
+          }
+        }
+      };
+    };
+
+    // Adds the receiver and the stop callbacks to a timer or an io operation. _Derived provides
+    // __deliver(), which completes the receiver after a successful wait.
+    template <class _Base, class _Receiver>
+    struct __stoppable_op : _Base {
+      struct __stop_callback {
+        __op_base* __op_;
+
+        void operator()() noexcept {
+          __op_->__request_stop();
+        }
+      };
+
+      using __on_context_stop_t = std::optional<stdexec::in_place_stop_callback<__stop_callback>>;
+      using __on_receiver_stop_t = std::optional<typename stdexec::stop_token_of_t<
+        stdexec::env_of_t<_Receiver>&>::template callback_type<__stop_callback>>;
+
+      _Receiver __receiver_;
+      __on_context_stop_t __on_context_stop_{};
+      __on_receiver_stop_t __on_receiver_stop_{};
+
+      template <class... _Args>
+      explicit __stoppable_op(_Receiver&& __receiver, _Args&&... __args) noexcept
+        : _Base{(_Args&&) __args...}
+        , __receiver_((_Receiver&&) __receiver) {
+      }
+
+      static void __arm(__op_base* __op) noexcept {
+        __stoppable_op* __self = static_cast<__stoppable_op*>(__op);
+        __self->__on_context_stop_.emplace(
+          __self->__context_->get_stop_token(), __stop_callback{__self});
+        __self->__on_receiver_stop_.emplace(
+          stdexec::get_stop_token(stdexec::get_env(__self->__receiver_)), __stop_callback{__self});
+      }
+
+      // Returns true if the receiver has been completed with set_stopped.
+      bool __complete_stopped() noexcept {
+        __on_context_stop_.reset();
+        __on_receiver_stop_.reset();
+        __context& __context = *this->__context_;
+        __context.__n_outstanding_.fetch_sub(1, std::memory_order_relaxed);
+        auto __token = stdexec::get_stop_token(stdexec::get_env(__receiver_));
+        if (this->__is_cancelled_ || __context.stop_requested() || __token.stop_requested()) {
+          stdexec::set_stopped((_Receiver&&) __receiver_);
+          return true;
+        }
+        return false;
+      }
+
+      void __start() noexcept {
+        __context& __context = *this->__context_;
+        __context.__n_outstanding_.fetch_add(1, std::memory_order_relaxed);
+        if (!__context.submit(this)) {
+          __op_base::__execute(this, true);
+        }
+      }
+    };
+
+    template <class _ReceiverId>
+    struct __schedule_after_operation {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t : __stoppable_op<__timer_base, _Receiver> {
+        using __id = __schedule_after_operation;
+
+        static void __complete(__op_base* __op) noexcept {
+          __t* __self = static_cast<__t*>(__op);
+          if (!__self->__complete_stopped()) {
+            stdexec::set_value((_Receiver&&) __self->__receiver_);
+          }
+        }
+
+        static constexpr __op_vtable __vtable{
+          &__timer_base::__wait,
+          &__timer_base::__cancel,
+          &__t::__arm,
+          &__complete};
+
+        __t(
+          __context& __context,
+          std::chrono::steady_clock::time_point __deadline,
+          _Receiver&& __receiver) noexcept
+          : __stoppable_op<__timer_base, _Receiver>(
+            (_Receiver&&) __receiver,
+            __vtable,
+            __context,
+            __deadline) {
+        }
+
+        friend void tag_invoke(stdexec::start_t, __t& __self) noexcept {
+          __self.__start();
+        }
+      };
+    };
+
+    // An io operation that is described by _Op, which provides
+    //   - std::uint32_t events() const noexcept, the epoll events to wait for,
+    //   - ::ssize_t perform(std::uint32_t revents) noexcept, which performs the system call and
+    //     returns its result or the negated errno,
+    //   - result(::ssize_t) noexcept, which computes the value of a successful completion or
+    //     returns void, and
+    //   - optionally ::ssize_t begin() noexcept, which starts the operation before it waits. See
+    //     __io_base.
+    template <class _Op>
+    using __io_result_t =
+      decltype(stdexec::__declval<_Op&>().result(stdexec::__declval<::ssize_t>()));
+
+    template <class _Op>
+    inline constexpr bool __begins_v = requires(_Op& __op) {
+      { __op.begin() } noexcept -> stdexec::same_as<::ssize_t>;
+    };
+
+    template <class _Result>
+    struct __io_value_signature {
+      using __t = stdexec::set_value_t(_Result);
+    };
+
+    template <>
+    struct __io_value_signature<void> {
+      using __t = stdexec::set_value_t();
+    };
+
+    template <class _Op>
+    using __io_completion_signatures = stdexec::completion_signatures<
+      stdexec::__t<__io_value_signature<__io_result_t<_Op>>>,
+      stdexec::set_error_t(std::exception_ptr),
+      stdexec::set_stopped_t()>;
+
+    template <class _Op, class _ReceiverId>
+    struct __io_operation {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t : __stoppable_op<__io_base, _Receiver> {
+        using __id = __io_operation;
+
+        _Op __op_;
+
+        static ::ssize_t __perform(__io_base* __base, std::uint32_t __revents) noexcept {
+          return static_cast<__t*>(__base)->__op_.perform(__revents);
+        }
+
+        static ::ssize_t __begin(__io_base* __base) noexcept {
+          return static_cast<__t*>(__base)->__op_.begin();
+        }
+
+        static constexpr __io_base::__begin_fn* __begin_of() noexcept {
+          if constexpr (__begins_v<_Op>) {
+            return &__begin;
+          } else {
+            return nullptr;
+          }
+        }
+
+        static void __complete(__op_base* __base) noexcept {
+          __t* __self = static_cast<__t*>(__base);
+          if (__self->__complete_stopped()) {
+            return;
+          }
+          const ::ssize_t __result = __self->__result_;
+          if (__result < 0) {
+            stdexec::set_error(
+              (_Receiver&&) __self->__receiver_,
+              std::make_exception_ptr(
+                std::system_error(static_cast<int>(-__result), std::system_category())));
+          } else if constexpr (std::is_void_v<__io_result_t<_Op>>) {
+            __self->__op_.result(__result);
+            stdexec::set_value((_Receiver&&) __self->__receiver_);
+          } else {
+            stdexec::set_value((_Receiver&&) __self->__receiver_, __self->__op_.result(__result));
+          }
+        }
+
+        static constexpr __op_vtable __vtable{
+          &__io_base::__wait,
+          &__io_base::__cancel,
+          &__t::__arm,
+          &__complete};
+
+        __t(__context& __context, const _Op& __op, _Receiver&& __receiver) noexcept
+          : __stoppable_op<__io_base, _Receiver>(
+            (_Receiver&&) __receiver,
+            __vtable,
+            __context,
+            __op.__fd_,
+            __op.events(),
+            &__perform,
+            __begin_of())
+          , __op_{__op} {
+        }
+
+        friend void tag_invoke(stdexec::start_t, __t& __self) noexcept {
+          __self.__start();
+        }
+      };
+    };
+
+    inline ::ssize_t __result_or_errno(::ssize_t __rc) noexcept {
+      return __rc < 0 ? -errno : __rc;
+    }
+
+    struct __read_op {
+      int __fd_;
+      std::span<std::byte> __buffer_;
+      std::int64_t __offset_;
+
+      std::uint32_t events() const noexcept {
+        return EPOLLIN;
+      }
+
+      ::ssize_t perform(std::uint32_t) noexcept {
+        return __result_or_errno(
+          __offset_ < 0 ? ::read(__fd_, __buffer_.data(), __buffer_.size())
+                        : ::pread(__fd_, __buffer_.data(), __buffer_.size(), __offset_));
+      }
+
+      std::size_t result(::ssize_t __n) const noexcept {
+        return static_cast<std::size_t>(__n);
+      }
+    };
+
+    struct __write_op {
+      int __fd_;
+      std::span<const std::byte> __buffer_;
+      std::int64_t __offset_;
+
+      std::uint32_t events() const noexcept {
+        return EPOLLOUT;
+      }
+
+      ::ssize_t perform(std::uint32_t) noexcept {
+        return __result_or_errno(
+          __offset_ < 0 ? ::write(__fd_, __buffer_.data(), __buffer_.size())
+                        : ::pwrite(__fd_, __buffer_.data(), __buffer_.size(), __offset_));
+      }
+
+      std::size_t result(::ssize_t __n) const noexcept {
+        return static_cast<std::size_t>(__n);
+      }
+    };
+
+    struct __writev_op {
+      int __fd_;
+      std::span<const ::iovec> __buffers_;
+      std::int64_t __offset_;
+
+      std::uint32_t events() const noexcept {
+        return EPOLLOUT;
+      }
+
+      ::ssize_t perform(std::uint32_t) noexcept {
+        const int __n = static_cast<int>(__buffers_.size());
+        return __result_or_errno(
+          __offset_ < 0 ? ::writev(__fd_, __buffers_.data(), __n)
+                        : ::pwritev(__fd_, __buffers_.data(), __n, __offset_));
+      }
+
+      std::size_t result(::ssize_t __n) const noexcept {
+        return static_cast<std::size_t>(__n);
+      }
+    };
+
+    struct __poll_op {
+      int __fd_;
+      short __events_;
+
+      std::uint32_t events() const noexcept {
+        return static_cast<std::uint16_t>(__events_);
+      }
+
+      ::ssize_t perform(std::uint32_t __revents) noexcept {
+        return __revents & (events() | EPOLLERR | EPOLLHUP);
+      }
+
+      short result(::ssize_t __revents) const noexcept {
+        return static_cast<short>(__revents);
+      }
+    };
+
+    struct __accept_op {
+      int __fd_;
+      int __flags_;
+
+      std::uint32_t events() const noexcept {
+        return EPOLLIN;
+      }
+
+      ::ssize_t perform(std::uint32_t) noexcept {
+        return __result_or_errno(::accept4(__fd_, nullptr, nullptr, __flags_));
+      }
+
+      int result(::ssize_t __fd) const noexcept {
+        return static_cast<int>(__fd);
+      }
+    };
+
+    // The connection is started before the operation waits. Once the socket is writable, the
+    // result of the connection is read from SO_ERROR.
+    struct __connect_op {
+      int __fd_;
+      const ::sockaddr* __address_;
+      ::socklen_t __address_length_;
+
+      std::uint32_t events() const noexcept {
+        return EPOLLOUT;
+      }
+
+      ::ssize_t begin() noexcept {
+        return __result_or_errno(::connect(__fd_, __address_, __address_length_));
+      }
+
+      ::ssize_t perform(std::uint32_t) noexcept {
+        int __error = 0;
+        ::socklen_t __length = sizeof(__error);
+        if (::getsockopt(__fd_, SOL_SOCKET, SO_ERROR, &__error, &__length) < 0) {
+          return -errno;
+        }
+        return -__error;
+      }
+
+      void result(::ssize_t) const noexcept {
+      }
+    };
+
+    struct __send_op {
+      int __fd_;
+      std::span<const std::byte> __buffer_;
+      int __flags_;
+
+      std::uint32_t events() const noexcept {
+        return EPOLLOUT;
+      }
+
+      ::ssize_t perform(std::uint32_t) noexcept {
+        return __result_or_errno(::send(__fd_, __buffer_.data(), __buffer_.size(), __flags_));
+      }
+
+      std::size_t result(::ssize_t __n) const noexcept {
+        return static_cast<std::size_t>(__n);
+      }
+    };
+
+    struct __recv_op {
+      int __fd_;
+      std::span<std::byte> __buffer_;
+      int __flags_;
+
+      std::uint32_t events() const noexcept {
+        return EPOLLIN;
+      }
+
+      ::ssize_t perform(std::uint32_t) noexcept {
+        return __result_or_errno(::recv(__fd_, __buffer_.data(), __buffer_.size(), __flags_));
+      }
+
+      std::size_t result(::ssize_t __n) const noexcept {
+        return static_cast<std::size_t>(__n);
+      }
+    };
+
+    template <class _Value>
+    struct __read_value_op {
+      int __fd_;
+      _Value __value_{};
+
+      std::uint32_t events() const noexcept {
+        return EPOLLIN;
+      }
+
+      ::ssize_t perform(std::uint32_t) noexcept {
+        return __result_or_errno(::read(__fd_, &__value_, sizeof(_Value)));
+      }
+
+      _Value result(::ssize_t) const noexcept {
+        return __value_;
+      }
+    };
+
+    struct __eventfd_write_op {
+      int __fd_;
+      std::uint64_t __value_;
+
+      std::uint32_t events() const noexcept {
+        return EPOLLOUT;
+      }
+
+      ::ssize_t perform(std::uint32_t) noexcept {
+        return __result_or_errno(::write(__fd_, &__value_, sizeof(__value_)));
+      }
+
+      void result(::ssize_t) const noexcept {
+      }
+    };
+
+    using __wait_signal_op = __read_value_op<::signalfd_siginfo>;
+    using __eventfd_read_op = __read_value_op<std::uint64_t>;
+
+    class __scheduler {
+     public:
+      __context* __context_;
+
+      friend bool operator==(const __scheduler& __lhs, const __scheduler& __rhs) = default;
+
+      class __schedule_env {
+       public:
+        __context* __context_;
+       private:
+        friend __scheduler tag_invoke(
+          stdexec::get_completion_scheduler_t<stdexec::set_value_t>,
+          const __schedule_env& __env) noexcept {
+          return __scheduler{__env.__context_};
+        }
+      };
+
+      class __schedule_sender {
+        __schedule_env __env_;
+       public:
+        using is_sender = void;
+        using __id = __schedule_sender;
+        using __t = __schedule_sender;
+        using completion_signatures =
+          stdexec::completion_signatures<stdexec::set_value_t(), stdexec::set_stopped_t()>;
+
+        explicit __schedule_sender(__schedule_env __env) noexcept
+          : __env_{__env} {
+        }
+
+       private:
+        friend __schedule_env
+          tag_invoke(stdexec::get_env_t, const __schedule_sender& __sender) noexcept {
+          return __sender.__env_;
+        }
+
+        template <stdexec::receiver_of<completion_signatures> _Receiver>
+        friend stdexec::__t<__schedule_operation<stdexec::__id<_Receiver>>> tag_invoke(
+          stdexec::connect_t,
+          const __schedule_sender& __sender,
+          _Receiver&& __receiver) {
+          return {*__sender.__env_.__context_, (_Receiver&&) __receiver};
+        }
+      };
+
+      class __schedule_at_sender {
+       public:
+        using is_sender = void;
+        using __id = __schedule_at_sender;
+        using __t = __schedule_at_sender;
+        using completion_signatures = stdexec::completion_signatures<
+          stdexec::set_value_t(),
+          stdexec::set_error_t(std::exception_ptr),
+          stdexec::set_stopped_t()>;
+
+        __schedule_env __env_;
+        std::chrono::steady_clock::time_point __deadline_;
+
+       private:
+        friend __schedule_env
+          tag_invoke(stdexec::get_env_t, const __schedule_at_sender& __sender) noexcept {
+          return __sender.__env_;
+        }
+
+        template <stdexec::receiver_of<completion_signatures> _Receiver>
+        friend stdexec::__t<__schedule_after_operation<stdexec::__id<_Receiver>>> tag_invoke(
+          stdexec::connect_t,
+          const __schedule_at_sender& __sender,
+          _Receiver&& __receiver) {
+          return {*__sender.__env_.__context_, __sender.__deadline_, (_Receiver&&) __receiver};
+        }
+      };
+
+     private:
+      friend __schedule_sender tag_invoke(stdexec::schedule_t, const __scheduler& __sched) {
+        return __schedule_sender{__schedule_env{__sched.__context_}};
+      }
+
+      friend std::chrono::time_point<std::chrono::steady_clock>
+        tag_invoke(exec::now_t, const __scheduler&) noexcept {
+        return std::chrono::steady_clock::now();
+      }
+
+      friend __schedule_at_sender tag_invoke(
+        exec::schedule_after_t,
+        const __scheduler& __sched,
+        std::chrono::nanoseconds __duration) {
+        return {
+          .__env_ = {__sched.__context_},
+          .__deadline_ = std::chrono::steady_clock::now()
+                       + std::chrono::ceil<std::chrono::steady_clock::duration>(__duration)};
+      }
+
+      template <class _Clock, class _Duration>
+      friend __schedule_at_sender tag_invoke(
+        exec::schedule_at_t,
+        const __scheduler& __sched,
+        const std::chrono::time_point<_Clock, _Duration>& __time_point) {
+        const auto __duration = __time_point - _Clock::now();
+        return {
+          .__env_ = {__sched.__context_},
+          .__deadline_ = std::chrono::steady_clock::now()
+                       + std::chrono::ceil<std::chrono::steady_clock::duration>(__duration)};
+      }
+    };
+
+    inline __scheduler __context::get_scheduler() noexcept {
+      return __scheduler{this};
+    }
+
+    template <class _Op>
+    struct __io_sender {
+      class __t {
+       public:
+        using is_sender = void;
+        using __id = __io_sender;
+        using completion_signatures = __io_completion_signatures<_Op>;
+
+        __t(__context& __context, const _Op& __op) noexcept
+          : __env_{&__context}
+          , __op_{__op} {
+        }
+
+       private:
+        __scheduler::__schedule_env __env_;
+        _Op __op_;
+
+        friend __scheduler::__schedule_env
+          tag_invoke(stdexec::get_env_t, const __t& __sender) noexcept {
+          return __sender.__env_;
+        }
+
+        template <stdexec::receiver_of<completion_signatures> _Receiver>
+        friend stdexec::__t<__io_operation<_Op, stdexec::__id<_Receiver>>>
+          tag_invoke(stdexec::connect_t, const __t& __sender, _Receiver&& __receiver) {
+          return {*__sender.__env_.__context_, __sender.__op_, (_Receiver&&) __receiver};
+        }
+      };
+    };
+
+    template <class _Op>
+    using __io_sender_t = stdexec::__t<__io_sender<_Op>>;
+
+    inline __io_sender_t<__read_op> tag_invoke(
+      exec::async_read_t,
+      const __scheduler& __sched,
+      int __fd,
+      std::span<std::byte> __buffer,
+      std::int64_t __offset = -1) noexcept {
+      return {*__sched.__context_, __read_op{__fd, __buffer, __offset}};
+    }
+
+    inline __io_sender_t<__write_op> tag_invoke(
+      exec::async_write_t,
+      const __scheduler& __sched,
+      int __fd,
+      std::span<const std::byte> __buffer,
+      std::int64_t __offset = -1) noexcept {
+      return {*__sched.__context_, __write_op{__fd, __buffer, __offset}};
+    }
+
+    inline __io_sender_t<__writev_op> tag_invoke(
+      exec::async_writev_t,
+      const __scheduler& __sched,
+      int __fd,
+      std::span<const ::iovec> __buffers,
+      std::int64_t __offset = -1) noexcept {
+      return {*__sched.__context_, __writev_op{__fd, __buffers, __offset}};
+    }
+
+    inline __io_sender_t<__poll_op> tag_invoke(
+      exec::async_poll_t,
+      const __scheduler& __sched,
+      int __fd,
+      short __events) noexcept {
+      return {*__sched.__context_, __poll_op{__fd, __events}};
+    }
+
+    inline __io_sender_t<__accept_op> tag_invoke(
+      exec::async_accept_t,
+      const __scheduler& __sched,
+      int __fd,
+      int __flags = 0) noexcept {
+      return {*__sched.__context_, __accept_op{__fd, __flags}};
+    }
+
+    inline __io_sender_t<__connect_op> tag_invoke(
+      exec::async_connect_t,
+      const __scheduler& __sched,
+      int __fd,
+      const ::sockaddr* __address,
+      ::socklen_t __address_length) noexcept {
+      return {*__sched.__context_, __connect_op{__fd, __address, __address_length}};
+    }
+
+    inline __io_sender_t<__send_op> tag_invoke(
+      exec::async_send_t,
+      const __scheduler& __sched,
+      int __fd,
+      std::span<const std::byte> __buffer,
+      int __flags = 0) noexcept {
+      return {*__sched.__context_, __send_op{__fd, __buffer, __flags}};
+    }
+
+    inline __io_sender_t<__recv_op> tag_invoke(
+      exec::async_recv_t,
+      const __scheduler& __sched,
+      int __fd,
+      std::span<std::byte> __buffer,
+      int __flags = 0) noexcept {
+      return {*__sched.__context_, __recv_op{__fd, __buffer, __flags}};
+    }
+
+    inline __io_sender_t<__wait_signal_op>
+      tag_invoke(exec::async_wait_signal_t, const __scheduler& __sched, int __signal_fd) noexcept {
+      return {*__sched.__context_, __wait_signal_op{__signal_fd}};
+    }
+
+    inline __io_sender_t<__eventfd_read_op>
+      tag_invoke(exec::async_eventfd_read_t, const __scheduler& __sched, int __eventfd) noexcept {
+      return {*__sched.__context_, __eventfd_read_op{__eventfd}};
+    }
+
+    inline __io_sender_t<__eventfd_write_op> tag_invoke(
+      exec::async_eventfd_write_t,
+      const __scheduler& __sched,
+      int __eventfd,
+      std::uint64_t __value = 1) noexcept {
+      return {*__sched.__context_, __eventfd_write_op{__eventfd, __value}};
+    }
+  }
+
+  using epoll_context = __epoll::__context;
+  using epoll_scheduler = __epoll::__scheduler;
+}
@@ -32,6 +32,15 @@
 #include "./memory_mapped_region.hpp"
 
 #include "../scope.hpp"
+#include "./async_io.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <span>
 
 #if !__has_include(<linux/version.h>)
 #error "linux/version.h not found. Do you use Linux?"
@@ -45,12 +54,51 @@
 #define STDEXEC_HAS_IO_URING_ASYNC_CANCELLATION
 #endif
 
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 5, 0)
+#define STDEXEC_HAS_IORING_OP_ACCEPT
+#define STDEXEC_HAS_IORING_OP_CONNECT
+#endif
+
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 6, 0)
 #define STDEXEC_HAS_IORING_OP_READ
+#define STDEXEC_HAS_IORING_OP_SEND
+#define STDEXEC_HAS_IORING_OP_RECV
+#endif
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 6, 0)
+#define STDEXEC_HAS_IORING_OP_OPENAT
+#define STDEXEC_HAS_IORING_OP_STATX
+#define STDEXEC_HAS_IORING_OP_CLOSE
+#define STDEXEC_HAS_IORING_OP_FALLOCATE
+#define STDEXEC_HAS_IORING_OP_FADVISE
+#endif
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 7, 0)
+#define STDEXEC_HAS_IORING_OP_SPLICE
+#endif
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 11, 0)
+#define STDEXEC_HAS_IORING_OP_RENAMEAT
+#endif
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 8, 0)
+#define STDEXEC_HAS_IORING_OP_TEE
+#endif
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 18, 0)
+#define STDEXEC_HAS_IORING_OP_MSG_RING
+#endif
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 0, 0)
+#define STDEXEC_HAS_IORING_OP_SEND_ZC
 #endif
 
+#include <fcntl.h>
 #include <sys/uio.h>
 #include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/syscall.h>
 
 namespace exec {
@@ -61,19 +109,193 @@ namespace exec {
       }
     }
 
+    // The setup parameters of an io_uring_context.
+    //
+    // Any IORING_SETUP_* flag can be passed in `flags`. The remaining members configure the setup
+    // flags that require additional parameters and set the corresponding flag implicitly:
+    //   - `cq_entries` > 0 sets IORING_SETUP_CQSIZE,
+    //   - `sq_thread_cpu` >= 0 sets IORING_SETUP_SQ_AFF (requires IORING_SETUP_SQPOLL),
+    //   - `wq_fd` >= 0 sets IORING_SETUP_ATTACH_WQ.
+    // `sq_thread_idle` is the number of milliseconds the kernel polling thread spins before it
+    // goes to sleep and is only meaningful with IORING_SETUP_SQPOLL.
+    // `busy_poll_us` is the number of microseconds the thread that drives the context spins on
+    // the completion queue before it blocks in the kernel. It is ignored with
+    // IORING_SETUP_DEFER_TASKRUN, which requires entering the kernel to post completions.
+    //
+    // With IORING_SETUP_IOPOLL the context never blocks in the kernel and its driving thread
+    // polls for completions until the context is stopped. Only operations on files that support
+    // polled io, such as files opened with O_DIRECT on NVMe devices, can be used in this mode.
+    // In particular, timers are not available.
+    //
+    // `enable_metrics` makes the context count its submissions, completions and system calls.
+    // The counters can be read with metrics() of the context.
+    struct __params {
+      unsigned entries = 1024;
+      unsigned cq_entries = 0;
+      unsigned flags = 0;
+      unsigned sq_thread_idle = 0;
+      int sq_thread_cpu = -1;
+      int wq_fd = -1;
+      unsigned busy_poll_us = 0;
+      bool enable_metrics = false;
+    };
+
+    // A snapshot of the counters of an io_uring_context. Histograms have power of two buckets:
+    // bucket i counts the values in [2^i, 2^(i+1)) and the last bucket all larger values.
+    // Rates, like system calls per second, are the differences of two snapshots divided by the
+    // difference of their timestamps.
+    struct __metrics {
+      static constexpr std::size_t n_buckets = 16;
+
+      std::chrono::steady_clock::time_point timestamp{};
+      // The number of calls to io_uring_enter.
+      std::uint64_t n_enter_calls = 0;
+      std::uint64_t n_submitted = 0;
+      std::uint64_t n_completed = 0;
+      // The number of times a task could not be submitted because the submission queue was full
+      // or because too many operations were in flight. Such tasks are retried later.
+      std::uint64_t n_sq_full_deferrals = 0;
+      // The number of times the kernel reported an overflow of the completion queue.
+      // The kernel keeps the overflowing completions and posts them once there is space again.
+      std::uint64_t n_cq_overflows = 0;
+      // The number of completions that the kernel had to drop because the completion queue was
+      // full. This is only possible for kernels without IORING_FEAT_NODROP.
+      std::uint64_t n_cq_dropped = 0;
+      std::uint64_t n_in_flight = 0;
+      std::uint64_t max_in_flight = 0;
+      // The number of tasks that one pass submitted to the submission queue.
+      std::array<std::uint64_t, n_buckets> submit_batch_sizes{};
+      // The number of completions that one pass reaped from the completion queue.
+      std::array<std::uint64_t, n_buckets> completions_per_reap{};
+    };
+
+    // The counters behind __metrics. Only the thread that drives the context writes them, other
+    // threads may read them at any time.
+    class __metrics_counters {
+     public:
+      static void add(std::atomic<std::uint64_t>& __counter, std::uint64_t __n) noexcept {
+        __counter.store(__counter.load(std::memory_order_relaxed) + __n, std::memory_order_relaxed);
+      }
+
+      void record(
+        std::array<std::atomic<std::uint64_t>, __metrics::n_buckets>& __histogram,
+        std::uint64_t __value) noexcept {
+        if (__value != 0) {
+          const std::size_t __bucket = std::min<std::size_t>(
+            static_cast<std::size_t>(std::bit_width(__value)) - 1, __metrics::n_buckets - 1);
+          add(__histogram[__bucket], 1);
+        }
+      }
+
+      void set_in_flight(std::uint64_t __n) noexcept {
+        __n_in_flight_.store(__n, std::memory_order_relaxed);
+        if (__n > __max_in_flight_.load(std::memory_order_relaxed)) {
+          __max_in_flight_.store(__n, std::memory_order_relaxed);
+        }
+      }
+
+      __metrics snapshot() const noexcept {
+        __metrics __result{};
+        __result.timestamp = std::chrono::steady_clock::now();
+        __result.n_enter_calls = __n_enter_calls_.load(std::memory_order_relaxed);
+        __result.n_submitted = __n_submitted_.load(std::memory_order_relaxed);
+        __result.n_completed = __n_completed_.load(std::memory_order_relaxed);
+        __result.n_sq_full_deferrals = __n_sq_full_deferrals_.load(std::memory_order_relaxed);
+        __result.n_cq_overflows = __n_cq_overflows_.load(std::memory_order_relaxed);
+        __result.n_cq_dropped = __n_cq_dropped_.load(std::memory_order_relaxed);
+        __result.n_in_flight = __n_in_flight_.load(std::memory_order_relaxed);
+        __result.max_in_flight = __max_in_flight_.load(std::memory_order_relaxed);
+        for (std::size_t __i = 0; __i < __metrics::n_buckets; ++__i) {
+          __result.submit_batch_sizes[__i] = __submit_batch_sizes_[__i].load(
+            std::memory_order_relaxed);
+          __result.completions_per_reap[__i] = __completions_per_reap_[__i].load(
+            std::memory_order_relaxed);
+        }
+        return __result;
+      }
+
+      std::atomic<std::uint64_t> __n_enter_calls_{0};
+      std::atomic<std::uint64_t> __n_submitted_{0};
+      std::atomic<std::uint64_t> __n_completed_{0};
+      std::atomic<std::uint64_t> __n_sq_full_deferrals_{0};
+      std::atomic<std::uint64_t> __n_cq_overflows_{0};
+      std::atomic<std::uint64_t> __n_cq_dropped_{0};
+      std::atomic<std::uint64_t> __n_in_flight_{0};
+      std::atomic<std::uint64_t> __max_in_flight_{0};
+      std::array<std::atomic<std::uint64_t>, __metrics::n_buckets> __submit_batch_sizes_{};
+      std::array<std::atomic<std::uint64_t>, __metrics::n_buckets> __completions_per_reap_{};
+    };
+
+    inline ::io_uring_params __make_io_uring_params(const __params& __params) noexcept {
+      ::io_uring_params __result{};
+      __result.flags = __params.flags;
+      if (__params.cq_entries) {
+        __result.flags |= IORING_SETUP_CQSIZE;
+        __result.cq_entries = __params.cq_entries;
+      }
+      if (__params.sq_thread_cpu >= 0) {
+        __result.flags |= IORING_SETUP_SQ_AFF;
+        __result.sq_thread_cpu = static_cast<__u32>(__params.sq_thread_cpu);
+      }
+      if (__params.wq_fd >= 0) {
+        __result.flags |= IORING_SETUP_ATTACH_WQ;
+        __result.wq_fd = static_cast<__u32>(__params.wq_fd);
+      }
+      __result.sq_thread_idle = __params.sq_thread_idle;
+#ifdef IORING_SETUP_DEFER_TASKRUN
+      // The kernel refuses DEFER_TASKRUN without SINGLE_ISSUER.
+      if (__result.flags & IORING_SETUP_DEFER_TASKRUN) {
+        __result.flags |= IORING_SETUP_SINGLE_ISSUER;
+      }
+#endif
+#ifdef IORING_SETUP_SINGLE_ISSUER
+      // A single issuer ring is owned by the thread that creates it unless it starts disabled.
+      // We enable the ring from the thread that first drives the context instead.
+      if (__result.flags & IORING_SETUP_SINGLE_ISSUER) {
+        __result.flags |= IORING_SETUP_R_DISABLED;
+      }
+#endif
+      return __result;
+    }
+
     inline safe_file_descriptor __io_uring_setup(unsigned __entries, ::io_uring_params& __params) {
       int rc = (int) ::syscall(__NR_io_uring_setup, __entries, &__params);
-      __throw_error_code_if(rc < 0, -rc);
+      __throw_error_code_if(rc < 0, errno);
       return safe_file_descriptor{rc};
     }
 
+    // Returns false if io_uring_setup fails on this system, e.g. because the kernel is too old
+    // or a seccomp profile forbids it. An epoll_context can be used instead in that case.
+    inline bool __is_supported() noexcept {
+      ::io_uring_params __params{};
+      int rc = (int) ::syscall(__NR_io_uring_setup, 1, &__params);
+      if (rc < 0) {
+        return false;
+      }
+      ::close(rc);
+      return true;
+    }
+
+    // The following wrappers return the negated errno on failure, like the kernel does.
     inline int __io_uring_enter(
       int __ring_fd,
       unsigned int __to_submit,
       unsigned int __min_complete,
-      unsigned int __flags) {
-      return (int) ::syscall(
-        __NR_io_uring_enter, __ring_fd, __to_submit, __min_complete, __flags, nullptr, 0);
+      unsigned int __flags,
+      const void* __arg = nullptr,
+      std::size_t __arg_size = 0) {
+      int rc = (int) ::syscall(
+        __NR_io_uring_enter, __ring_fd, __to_submit, __min_complete, __flags, __arg, __arg_size);
+      return rc < 0 ? -errno : rc;
+    }
+
+    inline int __io_uring_register(
+      int __ring_fd,
+      unsigned int __opcode,
+      void* __arg,
+      unsigned int __nr_args) {
+      int rc = (int) ::syscall(__NR_io_uring_register, __ring_fd, __opcode, __arg, __nr_args);
+      return rc < 0 ? -errno : rc;
     }
 
     inline memory_mapped_region __map_region(int __fd, ::off_t __offset, std::size_t __size) {
@@ -85,9 +307,9 @@ namespace exec {
 
     // This base class maps the kernel's io_uring data structures into the process.
     struct __context_base : stdexec::__immovable {
-      explicit __context_base(unsigned __entries, unsigned __flags = 0)
-        : __params_{.flags = __flags}
-        , __ring_fd_{__io_uring_setup(__entries, __params_)}
+      explicit __context_base(const __params& __params)
+        : __params_{__make_io_uring_params(__params)}
+        , __ring_fd_{__io_uring_setup(__params.entries, __params_)}
         , __eventfd_{::eventfd(0, EFD_CLOEXEC)} {
         __throw_error_code_if(!__eventfd_, errno);
         auto __sring_sz = __params_.sq_off.array + __params_.sq_entries * sizeof(unsigned);
@@ -117,6 +339,13 @@ namespace exec {
 
     struct __task;
 
+    // A link is a sequence of tasks whose submission queue entries are submitted consecutively and
+    // that are chained with IOSQE_IO_LINK or IOSQE_IO_HARDLINK.
+    struct __link_view {
+      std::span<__task* const> __tasks_;
+      __u8 __flags_;
+    };
+
     // Each io operation provides the following interface:
     struct __task_vtable {
       // If this function returns true, the __submit_ function will not be called.
@@ -131,6 +360,12 @@ namespace exec {
       // This function is called when the io operation is completed.
       // The status of the operation is passed as a parameter.
       void (*__complete_)(__task*, const ::io_uring_cqe&) noexcept;
+      // This function is optional and only provided by links of tasks.
+      // The tasks of a link are either all submitted in one pass or none of them is submitted.
+      // The __submit_ and __complete_ functions of the tasks of the link are called instead of
+      // the ones of the link itself. The __complete_ function of the link itself is only called
+      // if the link is stopped before it has been submitted.
+      __link_view (*__link_)(__task*) noexcept = nullptr;
     };
 
     // This is the base class for all io operations.
@@ -144,6 +379,19 @@ namespace exec {
       }
     };
 
+    // Completion queue entries with this user data do not belong to any task. They are posted by
+    // other contexts with IORING_OP_MSG_RING to wake up the thread that drives a context.
+    inline constexpr __u64 __message_user_data = 0;
+
+    // Returns true if more completions of the same submission will follow this one.
+    inline bool __has_more([[maybe_unused]] const ::io_uring_cqe& __cqe) noexcept {
+#ifdef IORING_CQE_F_MORE
+      return __cqe.flags & IORING_CQE_F_MORE;
+#else
+      return false;
+#endif
+    }
+
     using __task_queue = stdexec::__intrusive_queue<&__task::__next_>;
     using __atomic_task_queue = __atomic_intrusive_queue<&__task::__next_>;
 
@@ -154,6 +402,7 @@ namespace exec {
 
     struct __submission_result {
       __u32 __n_submitted;
+      __u32 __n_pending;
       __task_queue __pending;
       __task_queue __ready;
     };
@@ -165,10 +414,38 @@ namespace exec {
       __op->__vtable_->__complete_(__op, __cqe);
     }
 
+    // Returns the number of submission queue entries that are needed to submit the given task.
+    inline __u32 __n_entries(__task* __op) noexcept {
+      if (!__op->__vtable_->__link_) {
+        return 1;
+      }
+      __u32 __n = 0;
+      for (__task* __child: __op->__vtable_->__link_(__op).__tasks_) {
+        __n += __n_entries(__child);
+      }
+      return __n;
+    }
+
+    // Stops all tasks of a link that has not been submitted to the io_uring.
+    // We go through the submission of each task such that they are in the same state as if the
+    // io_uring had been stopped while the link has been submitted.
+    inline void __stop_link(__task* __link) noexcept {
+      for (__task* __child: __link->__vtable_->__link_(__link).__tasks_) {
+        if (__child->__vtable_->__link_) {
+          __stop_link(__child);
+        } else {
+          ::io_uring_sqe __sqe{};
+          __child->__vtable_->__submit_(__child, __sqe);
+          __stop(__child);
+        }
+      }
+    }
+
     // This class implements the io_uring submission queue.
     class __submission_queue {
       __atomic_ref<__u32> __head_;
       __atomic_ref<__u32> __tail_;
+      __atomic_ref<__u32> __flags_;
       __u32* __array_;
       ::io_uring_sqe* __entries_;
       __u32 __mask_;
@@ -180,12 +457,43 @@ namespace exec {
         const ::io_uring_params& __params)
         : __head_{*__at_offset_as<__u32*>(__region.data(), __params.sq_off.head)}
         , __tail_{*__at_offset_as<__u32*>(__region.data(), __params.sq_off.tail)}
+        , __flags_{*__at_offset_as<__u32*>(__region.data(), __params.sq_off.flags)}
         , __array_{__at_offset_as<__u32*>(__region.data(), __params.sq_off.array)}
         , __entries_{static_cast<::io_uring_sqe*>(__sqes_region.data())}
         , __mask_{*__at_offset_as<__u32*>(__region.data(), __params.sq_off.ring_mask)}
         , __n_total_slots_{__params.sq_entries} {
       }
 
+      // Returns true if the kernel polling thread of an IORING_SETUP_SQPOLL ring went to sleep and
+      // needs to be woken up by io_uring_enter with IORING_ENTER_SQ_WAKEUP.
+      bool needs_wakeup() const noexcept {
+        // The kernel sets the flag before it re-checks the tail for new entries, so we need a full
+        // barrier between publishing our tail and reading the flag.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return __flags_.load(std::memory_order_relaxed) & IORING_SQ_NEED_WAKEUP;
+      }
+
+      // Returns true if the kernel has deferred task work for us which will only run once we enter
+      // the kernel with IORING_ENTER_GETEVENTS. This requires IORING_SETUP_TASKRUN_FLAG.
+      bool has_task_work() const noexcept {
+#ifdef IORING_SQ_TASKRUN
+        return __flags_.load(std::memory_order_relaxed) & IORING_SQ_TASKRUN;
+#else
+        return false;
+#endif
+      }
+
+      // Returns true if the completion queue overflowed. The kernel keeps the overflowing
+      // completions and flushes them into the completion queue when we enter it with
+      // IORING_ENTER_GETEVENTS.
+      bool has_cq_overflow() const noexcept {
+#ifdef IORING_SQ_CQ_OVERFLOW
+        return __flags_.load(std::memory_order_relaxed) & IORING_SQ_CQ_OVERFLOW;
+#else
+        return false;
+#endif
+      }
+
       // This function submits the given queue of tasks to the io_uring.
       //
       // Each task that is ready to be completed is moved to the __ready queue.
@@ -194,8 +502,13 @@ namespace exec {
       // If is_stopped is true, no new tasks are submitted to the io_uring unless it is a cancellation.
       // If is_stopped is true and a task is not ready to be completed, the task is completed with
       // an io_uring_cqe object with the result field set to -ECANCELED.
-      __submission_result
-        submit(__task_queue __tasks, __u32 __max_submissions, bool __is_stopped) noexcept {
+      // If is_shutdown is true, nothing is in flight anymore and cancellations are completed in
+      // the same way, since there is nothing left for them to cancel.
+      __submission_result submit(
+        __task_queue __tasks,
+        __u32 __max_submissions,
+        bool __is_stopped,
+        bool __is_shutdown = false) noexcept {
         __u32 __tail = __tail_.load(std::memory_order_relaxed);
         __u32 __head = __head_.load(std::memory_order_acquire);
         __u32 __current_count = __tail - __head;
@@ -204,26 +517,20 @@ namespace exec {
         __submission_result __result{};
         __task* __op = nullptr;
         while (!__tasks.empty() && __result.__n_submitted < __max_submissions) {
-          const __u32 __index = __tail & __mask_;
-          ::io_uring_sqe& __sqe = __entries_[__index];
           __op = __tasks.pop_front();
           STDEXEC_ASSERT(__op->__vtable_);
           if (__op->__vtable_->__ready_(__op)) {
             __result.__ready.push_back(__op);
-          } else {
-            __op->__vtable_->__submit_(__op, __sqe);
-#ifdef STDEXEC_HAS_IO_URING_ASYNC_CANCELLATION
-            if (__is_stopped && __sqe.opcode != IORING_OP_ASYNC_CANCEL) {
-#else
-            if (__is_stopped) {
-#endif
-              __stop(__op);
-            } else {
-              __sqe.user_data = bit_cast<__u64>(__op);
-              __array_[__index] = __index;
-              ++__result.__n_submitted;
-              ++__tail;
+          } else if (__op->__vtable_->__link_) {
+            const __u32 __n = __n_entries(__op);
+            STDEXEC_ASSERT(__n <= __n_total_slots_);
+            if (__max_submissions - __result.__n_submitted < __n) {
+              __tasks.push_front(__op);
+              break;
             }
+            __submit_link(__op, 0, __tail, __result, __is_stopped, __is_shutdown);
+          } else {
+            __submit_one(__op, 0, __tail, __result, __is_stopped, __is_shutdown);
           }
         }
         __tail_.store(__tail, std::memory_order_release);
@@ -233,15 +540,65 @@ namespace exec {
             __result.__ready.push_back(__op);
           } else {
             __result.__pending.push_back(__op);
+            ++__result.__n_pending;
           }
         }
         return __result;
       }
+
+     private:
+      void __submit_one(
+        __task* __op,
+        __u8 __link_flags,
+        __u32& __tail,
+        __submission_result& __result,
+        bool __is_stopped,
+        bool __is_shutdown) noexcept {
+        const __u32 __index = __tail & __mask_;
+        ::io_uring_sqe& __sqe = __entries_[__index];
+        __op->__vtable_->__submit_(__op, __sqe);
+#ifdef STDEXEC_HAS_IO_URING_ASYNC_CANCELLATION
+        if (__is_stopped && (__is_shutdown || __sqe.opcode != IORING_OP_ASYNC_CANCEL)) {
+#else
+        if (__is_stopped) {
+#endif
+          __stop(__op);
+        } else {
+          __sqe.flags |= __link_flags;
+          __sqe.user_data = bit_cast<__u64>(__op);
+          __array_[__index] = __index;
+          ++__result.__n_submitted;
+          ++__tail;
+        }
+      }
+
+      // Submits all tasks of a link. Each entry but the last one is linked to its successor by
+      // the flags of the link. The last entry gets the flags of the enclosing link, if any.
+      void __submit_link(
+        __task* __link,
+        __u8 __tail_flags,
+        __u32& __tail,
+        __submission_result& __result,
+        bool __is_stopped,
+        bool __is_shutdown) noexcept {
+        __link_view __view = __link->__vtable_->__link_(__link);
+        const std::size_t __size = __view.__tasks_.size();
+        for (std::size_t __i = 0; __i < __size; ++__i) {
+          __task* __op = __view.__tasks_[__i];
+          const __u8 __flags = __i + 1 < __size ? __view.__flags_ : __tail_flags;
+          if (__op->__vtable_->__link_) {
+            __submit_link(__op, __flags, __tail, __result, __is_stopped, __is_shutdown);
+          } else {
+            __submit_one(__op, __flags, __tail, __result, __is_stopped, __is_shutdown);
+          }
+        }
+      }
     };
 
     class __completion_queue {
       __atomic_ref<__u32> __head_;
       __atomic_ref<__u32> __tail_;
+      __atomic_ref<__u32> __overflow_;
       ::io_uring_cqe* __entries_;
       __u32 __mask_;
      public:
@@ -250,13 +607,25 @@ namespace exec {
         const ::io_uring_params& __params) noexcept
         : __head_{*__at_offset_as<__u32*>(__region.data(), __params.cq_off.head)}
         , __tail_{*__at_offset_as<__u32*>(__region.data(), __params.cq_off.tail)}
+        , __overflow_{*__at_offset_as<__u32*>(__region.data(), __params.cq_off.overflow)}
         , __entries_{__at_offset_as<::io_uring_cqe*>(__region.data(), __params.cq_off.cqes)}
         , __mask_{*__at_offset_as<__u32*>(__region.data(), __params.cq_off.ring_mask)} {
       }
 
+      bool empty() const noexcept {
+        return __head_.load(std::memory_order_relaxed) == __tail_.load(std::memory_order_acquire);
+      }
+
+      // Returns the number of completions that the kernel dropped because this queue was full.
+      __u32 n_dropped() const noexcept {
+        return __overflow_.load(std::memory_order_relaxed);
+      }
+
       // This function first completes all tasks that are ready in the completion queue of the io_uring.
       // Then it completes all tasks that are ready in the given queue of ready tasks.
       // The function returns the number of previously submitted completed tasks.
+      // Wakeup messages from other contexts are consumed but not counted. Neither are completions
+      // with IORING_CQE_F_MORE, since more completions of the same submission will follow.
       int
         complete(stdexec::__intrusive_queue<& __task::__next_> __ready = __task_queue{}) noexcept {
         __u32 __head = __head_.load(std::memory_order_relaxed);
@@ -265,10 +634,12 @@ namespace exec {
         while (__head != __tail) {
           const __u32 __index = __head & __mask_;
           const ::io_uring_cqe& __cqe = __entries_[__index];
-          __task* __op = bit_cast<__task*>(__cqe.user_data);
-          __op->__vtable_->__complete_(__op, __cqe);
+          if (__cqe.user_data != __message_user_data) {
+            __task* __op = bit_cast<__task*>(__cqe.user_data);
+            __op->__vtable_->__complete_(__op, __cqe);
+            __count += !__has_more(__cqe);
+          }
           ++__head;
-          ++__count;
           __tail = __tail_.load(std::memory_order_acquire);
         }
         __head_.store(__head, std::memory_order_release);
@@ -311,10 +682,7 @@ namespace exec {
 #endif
       }
 
-      static void __complete_(__task* __pointer, const ::io_uring_cqe& __entry) noexcept {
-        __wakeup_operation& __self = *static_cast<__wakeup_operation*>(__pointer);
-        __self.start();
-      }
+      static void __complete_(__task* __pointer, const ::io_uring_cqe& __entry) noexcept;
 
       static constexpr __task_vtable __vtable{&__ready_, &__submit_, &__complete_};
 
@@ -327,6 +695,78 @@ namespace exec {
       void start() noexcept;
     };
 
+    inline void __signal_eventfd(int __eventfd) noexcept {
+      std::uint64_t __wakeup = 1;
+      [[maybe_unused]] auto __rc = ::write(__eventfd, &__wakeup, sizeof(__wakeup));
+    }
+
+    // Posts a wakeup message into the completion queue of a context. This operation is submitted
+    // to and completed by the context of the thread that sends the message. It refers to the
+    // receiving context only by duplicates of its file descriptors. If the receiving context is
+    // destroyed while a message is in flight, the operation is detached and deletes itself once it
+    // has been completed. If the message cannot be sent, we fall back to the eventfd.
+    struct __msg_ring_operation : __task {
+      enum __state_t {
+        __idle,
+        __in_use,
+        __detached
+      };
+
+      safe_file_descriptor __ring_fd_;
+      safe_file_descriptor __eventfd_;
+      std::atomic<__state_t> __state_{__idle};
+
+      static bool __ready_(__task*) noexcept {
+        return false;
+      }
+
+      static void __submit_(__task* __pointer, ::io_uring_sqe& __entry) noexcept {
+        __msg_ring_operation& __self = *static_cast<__msg_ring_operation*>(__pointer);
+        __entry = ::io_uring_sqe{};
+#ifdef STDEXEC_HAS_IORING_OP_MSG_RING
+        __entry.opcode = IORING_OP_MSG_RING;
+#endif
+        __entry.fd = __self.__ring_fd_;
+        __entry.off = __message_user_data;
+      }
+
+      static void __complete_(__task* __pointer, const ::io_uring_cqe& __entry) noexcept {
+        __msg_ring_operation& __self = *static_cast<__msg_ring_operation*>(__pointer);
+        if (__entry.res < 0) {
+          __signal_eventfd(__self.__eventfd_);
+        }
+        if (__self.__state_.exchange(__idle, std::memory_order_acq_rel) == __detached) {
+          delete &__self;
+        }
+      }
+
+      static constexpr __task_vtable __vtable{&__ready_, &__submit_, &__complete_};
+
+      __msg_ring_operation(int __ring_fd, int __eventfd)
+        : __task{__vtable}
+        , __ring_fd_{::fcntl(__ring_fd, F_DUPFD_CLOEXEC, 0)}
+        , __eventfd_{::fcntl(__eventfd, F_DUPFD_CLOEXEC, 0)} {
+        __throw_error_code_if(!__ring_fd_ || !__eventfd_, errno);
+      }
+
+      // Returns true if the calling thread may send the next message with this operation.
+      bool __try_acquire() noexcept {
+        __state_t __expected = __idle;
+        return __state_.compare_exchange_strong(
+          __expected, __in_use, std::memory_order_acquire, std::memory_order_relaxed);
+      }
+
+      // Releases the operation from the receiving context. An operation in flight is deleted by the
+      // context that completes it.
+      struct __detach {
+        void operator()(__msg_ring_operation* __op) const noexcept {
+          if (__op->__state_.exchange(__detached, std::memory_order_acq_rel) == __idle) {
+            delete __op;
+          }
+        }
+      };
+    };
+
     class __scheduler;
 
     enum class until {
@@ -337,21 +777,54 @@ namespace exec {
     class __context : __context_base {
      public:
       explicit __context(unsigned __entries = 1024, unsigned __flags = 0)
-        : __context_base(std::max(__entries, 2u), __flags)
+        : __context(__params{.entries = __entries, .flags = __flags}) {
+      }
+
+      explicit __context(const __params& __params)
+        : __context_base(__with_min_entries(__params))
         , __completion_queue_{__completion_queue_region_ ? __completion_queue_region_ : __submission_queue_region_, __params_}
         , __submission_queue_{__submission_queue_region_, __submission_queue_entries_, __params_}
-        , __wakeup_operation_{this, __eventfd_} {
-        __wakeup_operation_.start();
+        , __busy_poll_{__params.busy_poll_us}
+        , __metrics_{__params.enable_metrics ? std::make_unique<__metrics_counters>() : nullptr}
+        , __wakeup_operation_{this, __eventfd_}
+        , __msg_ring_operation_{__make_msg_ring_operation()} {
+        // A polled ring does not support reading from the eventfd. We do not need to wake up its
+        // driving thread because it never blocks.
+        if (!__is_iopoll()) {
+          __wakeup_operation_.start();
+        }
       }
 
+      /// @brief Wakes up the thread that drives this context to take new submissions.
+      ///
+      /// Wakeups are coalesced, i.e. only the first wakeup after the driving thread has taken its
+      /// submissions signals it. If the calling thread drives another context, the signal is posted
+      /// with IORING_OP_MSG_RING into our completion queue instead of writing to the eventfd.
       void wakeup() {
-        std::uint64_t __wakeup = 1;
-        __throw_error_code_if(::write(__eventfd_, &__wakeup, sizeof(__wakeup)) == -1, errno);
+        if (__wakeup_pending_.exchange(true, std::memory_order_acq_rel)) {
+          return;
+        }
+        __context* __sender = __current_context_;
+        if (__sender == this || __is_iopoll()) {
+          // The driving thread takes new submissions before it waits for completions.
+          return;
+        }
+#ifdef STDEXEC_HAS_IORING_OP_MSG_RING
+        // The sending thread submits the message before it leaves its run loop. We put it in front
+        // of its pending tasks such that it is not held back by a full submission queue.
+        if (
+          __sender && !__sender->stop_requested() && __msg_ring_operation_
+          && __msg_ring_operation_->__try_acquire()) {
+          __sender->__pending_.push_front(__msg_ring_operation_.get());
+          return;
+        }
+#endif
+        __signal();
       }
 
       void request_stop() {
         __stop_source_->request_stop();
-        wakeup();
+        __signal();
       }
 
       bool stop_requested() const noexcept {
@@ -366,10 +839,71 @@ namespace exec {
         return __is_running_.load(std::memory_order_relaxed);
       }
 
+      /// @brief Returns the file descriptor of the underlying io_uring.
+      int native_handle() const noexcept {
+        return __ring_fd_;
+      }
+
+      /// @brief Returns a snapshot of the counters of this context. All counters are zero unless
+      /// the context has been created with enable_metrics. This function is thread-safe.
+      __metrics metrics() const noexcept {
+        if (!__metrics_) {
+          __metrics __result{};
+          __result.timestamp = std::chrono::steady_clock::now();
+          return __result;
+        }
+        return __metrics_->snapshot();
+      }
+
+      /// @brief Registers the given buffers with the io_uring. Operations can refer to a
+      /// registered buffer by its index in the given span, which avoids mapping the pages of the
+      /// buffer for each operation. Previously registered buffers have to be unregistered first.
+      void register_buffers(std::span<const ::iovec> __buffers) {
+        int __rc = __io_uring_register(
+          __ring_fd_,
+          IORING_REGISTER_BUFFERS,
+          const_cast<::iovec*>(__buffers.data()),
+          static_cast<unsigned int>(__buffers.size()));
+        __throw_error_code_if(__rc < 0, -__rc);
+      }
+
+      /// @brief Unregisters all buffers that have been registered with register_buffers.
+      void unregister_buffers() {
+        int __rc = __io_uring_register(__ring_fd_, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        __throw_error_code_if(__rc < 0, -__rc);
+      }
+
+      /// @brief Makes every pass over the completion queue a batch of the given target, e.g. a
+      /// static_thread_pool. Tasks that the completions of one pass schedule on the target are
+      /// handed to it at once after the pass, instead of one by one. The target has to outlive
+      /// this context. This must not be called while the context is running.
+      /// Completions must not block on work that they schedule on the target, since that work
+      /// only starts after the pass. See static_thread_pool::begin_batch.
+      template <class _Target>
+        requires requires(_Target& __target) {
+          __target.begin_batch();
+          __target.end_batch();
+        }
+      void batch_completions_for(_Target& __target) noexcept {
+        __batch_target_ = &__target;
+        __begin_batch_ = [](void* __pointer) noexcept {
+          static_cast<_Target*>(__pointer)->begin_batch();
+        };
+        __end_batch_ = [](void* __pointer) noexcept {
+          static_cast<_Target*>(__pointer)->end_batch();
+        };
+      }
+
       /// @brief  Breaks out of the run loop of the io context without stopping the context.
       void finish() {
         __break_loop_.store(true, std::memory_order_release);
-        wakeup();
+        __signal();
+      }
+
+      /// \brief Returns the number of entries of the submission queue of the io_uring. A link of
+      /// tasks is submitted in one pass and therefore cannot have more entries than this.
+      __u32 submission_queue_size() const noexcept {
+        return __params_.sq_entries;
       }
 
       /// \brief Submits the given task to the io_uring.
@@ -401,97 +935,70 @@ namespace exec {
       /// @brief Submit any pending tasks and complete any ready tasks.
       ///
       /// This function is not thread-safe and must only be called from the thread that drives the io context.
-      void run_some() noexcept {
-        __n_total_submitted_ -= __completion_queue_.complete();
-        STDEXEC_ASSERT(
-          0 <= __n_total_submitted_
-          && __n_total_submitted_ <= static_cast<std::ptrdiff_t>(__params_.cq_entries));
+      /// @returns the number of completed tasks
+      std::size_t run_some() noexcept {
+        std::size_t __n_completed = __complete();
+        STDEXEC_ASSERT(__n_total_submitted_ <= static_cast<std::ptrdiff_t>(__params_.cq_entries));
         __u32 __max_submissions = __params_.cq_entries - static_cast<__u32>(__n_total_submitted_);
-        __pending_.append(__requests_.pop_all());
+        __take_requests();
         __submission_result __result = __submission_queue_.submit(
           (__task_queue&&) __pending_, __max_submissions, __stop_source_->stop_requested());
         __n_total_submitted_ += __result.__n_submitted;
         __n_newly_submitted_ += __result.__n_submitted;
         STDEXEC_ASSERT(__n_total_submitted_ <= static_cast<std::ptrdiff_t>(__params_.cq_entries));
+        __record_submission(__result);
         __pending_ = (__task_queue&&) __result.__pending;
         while (!__result.__ready.empty()) {
-          __n_total_submitted_ -= __completion_queue_.complete((__task_queue&&) __result.__ready);
-          STDEXEC_ASSERT(0 <= __n_total_submitted_);
-          __pending_.append(__requests_.pop_all());
+          __n_completed += __complete((__task_queue&&) __result.__ready);
+          __take_requests();
           __max_submissions = __params_.cq_entries - static_cast<__u32>(__n_total_submitted_);
           __result = __submission_queue_.submit(
             (__task_queue&&) __pending_, __max_submissions, __stop_source_->stop_requested());
           __n_total_submitted_ += __result.__n_submitted;
           __n_newly_submitted_ += __result.__n_submitted;
           STDEXEC_ASSERT(__n_total_submitted_ <= static_cast<std::ptrdiff_t>(__params_.cq_entries));
+          __record_submission(__result);
           __pending_ = (__task_queue&&) __result.__pending;
         }
+        return __n_completed;
       }
 
       void run_until_stopped() {
-        bool expected_running = false;
-        // Only one thread of execution is allowed to drive the io context.
-        if (!__is_running_.compare_exchange_strong(
-              expected_running, true, std::memory_order_relaxed)) {
-          throw std::runtime_error("exec::io_uring_context::run() called on a running context");
-        } else {
-          // Check whether we restart the context after a context-wide stop.
-          // We have to reset the stop source in this case.
-          int __in_flight = __n_submissions_in_flight_.load(std::memory_order_relaxed);
-          if (__in_flight == __no_new_submissions) {
-            __stop_source_.emplace();
-            // Make emplacement of stop source visible to other threads and open the door for new submissions.
-            __n_submissions_in_flight_.store(0, std::memory_order_release);
-          }
-        }
-        scope_guard __not_running{[&]() noexcept {
-          __is_running_.store(false, std::memory_order_relaxed);
-        }};
-        __pending_.append(__requests_.pop_all());
-        while (__n_total_submitted_ > 0 || !__pending_.empty()) {
-          run_some();
-          if (
-            __n_total_submitted_ == 0
-            || (__n_total_submitted_ == 1 && __break_loop_.load(std::memory_order_acquire))) {
-            __break_loop_.store(false, std::memory_order_relaxed);
-            break;
-          }
-          constexpr int __min_complete = 1;
-          STDEXEC_ASSERT(
-            0 <= __n_total_submitted_
-            && __n_total_submitted_ <= static_cast<std::ptrdiff_t>(__params_.cq_entries));
-          int rc = __io_uring_enter(
-            __ring_fd_, __n_newly_submitted_, __min_complete, IORING_ENTER_GETEVENTS);
-          __throw_error_code_if(rc < 0, -rc);
-          STDEXEC_ASSERT(rc <= __n_newly_submitted_);
-          __n_newly_submitted_ -= rc;
-          __n_total_submitted_ -= __completion_queue_.complete();
-          STDEXEC_ASSERT(0 <= __n_total_submitted_);
-          __pending_.append(__requests_.pop_all());
-        }
-        STDEXEC_ASSERT(__n_total_submitted_ <= 1);
-        if (__stop_source_->stop_requested() && __pending_.empty()) {
-          STDEXEC_ASSERT(__n_total_submitted_ == 0);
-          // try to shutdown the request queue
-          int __n_in_flight_expected = 0;
-          while (!__n_submissions_in_flight_.compare_exchange_weak(
-            __n_in_flight_expected, __no_new_submissions, std::memory_order_relaxed)) {
-            if (__n_in_flight_expected == __no_new_submissions) {
-              break;
-            }
-            __n_in_flight_expected = 0;
-          }
-          STDEXEC_ASSERT(
-            __n_submissions_in_flight_.load(std::memory_order_relaxed) == __no_new_submissions);
-          // There could have been requests in flight. Complete all of them
-          // and then stop it, finally.
-          __pending_.append(__requests_.pop_all());
-          __submission_result __result = __submission_queue_.submit(
-            (__task_queue&&) __pending_, __params_.cq_entries, true);
-          STDEXEC_ASSERT(__result.__n_submitted == 0);
-          STDEXEC_ASSERT(__result.__pending.empty());
-          __completion_queue_.complete((__task_queue&&) __result.__ready);
-        }
+        __run(false, nullptr);
+      }
+
+      /// @brief Submits pending tasks and completes all tasks whose completions are available
+      /// without blocking the calling thread.
+      /// @returns the number of completed tasks
+      std::size_t poll() {
+        const auto __now = std::chrono::steady_clock::now();
+        return __run(false, &__now);
+      }
+
+      /// @brief Blocks the calling thread until at least one task has been completed, the
+      /// context has been stopped or the run loop has been left with finish().
+      /// @returns the number of completed tasks
+      std::size_t run_one() {
+        return __run(true, nullptr);
+      }
+
+      /// @brief Drives the context on the calling thread until the given duration has elapsed,
+      /// the context has been stopped or the run loop has been left with finish().
+      /// @returns the number of completed tasks
+      template <class _Rep, class _Period>
+      std::size_t run_for(const std::chrono::duration<_Rep, _Period>& __duration) {
+        return run_until(std::chrono::steady_clock::now() + __duration);
+      }
+
+      /// @brief Drives the context on the calling thread until the given time point has been
+      /// reached, the context has been stopped or the run loop has been left with finish().
+      /// @returns the number of completed tasks
+      template <class _Clock, class _Duration>
+      std::size_t run_until(const std::chrono::time_point<_Clock, _Duration>& __time_point) {
+        const auto __deadline = std::chrono::steady_clock::now()
+                              + std::chrono::ceil<std::chrono::steady_clock::duration>(
+                                  __time_point - _Clock::now());
+        return __run(false, &__deadline);
       }
 
       struct __on_stop {
@@ -578,60 +1085,451 @@ namespace exec {
      private:
       friend struct __wakeup_operation;
 
-      // This constant is used for __n_submissions_in_flight to indicate that no new submissions
-      // to this context will be completed by this context.
-      static constexpr int __no_new_submissions = -1;
-
-      std::atomic<bool> __is_running_{false};
-      std::atomic<int> __n_submissions_in_flight_{0};
-      std::atomic<bool> __break_loop_{false};
-      std::ptrdiff_t __n_total_submitted_{0};
-      std::ptrdiff_t __n_newly_submitted_{0};
-      std::optional<stdexec::in_place_stop_source> __stop_source_{std::in_place};
-      __completion_queue __completion_queue_;
-      __submission_queue __submission_queue_;
-      __task_queue __pending_{};
-      __atomic_task_queue __requests_{};
-      __wakeup_operation __wakeup_operation_;
-    };
+      using __msg_ring_operation_ptr =
+        std::unique_ptr<__msg_ring_operation, __msg_ring_operation::__detach>;
 
-    inline void __wakeup_operation::start() noexcept {
-      if (!__context_->__stop_source_->stop_requested()) {
-        __context_->__pending_.push_front(this);
+      // A polled context is never woken up, so it does not need to receive messages.
+      __msg_ring_operation_ptr __make_msg_ring_operation() {
+#ifdef STDEXEC_HAS_IORING_OP_MSG_RING
+        if (!__is_iopoll()) {
+          return __msg_ring_operation_ptr{new __msg_ring_operation{__ring_fd_, __eventfd_}};
+        }
+#endif
+        return nullptr;
       }
-    }
 
-    template <class _Op>
-    concept __io_task = //
-      requires(_Op& __op, ::io_uring_sqe& __sqe, const ::io_uring_cqe& __cqe) {
-        { __op.context() } noexcept -> std::convertible_to<__context&>;
-        { __op.ready() } noexcept -> std::convertible_to<bool>;
-        { __op.submit(__sqe) } noexcept;
-        { __op.complete(__cqe) } noexcept;
-      };
+      static __params __with_min_entries(__params __params) noexcept {
+        __params.entries = std::max(__params.entries, 2u);
+        return __params;
+      }
 
-    template <class _Op>
-    concept __stoppable_task = //
-      __io_task<_Op> &&        //
-      requires(_Op& __op) {
-        {
-          ((_Op&&) __op).receiver()
-        } noexcept
-          -> stdexec::receiver_of< stdexec::completion_signatures<stdexec::set_stopped_t()>>;
-      };
+      // Marks this context as driven by the calling thread for the lifetime of this object.
+      class __run_guard {
+        __context& __context_;
+        __context* __previous_context_;
 
-    template <__stoppable_task _Op>
-    using __receiver_of_t = stdexec::__decay_t<decltype(std::declval<_Op&>().receiver())>;
+       public:
+        explicit __run_guard(__context& __context)
+          : __context_{__context} {
+          bool __expected_running = false;
+          // Only one thread of execution is allowed to drive the io context.
+          if (!__context_.__is_running_.compare_exchange_strong(
+                __expected_running, true, std::memory_order_relaxed)) {
+            throw std::runtime_error("exec::io_uring_context::run() called on a running context");
+          }
+          // Check whether we restart the context after a context-wide stop.
+          // We have to reset the stop source in this case.
+          int __in_flight = __context_.__n_submissions_in_flight_.load(std::memory_order_relaxed);
+          if (__in_flight == __no_new_submissions) {
+            __context_.__stop_source_.emplace();
+            // Make emplacement of stop source visible to other threads and open the door for new
+            // submissions.
+            __context_.__n_submissions_in_flight_.store(0, std::memory_order_release);
+          }
+          __previous_context_ = std::exchange(__current_context_, &__context_);
+        }
 
-    template <__io_task _Base>
-    struct __io_task_facade : __task {
-      static bool __ready_(__task* __pointer) noexcept {
-        __io_task_facade* __self = static_cast<__io_task_facade*>(__pointer);
-        return __self->__base_.ready();
-      }
+        ~__run_guard() {
+          __current_context_ = __previous_context_;
+          __context_.__is_running_.store(false, std::memory_order_relaxed);
+        }
+      };
 
-      static void __submit_(__task* __pointer, ::io_uring_sqe& __sqe) noexcept {
-        __io_task_facade* __self = static_cast<__io_task_facade*>(__pointer);
+      // Drives the io_uring until the context is stopped or the loop is left with finish().
+      // If __until_one is true, we return as soon as at least one task has been completed.
+      // If a deadline is given, we do not block beyond it.
+      // Returns the number of completed tasks.
+      std::size_t __run(bool __until_one, const std::chrono::steady_clock::time_point* __deadline) {
+        __run_guard __guard{*this};
+        __enable_ring();
+        std::size_t __n_completed = 0;
+        __take_requests();
+        // The wakeup operation is always in flight, unless the context has been stopped or is
+        // polled. A polled context keeps running until it is stopped.
+        const std::ptrdiff_t __n_idle = __is_iopoll() ? 0 : 1;
+        while (__n_total_submitted_ > 0 || !__pending_.empty() || __keeps_polling()) {
+          __n_completed += run_some();
+          if (
+            (__n_total_submitted_ == 0 && !__keeps_polling())
+            || (
+              __n_total_submitted_ == __n_idle
+              && __break_loop_.load(std::memory_order_acquire))) {
+            __break_loop_.store(false, std::memory_order_relaxed);
+            break;
+          }
+          STDEXEC_ASSERT(
+            0 <= __n_total_submitted_
+            && __n_total_submitted_ <= static_cast<std::ptrdiff_t>(__params_.cq_entries));
+          // If we are done, we still enter the kernel once to submit our new entries and to reap
+          // the completions that are already available.
+          std::chrono::nanoseconds __timeout{};
+          bool __is_done = __until_one && __n_completed > 0;
+          if (!__is_done && __deadline) {
+            __timeout = std::max<std::chrono::nanoseconds>(
+              *__deadline - std::chrono::steady_clock::now(), __timeout);
+            __is_done = __timeout == std::chrono::nanoseconds::zero();
+          }
+          __submit_and_wait(__is_done || __deadline ? &__timeout : nullptr);
+          __n_completed += __complete();
+          __take_requests();
+          if (__is_done) {
+            break;
+          }
+        }
+        // Our pending tasks may include wakeup messages for other contexts, which must not wait
+        // until we are driven again.
+        if (!__pending_.empty()) {
+          __n_completed += run_some();
+          __submit();
+        }
+        if (__stop_source_->stop_requested() && __pending_.empty() && __n_total_submitted_ == 0) {
+          __shutdown();
+        }
+        return __n_completed;
+      }
+
+      // Closes the door for new submissions and completes all requests that are still in flight.
+      void __shutdown() noexcept {
+        // try to shutdown the request queue
+        int __n_in_flight_expected = 0;
+        while (!__n_submissions_in_flight_.compare_exchange_weak(
+          __n_in_flight_expected, __no_new_submissions, std::memory_order_relaxed)) {
+          if (__n_in_flight_expected == __no_new_submissions) {
+            break;
+          }
+          __n_in_flight_expected = 0;
+        }
+        STDEXEC_ASSERT(
+          __n_submissions_in_flight_.load(std::memory_order_relaxed) == __no_new_submissions);
+        // There could have been requests in flight. Complete all of them
+        // and then stop it, finally. This includes cancellations of tasks that have been stopped
+        // before their submission.
+        __take_requests();
+        __submission_result __result = __submission_queue_.submit(
+          (__task_queue&&) __pending_, __params_.cq_entries, true, true);
+        STDEXEC_ASSERT(__result.__n_submitted == 0);
+        STDEXEC_ASSERT(__result.__pending.empty());
+        __completion_queue_.complete((__task_queue&&) __result.__ready);
+      }
+
+      // Completes all available completions and the given ready tasks.
+      // Returns the number of completed tasks without the completions of our wakeup operation.
+      std::size_t __complete(__task_queue __ready = __task_queue{}) noexcept {
+        std::size_t __n_ready = 0;
+        __task_queue __ready_tasks{};
+        while (!__ready.empty()) {
+          __ready_tasks.push_back(__ready.pop_front());
+          ++__n_ready;
+        }
+        const std::size_t __n_wakeups = __n_wakeups_;
+        if (__batch_target_) {
+          __begin_batch_(__batch_target_);
+        }
+        const int __n = __completion_queue_.complete((__task_queue&&) __ready_tasks);
+        if (__batch_target_) {
+          __end_batch_(__batch_target_);
+        }
+        __n_total_submitted_ -= __n;
+        STDEXEC_ASSERT(0 <= __n_total_submitted_);
+        if (__metrics_) {
+          __metrics_counters::add(__metrics_->__n_completed_, static_cast<std::uint64_t>(__n));
+          __metrics_->record(__metrics_->__completions_per_reap_, static_cast<std::uint64_t>(__n));
+          __metrics_->set_in_flight(static_cast<std::uint64_t>(__n_total_submitted_));
+          __metrics_->__n_cq_dropped_.store(
+            __completion_queue_.n_dropped(), std::memory_order_relaxed);
+        }
+        return static_cast<std::size_t>(__n) + __n_ready - (__n_wakeups_ - __n_wakeups);
+      }
+
+      void __record_submission(const __submission_result& __result) noexcept {
+        if (__metrics_) {
+          __metrics_counters::add(__metrics_->__n_submitted_, __result.__n_submitted);
+          __metrics_counters::add(__metrics_->__n_sq_full_deferrals_, __result.__n_pending);
+          __metrics_->record(__metrics_->__submit_batch_sizes_, __result.__n_submitted);
+          __metrics_->set_in_flight(static_cast<std::uint64_t>(__n_total_submitted_));
+        }
+      }
+
+      // Unconditionally signals the eventfd. This completes the wakeup operation, which is needed
+      // to leave the run loop.
+      void __signal() {
+        std::uint64_t __wakeup = 1;
+        __throw_error_code_if(::write(__eventfd_, &__wakeup, sizeof(__wakeup)) == -1, errno);
+      }
+
+      // Takes all requests that have been submitted by other threads. We reset the wakeup flag
+      // first such that every submission that skipped its wakeup is visible to this thread.
+      void __take_requests() noexcept {
+        if (__wakeup_pending_.load(std::memory_order_relaxed)) {
+          __wakeup_pending_.exchange(false, std::memory_order_acq_rel);
+        }
+        __pending_.append(__requests_.pop_all());
+      }
+
+#ifdef IORING_FEAT_EXT_ARG
+      bool __has_ext_arg() const noexcept {
+        return __params_.features & IORING_FEAT_EXT_ARG;
+      }
+#endif
+
+      bool __is_sqpoll() const noexcept {
+        return __params_.flags & IORING_SETUP_SQPOLL;
+      }
+
+      bool __is_iopoll() const noexcept {
+        return __params_.flags & IORING_SETUP_IOPOLL;
+      }
+
+      bool __keeps_polling() const noexcept {
+        return __is_iopoll() && !__stop_source_->stop_requested();
+      }
+
+      bool __is_defer_taskrun() const noexcept {
+#ifdef IORING_SETUP_DEFER_TASKRUN
+        return __params_.flags & IORING_SETUP_DEFER_TASKRUN;
+#else
+        return false;
+#endif
+      }
+
+      // Spins on the completion queue for at most the given duration.
+      // Returns true if there are completions or new requests to process.
+      bool __busy_poll(std::chrono::nanoseconds __budget) const noexcept {
+        const auto __deadline = std::chrono::steady_clock::now() + __budget;
+        while (true) {
+          for (int __i = 0; __i < 64; ++__i) {
+            if (!__completion_queue_.empty() || __wakeup_pending_.load(std::memory_order_relaxed)) {
+              return true;
+            }
+            if (__submission_queue_.has_task_work()) {
+              return false;
+            }
+          }
+          if (std::chrono::steady_clock::now() >= __deadline) {
+            return false;
+          }
+        }
+      }
+
+      // A ring that has been set up with IORING_SETUP_R_DISABLED is enabled by the first thread
+      // that drives it. For IORING_SETUP_SINGLE_ISSUER rings this thread becomes the only thread
+      // that is allowed to drive this context.
+      void __enable_ring() {
+#ifdef IORING_SETUP_R_DISABLED
+        if (__params_.flags & IORING_SETUP_R_DISABLED) {
+          int __rc = __io_uring_register(__ring_fd_, IORING_REGISTER_ENABLE_RINGS, nullptr, 0);
+          __throw_error_code_if(__rc < 0, -__rc);
+          __params_.flags &= ~IORING_SETUP_R_DISABLED;
+        }
+#endif
+      }
+
+      // Enters the kernel to submit new submission queue entries and to wait for at least one
+      // completion.
+      //
+      // We do not wait if there are already completions to process. With IORING_SETUP_SQPOLL the
+      // kernel thread picks up new entries by itself and we only enter the kernel if we need to
+      // wake it up or to wait for completions. With IORING_SETUP_DEFER_TASKRUN or
+      // IORING_SETUP_TASKRUN_FLAG completions are only posted after we ask for them with
+      // IORING_ENTER_GETEVENTS.
+      //
+      // If a timeout is given, we wait at most that long. A zero timeout never blocks. Kernels
+      // without IORING_FEAT_EXT_ARG cannot wait with a timeout and we do not block at all.
+      //
+      // If busy polling is enabled, we submit new entries first and spin on the completion queue
+      // before we block.
+      void __submit_and_wait(const std::chrono::nanoseconds* __timeout = nullptr) {
+        unsigned __to_submit = static_cast<unsigned>(__n_newly_submitted_);
+        unsigned __flags = IORING_ENTER_GETEVENTS;
+        unsigned __min_complete = 1;
+        if (__is_sqpoll()) {
+          __to_submit = 0;
+          __n_newly_submitted_ = 0;
+          if (__submission_queue_.needs_wakeup()) {
+            __flags |= IORING_ENTER_SQ_WAKEUP;
+          }
+        }
+        const bool __has_cq_overflow = __submission_queue_.has_cq_overflow();
+        if (__metrics_ && __has_cq_overflow && !__had_cq_overflow_) {
+          __metrics_counters::add(__metrics_->__n_cq_overflows_, 1);
+        }
+        __had_cq_overflow_ = __has_cq_overflow;
+        if (!__completion_queue_.empty()) {
+          __min_complete = 0;
+          // Overflowing completions are only flushed into the completion queue by the kernel.
+          if (!__submission_queue_.has_task_work() && !__has_cq_overflow) {
+            __flags &= ~IORING_ENTER_GETEVENTS;
+          }
+        }
+        if (__is_iopoll()) {
+          // Completions of polled io are reaped by entering the kernel. We never block such that
+          // new requests are taken without delay.
+          __min_complete = 0;
+          if (
+            __to_submit == 0 && __n_total_submitted_ == 0
+            && !(__flags & IORING_ENTER_SQ_WAKEUP)) {
+            return;
+          }
+        }
+        std::chrono::nanoseconds __remaining = __timeout ? *__timeout
+                                                         : std::chrono::nanoseconds::max();
+        if (
+          __min_complete != 0 && __busy_poll_.count() > 0 && __remaining.count() > 0
+          && !__is_defer_taskrun()) {
+          if (__to_submit != 0 || (__flags & IORING_ENTER_SQ_WAKEUP)) {
+            __enter(__to_submit, 0, __flags & ~IORING_ENTER_GETEVENTS);
+            __to_submit = 0;
+            __flags &= ~IORING_ENTER_SQ_WAKEUP;
+          }
+          const auto __start = std::chrono::steady_clock::now();
+          if (__busy_poll(std::min<std::chrono::nanoseconds>(__busy_poll_, __remaining))) {
+            return;
+          }
+          if (__timeout) {
+            __remaining = std::max<std::chrono::nanoseconds>(
+              __remaining - (std::chrono::steady_clock::now() - __start),
+              std::chrono::nanoseconds::zero());
+          }
+        }
+        if (__timeout && __min_complete != 0) {
+          __min_complete = 0;
+#ifdef IORING_ENTER_EXT_ARG
+          if (__remaining.count() > 0 && __has_ext_arg()) {
+            __enter(__to_submit, 1, __flags, &__remaining);
+            return;
+          }
+#endif
+        }
+        if (__to_submit == 0 && __flags == 0) {
+          return;
+        }
+        __enter(__to_submit, __min_complete, __flags);
+      }
+
+      // Enters the kernel to submit new submission queue entries without waiting for completions.
+      void __submit() {
+        unsigned __to_submit = static_cast<unsigned>(__n_newly_submitted_);
+        unsigned __flags = 0;
+        if (__is_sqpoll()) {
+          __to_submit = 0;
+          __n_newly_submitted_ = 0;
+          if (__submission_queue_.needs_wakeup()) {
+            __flags |= IORING_ENTER_SQ_WAKEUP;
+          }
+        }
+        if (__to_submit != 0 || __flags != 0) {
+          __enter(__to_submit, 0, __flags);
+        }
+      }
+
+      void __enter(
+        unsigned __to_submit,
+        unsigned __min_complete,
+        unsigned __flags,
+        [[maybe_unused]] const std::chrono::nanoseconds* __timeout = nullptr) {
+        int rc = 0;
+#ifdef IORING_ENTER_EXT_ARG
+        if (__timeout) {
+          ::__kernel_timespec __ts{};
+          __ts.tv_sec = __timeout->count() / 1'000'000'000;
+          __ts.tv_nsec = __timeout->count() % 1'000'000'000;
+          ::io_uring_getevents_arg __arg{};
+          __arg.ts = bit_cast<__u64>(&__ts);
+          rc = __io_uring_enter(
+            __ring_fd_,
+            __to_submit,
+            __min_complete,
+            __flags | IORING_ENTER_EXT_ARG,
+            &__arg,
+            sizeof(__arg));
+        } else
+#endif
+        {
+          rc = __io_uring_enter(__ring_fd_, __to_submit, __min_complete, __flags);
+        }
+        if (__metrics_) {
+          __metrics_counters::add(__metrics_->__n_enter_calls_, 1);
+        }
+        if (rc == -ETIME) {
+          rc = 0;
+        }
+        __throw_error_code_if(rc < 0, -rc);
+        STDEXEC_ASSERT(rc <= __n_newly_submitted_);
+        __n_newly_submitted_ -= rc;
+      }
+
+      // This constant is used for __n_submissions_in_flight to indicate that no new submissions
+      // to this context will be completed by this context.
+      static constexpr int __no_new_submissions = -1;
+
+      std::atomic<bool> __is_running_{false};
+      std::atomic<int> __n_submissions_in_flight_{0};
+      std::atomic<bool> __break_loop_{false};
+      std::atomic<bool> __wakeup_pending_{false};
+      std::ptrdiff_t __n_total_submitted_{0};
+      std::ptrdiff_t __n_newly_submitted_{0};
+      std::size_t __n_wakeups_{0};
+      void* __batch_target_{nullptr};
+      void (*__begin_batch_)(void*) noexcept {nullptr};
+      void (*__end_batch_)(void*) noexcept {nullptr};
+      std::optional<stdexec::in_place_stop_source> __stop_source_{std::in_place};
+      __completion_queue __completion_queue_;
+      __submission_queue __submission_queue_;
+      std::chrono::microseconds __busy_poll_;
+      std::unique_ptr<__metrics_counters> __metrics_;
+      bool __had_cq_overflow_{false};
+      __task_queue __pending_{};
+      __atomic_task_queue __requests_{};
+      __wakeup_operation __wakeup_operation_;
+      __msg_ring_operation_ptr __msg_ring_operation_;
+
+      static inline thread_local __context* __current_context_ = nullptr;
+    };
+
+    inline void
+      __wakeup_operation::__complete_(__task* __pointer, const ::io_uring_cqe& __entry) noexcept {
+      __wakeup_operation& __self = *static_cast<__wakeup_operation*>(__pointer);
+      ++__self.__context_->__n_wakeups_;
+      __self.start();
+    }
+
+    inline void __wakeup_operation::start() noexcept {
+      if (!__context_->__stop_source_->stop_requested()) {
+        __context_->__pending_.push_front(this);
+      }
+    }
+
+    template <class _Op>
+    concept __io_task = //
+      requires(_Op& __op, ::io_uring_sqe& __sqe, const ::io_uring_cqe& __cqe) {
+        { __op.context() } noexcept -> std::convertible_to<__context&>;
+        { __op.ready() } noexcept -> std::convertible_to<bool>;
+        { __op.submit(__sqe) } noexcept;
+        { __op.complete(__cqe) } noexcept;
+      };
+
+    template <class _Op>
+    concept __stoppable_task = //
+      __io_task<_Op> &&        //
+      requires(_Op& __op) {
+        {
+          ((_Op&&) __op).receiver()
+        } noexcept
+          -> stdexec::receiver_of< stdexec::completion_signatures<stdexec::set_stopped_t()>>;
+      };
+
+    template <__stoppable_task _Op>
+    using __receiver_of_t = stdexec::__decay_t<decltype(std::declval<_Op&>().receiver())>;
+
+    template <__io_task _Base>
+    struct __io_task_facade : __task {
+      static bool __ready_(__task* __pointer) noexcept {
+        __io_task_facade* __self = static_cast<__io_task_facade*>(__pointer);
+        return __self->__base_.ready();
+      }
+
+      static void __submit_(__task* __pointer, ::io_uring_sqe& __sqe) noexcept {
+        __io_task_facade* __self = static_cast<__io_task_facade*>(__pointer);
         __self->__base_.submit(__sqe);
       }
 
@@ -662,6 +1560,10 @@ namespace exec {
         return __base_;
       }
 
+      __context& context() noexcept {
+        return __base_.context();
+      }
+
      private:
       _Base __base_;
 
@@ -810,6 +1712,11 @@ namespace exec {
         __base.submit_stop(__sqe);
       };
 
+      template <class _Ty>
+      static constexpr bool __has_more_v = requires(_Ty& __base, const ::io_uring_cqe& __cqe) {
+        __base.more(__cqe);
+      };
+
       using __base_t = __impl_base<_Base, __has_submit_stop_v<_Base>>;
 
       struct __impl : __base_t {
@@ -866,7 +1773,18 @@ namespace exec {
         }
 
         void complete(const ::io_uring_cqe& __cqe) noexcept {
-          if (__n_ops_.fetch_sub(1, std::memory_order_relaxed) == 1) {
+          if (__has_more(__cqe)) {
+            // The submission is still in flight.
+            if constexpr (__has_more_v<_Base>) {
+              this->__base_.more(__cqe);
+            }
+            return;
+          }
+          // A task that has never been submitted completes right away. This happens if it was
+          // ready or if the context has been stopped before the submission.
+          if (
+            __n_ops_.load(std::memory_order_relaxed) == 0
+            || __n_ops_.fetch_sub(1, std::memory_order_relaxed) == 1) {
             __on_context_stop_.reset();
             __on_receiver_stop_.reset();
             _Receiver& __receiver = this->__base_.receiver();
@@ -1016,6 +1934,597 @@ namespace exec {
       using __t = __stoppable_task_facade_t<__impl>;
     };
 
+    // An io operation that is described by a single submission queue entry.
+    //
+    // _Op is a description of the operation that provides
+    //   - void prepare(::io_uring_sqe&) noexcept, which fills a zero-initialized entry, and
+    //   - result(const ::io_uring_cqe&) noexcept, which computes the value of a successful
+    //     completion or returns void.
+    // A completion with a negative result is reported as std::system_error.
+    //
+    // If an operation completes more than once, such as a zero-copy send, the first completion
+    // carries the result and the last one signals that the operation released its resources.
+    template <class _Op>
+    using __io_result_t = decltype(stdexec::__declval<_Op&>().result(
+      stdexec::__declval<const ::io_uring_cqe&>()));
+
+    template <class _Op>
+    inline constexpr bool __validates_v = requires(const _Op& __op) {
+      { __op.validate() } noexcept -> std::same_as<int>;
+    };
+
+    template <class _Result>
+    struct __io_value_signature {
+      using __t = stdexec::set_value_t(_Result);
+    };
+
+    template <>
+    struct __io_value_signature<void> {
+      using __t = stdexec::set_value_t();
+    };
+
+    template <class _Op>
+    using __io_completion_signatures = stdexec::completion_signatures<
+      stdexec::__t<__io_value_signature<__io_result_t<_Op>>>,
+      stdexec::set_error_t(std::exception_ptr),
+      stdexec::set_stopped_t()>;
+
+    template <class _Op, class _ReceiverId>
+    struct __io_operation {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      class __impl : public __stoppable_op_base<_Receiver> {
+        _Op __op_;
+        std::optional<int> __result_{};
+
+       public:
+        __impl(__context& __context, const _Op& __op, _Receiver&& __receiver)
+          : __stoppable_op_base<_Receiver>{__context, (_Receiver&&) __receiver}
+          , __op_{__op} {
+          if constexpr (__validates_v<_Op>) {
+            if (int __rc = __op_.validate(); __rc < 0) {
+              __result_ = __rc;
+            }
+          }
+        }
+
+        // An operation that fails its validation completes without being submitted.
+        bool ready() const noexcept {
+          return __result_.has_value();
+        }
+
+        void submit(::io_uring_sqe& __sqe) noexcept {
+          __sqe = ::io_uring_sqe{};
+          __op_.prepare(__sqe);
+        }
+
+        void more(const ::io_uring_cqe& __cqe) noexcept {
+          if (!__result_) {
+            __result_ = __cqe.res;
+          }
+        }
+
+        void complete(const ::io_uring_cqe& __last_cqe) noexcept {
+          ::io_uring_cqe __cqe = __last_cqe;
+          if (__result_) {
+            __cqe.res = *__result_;
+          }
+          if (__cqe.res < 0) {
+            stdexec::set_error(
+              (_Receiver&&) this->__receiver_,
+              std::make_exception_ptr(std::system_error(-__cqe.res, std::system_category())));
+          } else if constexpr (std::is_void_v<__io_result_t<_Op>>) {
+            __op_.result(__cqe);
+            stdexec::set_value((_Receiver&&) this->__receiver_);
+          } else {
+            stdexec::set_value((_Receiver&&) this->__receiver_, __op_.result(__cqe));
+          }
+        }
+      };
+
+      using __t = __stoppable_task_facade_t<__impl>;
+    };
+
+    struct __read_op {
+      int __fd_;
+      std::span<std::byte> __buffer_;
+      std::int64_t __offset_;
+#ifndef STDEXEC_HAS_IORING_OP_READ
+      ::iovec __iov_{};
+#endif
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.fd = __fd_;
+        __sqe.off = static_cast<__u64>(__offset_);
+#ifdef STDEXEC_HAS_IORING_OP_READ
+        __sqe.opcode = IORING_OP_READ;
+        __sqe.addr = bit_cast<__u64>(__buffer_.data());
+        __sqe.len = static_cast<__u32>(__buffer_.size());
+#else
+        __iov_ = ::iovec{.iov_base = __buffer_.data(), .iov_len = __buffer_.size()};
+        __sqe.opcode = IORING_OP_READV;
+        __sqe.addr = bit_cast<__u64>(&__iov_);
+        __sqe.len = 1;
+#endif
+      }
+
+      std::size_t result(const ::io_uring_cqe& __cqe) const noexcept {
+        return static_cast<std::size_t>(__cqe.res);
+      }
+    };
+
+    struct __write_op {
+      int __fd_;
+      std::span<const std::byte> __buffer_;
+      std::int64_t __offset_;
+#ifndef STDEXEC_HAS_IORING_OP_READ
+      ::iovec __iov_{};
+#endif
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.fd = __fd_;
+        __sqe.off = static_cast<__u64>(__offset_);
+#ifdef STDEXEC_HAS_IORING_OP_READ
+        __sqe.opcode = IORING_OP_WRITE;
+        __sqe.addr = bit_cast<__u64>(__buffer_.data());
+        __sqe.len = static_cast<__u32>(__buffer_.size());
+#else
+        __iov_ = ::iovec{
+          .iov_base = const_cast<std::byte*>(__buffer_.data()), .iov_len = __buffer_.size()};
+        __sqe.opcode = IORING_OP_WRITEV;
+        __sqe.addr = bit_cast<__u64>(&__iov_);
+        __sqe.len = 1;
+#endif
+      }
+
+      std::size_t result(const ::io_uring_cqe& __cqe) const noexcept {
+        return static_cast<std::size_t>(__cqe.res);
+      }
+    };
+
+    struct __writev_op {
+      int __fd_;
+      std::span<const ::iovec> __buffers_;
+      std::int64_t __offset_;
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.opcode = IORING_OP_WRITEV;
+        __sqe.fd = __fd_;
+        __sqe.off = static_cast<__u64>(__offset_);
+        __sqe.addr = bit_cast<__u64>(__buffers_.data());
+        __sqe.len = static_cast<__u32>(__buffers_.size());
+      }
+
+      std::size_t result(const ::io_uring_cqe& __cqe) const noexcept {
+        return static_cast<std::size_t>(__cqe.res);
+      }
+    };
+
+    struct __poll_op {
+      int __fd_;
+      short __events_;
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.opcode = IORING_OP_POLL_ADD;
+        __sqe.fd = __fd_;
+        __sqe.poll_events = static_cast<__u16>(__events_);
+      }
+
+      short result(const ::io_uring_cqe& __cqe) const noexcept {
+        return static_cast<short>(__cqe.res);
+      }
+    };
+
+#ifdef STDEXEC_HAS_IORING_OP_ACCEPT
+    struct __accept_op {
+      int __fd_;
+      int __flags_;
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.opcode = IORING_OP_ACCEPT;
+        __sqe.fd = __fd_;
+        __sqe.accept_flags = static_cast<__u32>(__flags_);
+      }
+
+      int result(const ::io_uring_cqe& __cqe) const noexcept {
+        return __cqe.res;
+      }
+    };
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_CONNECT
+    struct __connect_op {
+      int __fd_;
+      const ::sockaddr* __address_;
+      ::socklen_t __address_length_;
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.opcode = IORING_OP_CONNECT;
+        __sqe.fd = __fd_;
+        __sqe.addr = bit_cast<__u64>(__address_);
+        __sqe.off = __address_length_;
+      }
+
+      void result(const ::io_uring_cqe&) const noexcept {
+      }
+    };
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_SEND
+    struct __send_op {
+      int __fd_;
+      std::span<const std::byte> __buffer_;
+      int __flags_;
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.opcode = IORING_OP_SEND;
+        __sqe.fd = __fd_;
+        __sqe.addr = bit_cast<__u64>(__buffer_.data());
+        __sqe.len = static_cast<__u32>(__buffer_.size());
+        __sqe.msg_flags = static_cast<__u32>(__flags_);
+      }
+
+      std::size_t result(const ::io_uring_cqe& __cqe) const noexcept {
+        return static_cast<std::size_t>(__cqe.res);
+      }
+    };
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_RECV
+    struct __recv_op {
+      int __fd_;
+      std::span<std::byte> __buffer_;
+      int __flags_;
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.opcode = IORING_OP_RECV;
+        __sqe.fd = __fd_;
+        __sqe.addr = bit_cast<__u64>(__buffer_.data());
+        __sqe.len = static_cast<__u32>(__buffer_.size());
+        __sqe.msg_flags = static_cast<__u32>(__flags_);
+      }
+
+      std::size_t result(const ::io_uring_cqe& __cqe) const noexcept {
+        return static_cast<std::size_t>(__cqe.res);
+      }
+    };
+#endif
+
+    // Returns -EINVAL if the buffer or the offset violate the alignment requirements of files
+    // that are opened with O_DIRECT.
+    inline int __validate_direct_io(
+      const std::byte* __data,
+      std::size_t __size,
+      std::int64_t __offset,
+      std::size_t __alignment) noexcept {
+      const bool __is_aligned = __alignment != 0 && (__alignment & (__alignment - 1)) == 0
+                             && reinterpret_cast<std::uintptr_t>(__data) % __alignment == 0
+                             && __size % __alignment == 0 && __offset >= 0
+                             && static_cast<std::uint64_t>(__offset) % __alignment == 0;
+      return __is_aligned ? 0 : -EINVAL;
+    }
+
+    struct __direct_read_op {
+      __read_op __read_;
+      std::size_t __alignment_;
+      int __buffer_index_;
+
+      int validate() const noexcept {
+        return __validate_direct_io(
+          __read_.__buffer_.data(), __read_.__buffer_.size(), __read_.__offset_, __alignment_);
+      }
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        if (__buffer_index_ < 0) {
+          __read_.prepare(__sqe);
+        } else {
+          __sqe.opcode = IORING_OP_READ_FIXED;
+          __sqe.fd = __read_.__fd_;
+          __sqe.off = static_cast<__u64>(__read_.__offset_);
+          __sqe.addr = bit_cast<__u64>(__read_.__buffer_.data());
+          __sqe.len = static_cast<__u32>(__read_.__buffer_.size());
+          __sqe.buf_index = static_cast<__u16>(__buffer_index_);
+        }
+      }
+
+      std::size_t result(const ::io_uring_cqe& __cqe) const noexcept {
+        return static_cast<std::size_t>(__cqe.res);
+      }
+    };
+
+    struct __direct_write_op {
+      __write_op __write_;
+      std::size_t __alignment_;
+      int __buffer_index_;
+
+      int validate() const noexcept {
+        return __validate_direct_io(
+          __write_.__buffer_.data(), __write_.__buffer_.size(), __write_.__offset_, __alignment_);
+      }
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        if (__buffer_index_ < 0) {
+          __write_.prepare(__sqe);
+        } else {
+          __sqe.opcode = IORING_OP_WRITE_FIXED;
+          __sqe.fd = __write_.__fd_;
+          __sqe.off = static_cast<__u64>(__write_.__offset_);
+          __sqe.addr = bit_cast<__u64>(__write_.__buffer_.data());
+          __sqe.len = static_cast<__u32>(__write_.__buffer_.size());
+          __sqe.buf_index = static_cast<__u16>(__buffer_index_);
+        }
+      }
+
+      std::size_t result(const ::io_uring_cqe& __cqe) const noexcept {
+        return static_cast<std::size_t>(__cqe.res);
+      }
+    };
+
+#ifdef STDEXEC_HAS_IORING_OP_SEND_ZC
+    struct __send_zc_op {
+      int __fd_;
+      std::span<const std::byte> __buffer_;
+      int __flags_;
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.opcode = IORING_OP_SEND_ZC;
+        __sqe.fd = __fd_;
+        __sqe.addr = bit_cast<__u64>(__buffer_.data());
+        __sqe.len = static_cast<__u32>(__buffer_.size());
+        __sqe.msg_flags = static_cast<__u32>(__flags_);
+      }
+
+      std::size_t result(const ::io_uring_cqe& __cqe) const noexcept {
+        return static_cast<std::size_t>(__cqe.res);
+      }
+    };
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_SPLICE
+    struct __splice_op {
+      int __fd_in_;
+      std::int64_t __offset_in_;
+      int __fd_out_;
+      std::int64_t __offset_out_;
+      std::size_t __n_bytes_;
+      unsigned __flags_;
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.opcode = IORING_OP_SPLICE;
+        __sqe.splice_fd_in = __fd_in_;
+        __sqe.splice_off_in = static_cast<__u64>(__offset_in_);
+        __sqe.fd = __fd_out_;
+        __sqe.off = static_cast<__u64>(__offset_out_);
+        __sqe.len = static_cast<__u32>(__n_bytes_);
+        __sqe.splice_flags = __flags_;
+      }
+
+      std::size_t result(const ::io_uring_cqe& __cqe) const noexcept {
+        return static_cast<std::size_t>(__cqe.res);
+      }
+    };
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_TEE
+    struct __tee_op {
+      int __fd_in_;
+      int __fd_out_;
+      std::size_t __n_bytes_;
+      unsigned __flags_;
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.opcode = IORING_OP_TEE;
+        __sqe.splice_fd_in = __fd_in_;
+        __sqe.fd = __fd_out_;
+        __sqe.len = static_cast<__u32>(__n_bytes_);
+        __sqe.splice_flags = __flags_;
+      }
+
+      std::size_t result(const ::io_uring_cqe& __cqe) const noexcept {
+        return static_cast<std::size_t>(__cqe.res);
+      }
+    };
+#endif
+
+    struct __fsync_op {
+      int __fd_;
+      unsigned __flags_;
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.opcode = IORING_OP_FSYNC;
+        __sqe.fd = __fd_;
+        __sqe.fsync_flags = __flags_;
+      }
+
+      void result(const ::io_uring_cqe&) const noexcept {
+      }
+    };
+
+#ifdef STDEXEC_HAS_IORING_OP_OPENAT
+    struct __openat_op {
+      int __dirfd_;
+      const char* __path_;
+      int __flags_;
+      ::mode_t __mode_;
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.opcode = IORING_OP_OPENAT;
+        __sqe.fd = __dirfd_;
+        __sqe.addr = bit_cast<__u64>(__path_);
+        __sqe.len = static_cast<__u32>(__mode_);
+        __sqe.open_flags = static_cast<__u32>(__flags_);
+      }
+
+      int result(const ::io_uring_cqe& __cqe) const noexcept {
+        return __cqe.res;
+      }
+    };
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_STATX
+    struct __statx_op {
+      int __dirfd_;
+      const char* __path_;
+      int __flags_;
+      unsigned __mask_;
+      struct ::statx* __statx_;
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.opcode = IORING_OP_STATX;
+        __sqe.fd = __dirfd_;
+        __sqe.addr = bit_cast<__u64>(__path_);
+        __sqe.len = __mask_;
+        __sqe.off = bit_cast<__u64>(__statx_);
+        __sqe.statx_flags = static_cast<__u32>(__flags_);
+      }
+
+      void result(const ::io_uring_cqe&) const noexcept {
+      }
+    };
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_CLOSE
+    struct __close_op {
+      int __fd_;
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.opcode = IORING_OP_CLOSE;
+        __sqe.fd = __fd_;
+      }
+
+      void result(const ::io_uring_cqe&) const noexcept {
+      }
+    };
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_FALLOCATE
+    struct __fallocate_op {
+      int __fd_;
+      int __mode_;
+      std::int64_t __offset_;
+      std::int64_t __length_;
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.opcode = IORING_OP_FALLOCATE;
+        __sqe.fd = __fd_;
+        __sqe.len = static_cast<__u32>(__mode_);
+        __sqe.off = static_cast<__u64>(__offset_);
+        __sqe.addr = static_cast<__u64>(__length_);
+      }
+
+      void result(const ::io_uring_cqe&) const noexcept {
+      }
+    };
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_FADVISE
+    struct __fadvise_op {
+      int __fd_;
+      std::int64_t __offset_;
+      std::int64_t __length_;
+      int __advice_;
+
+      // The length is passed in the 32 bit len field of the submission queue entry
+      int validate() const noexcept {
+        const bool __fits = 0 <= __length_ && __length_ <= std::numeric_limits<__u32>::max();
+        return __fits ? 0 : -EINVAL;
+      }
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.opcode = IORING_OP_FADVISE;
+        __sqe.fd = __fd_;
+        __sqe.off = static_cast<__u64>(__offset_);
+        __sqe.len = static_cast<__u32>(__length_);
+        __sqe.fadvise_advice = static_cast<__u32>(__advice_);
+      }
+
+      void result(const ::io_uring_cqe&) const noexcept {
+      }
+    };
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_RENAMEAT
+    struct __renameat_op {
+      int __old_dirfd_;
+      const char* __old_path_;
+      int __new_dirfd_;
+      const char* __new_path_;
+      unsigned __flags_;
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.opcode = IORING_OP_RENAMEAT;
+        __sqe.fd = __old_dirfd_;
+        __sqe.addr = bit_cast<__u64>(__old_path_);
+        __sqe.len = static_cast<__u32>(__new_dirfd_);
+        __sqe.off = bit_cast<__u64>(__new_path_);
+        __sqe.rename_flags = __flags_;
+      }
+
+      void result(const ::io_uring_cqe&) const noexcept {
+      }
+    };
+#endif
+
+    // Reads a single value from a file descriptor that produces values of a fixed size, such as
+    // a signalfd or an eventfd. The value is stored in the operation state.
+    template <class _Value>
+    struct __read_value_op {
+      int __fd_;
+      _Value __value_{};
+#ifndef STDEXEC_HAS_IORING_OP_READ
+      ::iovec __iov_{};
+#endif
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.fd = __fd_;
+#ifdef STDEXEC_HAS_IORING_OP_READ
+        __sqe.opcode = IORING_OP_READ;
+        __sqe.addr = bit_cast<__u64>(&__value_);
+        __sqe.len = sizeof(_Value);
+#else
+        __iov_ = ::iovec{.iov_base = &__value_, .iov_len = sizeof(_Value)};
+        __sqe.opcode = IORING_OP_READV;
+        __sqe.addr = bit_cast<__u64>(&__iov_);
+        __sqe.len = 1;
+#endif
+      }
+
+      _Value result(const ::io_uring_cqe&) const noexcept {
+        return __value_;
+      }
+    };
+
+    struct __eventfd_write_op {
+      int __fd_;
+      std::uint64_t __value_;
+#ifndef STDEXEC_HAS_IORING_OP_READ
+      ::iovec __iov_{};
+#endif
+
+      void prepare(::io_uring_sqe& __sqe) noexcept {
+        __sqe.fd = __fd_;
+#ifdef STDEXEC_HAS_IORING_OP_READ
+        __sqe.opcode = IORING_OP_WRITE;
+        __sqe.addr = bit_cast<__u64>(&__value_);
+        __sqe.len = sizeof(__value_);
+#else
+        __iov_ = ::iovec{.iov_base = &__value_, .iov_len = sizeof(__value_)};
+        __sqe.opcode = IORING_OP_WRITEV;
+        __sqe.addr = bit_cast<__u64>(&__iov_);
+        __sqe.len = 1;
+#endif
+      }
+
+      void result(const ::io_uring_cqe&) const noexcept {
+      }
+    };
+
+    using __wait_signal_op = __read_value_op<::signalfd_siginfo>;
+    using __eventfd_read_op = __read_value_op<std::uint64_t>;
+
+    template <class _Op>
+    struct __io_sender;
+
     class __scheduler {
      public:
       __context* __context_;
@@ -1142,11 +2651,291 @@ namespace exec {
     inline __scheduler __context::get_scheduler() noexcept {
       return __scheduler{this};
     }
+
+    template <class _Op>
+    struct __io_sender {
+      class __t {
+       public:
+        using is_sender = void;
+        using __id = __io_sender;
+        using completion_signatures = __io_completion_signatures<_Op>;
+
+        __t(__context& __context, const _Op& __op) noexcept
+          : __env_{&__context}
+          , __op_{__op} {
+        }
+
+       private:
+        __scheduler::__schedule_env __env_;
+        _Op __op_;
+
+        friend __scheduler::__schedule_env
+          tag_invoke(stdexec::get_env_t, const __t& __sender) noexcept {
+          return __sender.__env_;
+        }
+
+        template <stdexec::receiver_of<completion_signatures> _Receiver>
+        friend stdexec::__t<__io_operation<_Op, stdexec::__id<_Receiver>>>
+          tag_invoke(stdexec::connect_t, const __t& __sender, _Receiver&& __receiver) {
+          return stdexec::__t<__io_operation<_Op, stdexec::__id<_Receiver>>>(
+            std::in_place, *__sender.__env_.__context_, __sender.__op_, (_Receiver&&) __receiver);
+        }
+      };
+    };
+
+    template <class _Op>
+    using __io_sender_t = stdexec::__t<__io_sender<_Op>>;
+
+    inline __io_sender_t<__read_op> tag_invoke(
+      exec::async_read_t,
+      const __scheduler& __sched,
+      int __fd,
+      std::span<std::byte> __buffer,
+      std::int64_t __offset = -1) noexcept {
+      return {*__sched.__context_, __read_op{__fd, __buffer, __offset}};
+    }
+
+    inline __io_sender_t<__write_op> tag_invoke(
+      exec::async_write_t,
+      const __scheduler& __sched,
+      int __fd,
+      std::span<const std::byte> __buffer,
+      std::int64_t __offset = -1) noexcept {
+      return {*__sched.__context_, __write_op{__fd, __buffer, __offset}};
+    }
+
+    inline __io_sender_t<__writev_op> tag_invoke(
+      exec::async_writev_t,
+      const __scheduler& __sched,
+      int __fd,
+      std::span<const ::iovec> __buffers,
+      std::int64_t __offset = -1) noexcept {
+      return {*__sched.__context_, __writev_op{__fd, __buffers, __offset}};
+    }
+
+    inline __io_sender_t<__poll_op> tag_invoke(
+      exec::async_poll_t,
+      const __scheduler& __sched,
+      int __fd,
+      short __events) noexcept {
+      return {*__sched.__context_, __poll_op{__fd, __events}};
+    }
+
+#ifdef STDEXEC_HAS_IORING_OP_ACCEPT
+    inline __io_sender_t<__accept_op> tag_invoke(
+      exec::async_accept_t,
+      const __scheduler& __sched,
+      int __fd,
+      int __flags = 0) noexcept {
+      return {*__sched.__context_, __accept_op{__fd, __flags}};
+    }
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_CONNECT
+    inline __io_sender_t<__connect_op> tag_invoke(
+      exec::async_connect_t,
+      const __scheduler& __sched,
+      int __fd,
+      const ::sockaddr* __address,
+      ::socklen_t __address_length) noexcept {
+      return {*__sched.__context_, __connect_op{__fd, __address, __address_length}};
+    }
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_SEND
+    inline __io_sender_t<__send_op> tag_invoke(
+      exec::async_send_t,
+      const __scheduler& __sched,
+      int __fd,
+      std::span<const std::byte> __buffer,
+      int __flags = 0) noexcept {
+      return {*__sched.__context_, __send_op{__fd, __buffer, __flags}};
+    }
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_RECV
+    inline __io_sender_t<__recv_op> tag_invoke(
+      exec::async_recv_t,
+      const __scheduler& __sched,
+      int __fd,
+      std::span<std::byte> __buffer,
+      int __flags = 0) noexcept {
+      return {*__sched.__context_, __recv_op{__fd, __buffer, __flags}};
+    }
+#endif
+
+    inline __io_sender_t<__direct_read_op> tag_invoke(
+      exec::async_read_direct_t,
+      const __scheduler& __sched,
+      int __fd,
+      std::span<std::byte> __buffer,
+      std::int64_t __offset,
+      std::size_t __alignment = 4096,
+      int __buffer_index = -1) noexcept {
+      return {
+        *__sched.__context_,
+        __direct_read_op{{__fd, __buffer, __offset}, __alignment, __buffer_index}};
+    }
+
+    inline __io_sender_t<__direct_write_op> tag_invoke(
+      exec::async_write_direct_t,
+      const __scheduler& __sched,
+      int __fd,
+      std::span<const std::byte> __buffer,
+      std::int64_t __offset,
+      std::size_t __alignment = 4096,
+      int __buffer_index = -1) noexcept {
+      return {
+        *__sched.__context_,
+        __direct_write_op{{__fd, __buffer, __offset}, __alignment, __buffer_index}};
+    }
+
+#ifdef STDEXEC_HAS_IORING_OP_SEND_ZC
+    inline __io_sender_t<__send_zc_op> tag_invoke(
+      exec::async_send_zc_t,
+      const __scheduler& __sched,
+      int __fd,
+      std::span<const std::byte> __buffer,
+      int __flags = 0) noexcept {
+      return {*__sched.__context_, __send_zc_op{__fd, __buffer, __flags}};
+    }
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_SPLICE
+    inline __io_sender_t<__splice_op> tag_invoke(
+      exec::async_splice_t,
+      const __scheduler& __sched,
+      int __fd_in,
+      std::int64_t __offset_in,
+      int __fd_out,
+      std::int64_t __offset_out,
+      std::size_t __n_bytes,
+      unsigned __flags = 0) noexcept {
+      return {
+        *__sched.__context_,
+        __splice_op{__fd_in, __offset_in, __fd_out, __offset_out, __n_bytes, __flags}};
+    }
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_TEE
+    inline __io_sender_t<__tee_op> tag_invoke(
+      exec::async_tee_t,
+      const __scheduler& __sched,
+      int __fd_in,
+      int __fd_out,
+      std::size_t __n_bytes,
+      unsigned __flags = 0) noexcept {
+      return {*__sched.__context_, __tee_op{__fd_in, __fd_out, __n_bytes, __flags}};
+    }
+#endif
+
+    inline __io_sender_t<__fsync_op> tag_invoke(
+      exec::async_fsync_t,
+      const __scheduler& __sched,
+      int __fd,
+      unsigned __flags = 0) noexcept {
+      return {*__sched.__context_, __fsync_op{__fd, __flags}};
+    }
+
+#ifdef STDEXEC_HAS_IORING_OP_OPENAT
+    inline __io_sender_t<__openat_op> tag_invoke(
+      exec::async_openat_t,
+      const __scheduler& __sched,
+      int __dirfd,
+      const char* __path,
+      int __flags,
+      ::mode_t __mode = 0) noexcept {
+      return {*__sched.__context_, __openat_op{__dirfd, __path, __flags, __mode}};
+    }
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_STATX
+    inline __io_sender_t<__statx_op> tag_invoke(
+      exec::async_statx_t,
+      const __scheduler& __sched,
+      int __dirfd,
+      const char* __path,
+      int __flags,
+      unsigned __mask,
+      struct ::statx* __statx) noexcept {
+      return {*__sched.__context_, __statx_op{__dirfd, __path, __flags, __mask, __statx}};
+    }
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_CLOSE
+    inline __io_sender_t<__close_op>
+      tag_invoke(exec::async_close_t, const __scheduler& __sched, int __fd) noexcept {
+      return {*__sched.__context_, __close_op{__fd}};
+    }
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_FALLOCATE
+    inline __io_sender_t<__fallocate_op> tag_invoke(
+      exec::async_fallocate_t,
+      const __scheduler& __sched,
+      int __fd,
+      int __mode,
+      std::int64_t __offset,
+      std::int64_t __length) noexcept {
+      return {*__sched.__context_, __fallocate_op{__fd, __mode, __offset, __length}};
+    }
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_FADVISE
+    inline __io_sender_t<__fadvise_op> tag_invoke(
+      exec::async_fadvise_t,
+      const __scheduler& __sched,
+      int __fd,
+      std::int64_t __offset,
+      std::int64_t __length,
+      int __advice) noexcept {
+      return {*__sched.__context_, __fadvise_op{__fd, __offset, __length, __advice}};
+    }
+#endif
+
+#ifdef STDEXEC_HAS_IORING_OP_RENAMEAT
+    inline __io_sender_t<__renameat_op> tag_invoke(
+      exec::async_renameat_t,
+      const __scheduler& __sched,
+      int __old_dirfd,
+      const char* __old_path,
+      int __new_dirfd,
+      const char* __new_path,
+      unsigned __flags = 0) noexcept {
+      return {
+        *__sched.__context_,
+        __renameat_op{__old_dirfd, __old_path, __new_dirfd, __new_path, __flags}};
+    }
+#endif
+
+    inline __io_sender_t<__wait_signal_op>
+      tag_invoke(exec::async_wait_signal_t, const __scheduler& __sched, int __signal_fd) noexcept {
+      return {*__sched.__context_, __wait_signal_op{__signal_fd}};
+    }
+
+    inline __io_sender_t<__eventfd_read_op>
+      tag_invoke(exec::async_eventfd_read_t, const __scheduler& __sched, int __eventfd) noexcept {
+      return {*__sched.__context_, __eventfd_read_op{__eventfd}};
+    }
+
+    inline __io_sender_t<__eventfd_write_op> tag_invoke(
+      exec::async_eventfd_write_t,
+      const __scheduler& __sched,
+      int __eventfd,
+      std::uint64_t __value = 1) noexcept {
+      return {*__sched.__context_, __eventfd_write_op{__eventfd, __value}};
+    }
   }
 
   using __io_uring::until;
+  using io_uring_context_params = __io_uring::__params;
+  using io_uring_context_metrics = __io_uring::__metrics;
   using io_uring_context = __io_uring::__context;
   using io_uring_scheduler = __io_uring::__scheduler;
+
+  inline bool io_uring_is_supported() noexcept {
+    return __io_uring::__is_supported();
+  }
 }
 
 #endif // if __has_include(<linux/verison.h>)
@@ -0,0 +1,411 @@
+/*
+ * Copyright (c) 2023 Maikel Nadolski
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "./io_uring_context.hpp"
+
+#include <array>
+
+namespace exec {
+  namespace __io_uring {
+    // Links io_uring operations such that they are submitted in one pass and executed in order
+    // by the kernel.
+    //
+    // Each child sender has to be an io_uring sender whose operation submits exactly one
+    // submission queue entry, or a link itself. The link completes after all its children have
+    // completed. It completes with the concatenated values of all children, with the first
+    // error of any child or with set_stopped if any child has been cancelled. If a child of a
+    // soft link fails, the kernel cancels all its successors. A link with more submission queue
+    // entries than the io_uring_context has completes with std::system_error(EINVAL).
+
+    template <class _Sender, class _Env>
+    using __link_values_t =
+      stdexec::__value_types_of_t< //
+        _Sender,
+        _Env,
+        stdexec::__q<stdexec::__decayed_tuple>,
+        stdexec::__q<stdexec::__msingle>>;
+
+    template <class _Env, class... _Senders>
+    using __link_completion_signatures = stdexec::completion_signatures<
+      stdexec::__minvoke<
+        stdexec::__mconcat<stdexec::__qf<stdexec::set_value_t>>,
+        __link_values_t<_Senders, _Env>...>,
+      stdexec::set_error_t(std::exception_ptr),
+      stdexec::set_stopped_t()>;
+
+    template <class _Receiver, class _Values, std::size_t _Size>
+    struct __link_op_base : __task {
+      _Receiver __receiver_;
+      _Values __values_{};
+      std::exception_ptr __error_{};
+      std::atomic<bool> __stopped_{false};
+      std::atomic<int> __count_{static_cast<int>(_Size)};
+      std::array<__task*, _Size> __tasks_{};
+      __u8 __flags_;
+
+      static bool __ready_(__task*) noexcept {
+        return false;
+      }
+
+      static void __submit_(__task*, ::io_uring_sqe&) noexcept {
+        STDEXEC_ASSERT(false);
+      }
+
+      static void __complete_(__task* __pointer, const ::io_uring_cqe&) noexcept {
+        __stop_link(__pointer);
+      }
+
+      static __link_view __link_(__task* __pointer) noexcept {
+        __link_op_base* __self = static_cast<__link_op_base*>(__pointer);
+        return __link_view{__self->__tasks_, __self->__flags_};
+      }
+
+      static constexpr __task_vtable __vtable{&__ready_, &__submit_, &__complete_, &__link_};
+
+      __link_op_base(_Receiver&& __receiver, __u8 __flags)
+        : __task{__vtable}
+        , __receiver_{(_Receiver&&) __receiver}
+        , __flags_{__flags} {
+      }
+
+      template <std::size_t _Index, class... _Args>
+      void __set_value(_Args&&... __args) noexcept {
+        std::get<_Index>(__values_).emplace((_Args&&) __args...);
+        __arrive();
+      }
+
+      template <class _Error>
+      void __set_error(_Error&& __error) noexcept {
+        // Children complete on the thread that drives the io_uring_context, one after another.
+        if (!__error_) {
+          if constexpr (std::same_as<stdexec::__decay_t<_Error>, std::exception_ptr>) {
+            __error_ = (_Error&&) __error;
+          } else {
+            __error_ = std::make_exception_ptr((_Error&&) __error);
+          }
+        }
+        __arrive();
+      }
+
+      void __set_stopped() noexcept {
+        __stopped_.store(true, std::memory_order_relaxed);
+        __arrive();
+      }
+
+      void __arrive() noexcept {
+        if (__count_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+          return;
+        }
+        if (__error_) {
+          stdexec::set_error((_Receiver&&) __receiver_, std::move(__error_));
+        } else if (__stopped_.load(std::memory_order_relaxed)) {
+          stdexec::set_stopped((_Receiver&&) __receiver_);
+        } else {
+          std::apply(
+            [this]<class... _Args>(_Args&&... __args) noexcept {
+              stdexec::set_value((_Receiver&&) __receiver_, (_Args&&) __args...);
+            },
+            std::apply(
+              []<class... _Optionals>(_Optionals&&... __optionals) noexcept {
+                return std::tuple_cat(*(_Optionals&&) __optionals...);
+              },
+              (_Values&&) __values_));
+        }
+      }
+    };
+
+    template <class _Receiver, class _Values, std::size_t _Size, std::size_t _Index>
+    struct __link_receiver {
+      class __t {
+       public:
+        using is_receiver = void;
+        using __id = __link_receiver;
+
+        explicit __t(__link_op_base<_Receiver, _Values, _Size>* __op) noexcept
+          : __op_{__op} {
+        }
+
+       private:
+        __link_op_base<_Receiver, _Values, _Size>* __op_;
+
+        template <stdexec::same_as<stdexec::set_value_t> _Tag, class... _Args>
+        friend void tag_invoke(_Tag, __t&& __self, _Args&&... __args) noexcept {
+          __self.__op_->template __set_value<_Index>((_Args&&) __args...);
+        }
+
+        template <stdexec::same_as<stdexec::set_error_t> _Tag, class _Error>
+        friend void tag_invoke(_Tag, __t&& __self, _Error&& __error) noexcept {
+          __self.__op_->__set_error((_Error&&) __error);
+        }
+
+        template <stdexec::same_as<stdexec::set_stopped_t> _Tag>
+        friend void tag_invoke(_Tag, __t&& __self) noexcept {
+          __self.__op_->__set_stopped();
+        }
+
+        friend stdexec::env_of_t<_Receiver>
+          tag_invoke(stdexec::get_env_t, const __t& __self) noexcept {
+          return stdexec::get_env(__self.__op_->__receiver_);
+        }
+      };
+    };
+
+    template <class _Op>
+    concept __linkable_operation = //
+      std::derived_from<_Op, __task> && requires(_Op& __op) {
+        { __op.context() } noexcept -> std::same_as<__context&>;
+      };
+
+    template <class _Tuple>
+    inline constexpr bool __all_tasks = false;
+
+    template <class... _Ops>
+    inline constexpr bool __all_tasks<std::tuple<_Ops...>> =
+      (std::derived_from<_Ops, __task> && ...);
+
+    template <class _ReceiverId, class... _SenderIds>
+    struct __link_op {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+      using _Env = stdexec::env_of_t<_Receiver>;
+      using __values_t =
+        std::tuple<std::optional<__link_values_t<stdexec::__t<_SenderIds>, _Env>>...>;
+      static constexpr std::size_t __size = sizeof...(_SenderIds);
+      using __base_t = __link_op_base<_Receiver, __values_t, __size>;
+
+      template <std::size_t _Index>
+      using __receiver_t = stdexec::__t<__link_receiver<_Receiver, __values_t, __size, _Index>>;
+
+      template <class _Indices>
+      struct __ops;
+
+      template <std::size_t... _Is>
+      struct __ops<std::index_sequence<_Is...>> {
+        using __t =
+          std::tuple<stdexec::connect_result_t<stdexec::__t<_SenderIds>, __receiver_t<_Is>>...>;
+      };
+
+      using __ops_t = stdexec::__t<__ops<std::index_sequence_for<_SenderIds...>>>;
+
+      class __t : public __base_t {
+       public:
+        using __id = __link_op;
+
+        template <class _SenderTuple>
+        __t(_SenderTuple&& __senders, _Receiver&& __rcvr, __u8 __flags)
+          : __t{
+            (_SenderTuple&&) __senders,
+            (_Receiver&&) __rcvr,
+            __flags,
+            std::index_sequence_for<_SenderIds...>{}} {
+        }
+
+        __context& context() noexcept {
+          return std::get<0>(__ops_).context();
+        }
+
+       private:
+        template <class _SenderTuple, std::size_t... _Is>
+        __t(
+          _SenderTuple&& __senders,
+          _Receiver&& __rcvr,
+          __u8 __flags,
+          std::index_sequence<_Is...>)
+          : __base_t{(_Receiver&&) __rcvr, __flags}
+          , __ops_{stdexec::__conv{[&__senders, this] {
+            return stdexec::connect(
+              std::get<_Is>((_SenderTuple&&) __senders),
+              __receiver_t<_Is>{static_cast<__base_t*>(this)});
+          }}...} {
+          this->__tasks_ = {static_cast<__task*>(&std::get<_Is>(__ops_))...};
+        }
+
+        __ops_t __ops_;
+
+        static_assert(
+          __all_tasks<__ops_t>,
+          "The children of an io_uring link need to be io_uring senders.");
+        static_assert(
+          __linkable_operation<std::tuple_element_t<0, __ops_t>>,
+          "The first child of an io_uring link needs to be an io_uring operation.");
+
+        friend void tag_invoke(stdexec::start_t, __t& __self) noexcept {
+          __context& __context = __self.context();
+          // A link that does not fit into the submission queue could never be submitted
+          if (__n_entries(&__self) > __context.submission_queue_size()) {
+            stdexec::set_error(
+              (_Receiver&&) __self.__receiver_,
+              std::make_exception_ptr(std::system_error(EINVAL, std::system_category())));
+            return;
+          }
+          if (__context.submit(&__self)) {
+            __context.wakeup();
+          }
+        }
+      };
+    };
+
+    template <__u8 _Flags, class... _SenderIds>
+    struct __link_sender {
+      template <class _Receiver>
+      using __op_t =
+        stdexec::__t<__link_op<stdexec::__id<stdexec::__decay_t<_Receiver>>, _SenderIds...>>;
+
+      class __t {
+       public:
+        using is_sender = void;
+        using __id = __link_sender;
+
+        template <class... _Senders>
+        explicit __t(_Senders&&... __senders)
+          : __senders_((_Senders&&) __senders...) {
+        }
+
+       private:
+        std::tuple<stdexec::__t<_SenderIds>...> __senders_;
+
+        template <stdexec::__decays_to<__t> _Self, stdexec::receiver _Receiver>
+          requires stdexec::receiver_of<
+            _Receiver,
+            __link_completion_signatures<
+              stdexec::env_of_t<_Receiver>,
+              stdexec::__t<_SenderIds>...>>
+        friend __op_t<_Receiver>
+          tag_invoke(stdexec::connect_t, _Self&& __self, _Receiver&& __rcvr) {
+          return __op_t<_Receiver>{((_Self&&) __self).__senders_, (_Receiver&&) __rcvr, _Flags};
+        }
+
+        template <stdexec::__decays_to<__t> _Self, class _Env>
+        friend auto tag_invoke(stdexec::get_completion_signatures_t, _Self&&, _Env)
+          -> __link_completion_signatures<_Env, stdexec::__t<_SenderIds>...>;
+      };
+    };
+
+    // The operation state for an IORING_OP_LINK_TIMEOUT entry. It is only meaningful as a part of
+    // a link where it directly follows the operation that it times out.
+    template <class _ReceiverId>
+    struct __link_timeout_operation {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      class __t : public __task {
+        struct __kernel_timespec {
+          __s64 __tv_sec;
+          __s64 __tv_nsec;
+        };
+
+        _Receiver __receiver_;
+        __kernel_timespec __timeout_;
+
+        static bool __ready_(__task*) noexcept {
+          return false;
+        }
+
+        static void __submit_(__task* __pointer, ::io_uring_sqe& __sqe) noexcept {
+          __t* __self = static_cast<__t*>(__pointer);
+          __sqe = ::io_uring_sqe{};
+          __sqe.opcode = IORING_OP_LINK_TIMEOUT;
+          __sqe.addr = bit_cast<__u64>(&__self->__timeout_);
+          __sqe.len = 1;
+        }
+
+        static void __complete_(__task* __pointer, const ::io_uring_cqe& __cqe) noexcept {
+          __t* __self = static_cast<__t*>(__pointer);
+          // -ECANCELED or -ENOENT means that the timed operation completed in time.
+          if (__cqe.res == -ETIME) {
+            stdexec::set_error(
+              (_Receiver&&) __self->__receiver_,
+              std::make_exception_ptr(std::system_error(ETIMEDOUT, std::system_category())));
+          } else {
+            stdexec::set_value((_Receiver&&) __self->__receiver_);
+          }
+        }
+
+        static constexpr __task_vtable __vtable{&__ready_, &__submit_, &__complete_};
+
+        friend void tag_invoke(stdexec::start_t, __t& __self) noexcept {
+          // A link timeout on its own does not time out anything.
+          stdexec::set_error(
+            (_Receiver&&) __self.__receiver_,
+            std::make_exception_ptr(std::system_error(EINVAL, std::system_category())));
+        }
+
+       public:
+        __t(std::chrono::nanoseconds __timeout, _Receiver&& __receiver) noexcept
+          : __task{__vtable}
+          , __receiver_{(_Receiver&&) __receiver} {
+          auto __secs = std::chrono::duration_cast<std::chrono::seconds>(__timeout);
+          auto __nsecs = __timeout - __secs;
+          __timeout_ = __kernel_timespec{
+            std::max<__s64>(__secs.count(), 0), std::max<__s64>(__nsecs.count(), 0)};
+        }
+      };
+    };
+
+    struct __link_timeout_sender {
+      using is_sender = void;
+      using __id = __link_timeout_sender;
+      using __t = __link_timeout_sender;
+      using completion_signatures = stdexec::completion_signatures<
+        stdexec::set_value_t(),
+        stdexec::set_error_t(std::exception_ptr)>;
+
+      std::chrono::nanoseconds __timeout_;
+
+      template <stdexec::receiver_of<completion_signatures> _Receiver>
+      friend stdexec::__t<__link_timeout_operation<stdexec::__id<stdexec::__decay_t<_Receiver>>>>
+        tag_invoke(
+          stdexec::connect_t,
+          const __link_timeout_sender& __self,
+          _Receiver&& __rcvr) noexcept {
+        return {__self.__timeout_, (_Receiver&&) __rcvr};
+      }
+    };
+
+    template <__u8 _Flags>
+    struct __link_t {
+      template <class... _Senders>
+      using __sender_t =
+        stdexec::__t<__link_sender<_Flags, stdexec::__id<stdexec::__decay_t<_Senders>>...>>;
+
+      template <stdexec::sender... _Senders>
+        requires(sizeof...(_Senders) > 0)
+      __sender_t<_Senders...> operator()(_Senders&&... __senders) const {
+        return __sender_t<_Senders...>((_Senders&&) __senders...);
+      }
+    };
+
+    struct __link_timeout_t {
+      template <stdexec::sender _Sender>
+      auto operator()(_Sender&& __sender, std::chrono::nanoseconds __timeout) const {
+        return __link_t<IOSQE_IO_LINK>{}((_Sender&&) __sender, __link_timeout_sender{__timeout});
+      }
+    };
+  }
+
+  // io_uring_link(senders...) submits all senders as one IOSQE_IO_LINK chain.
+  inline constexpr __io_uring::__link_t<IOSQE_IO_LINK> io_uring_link{};
+
+  // io_uring_hardlink(senders...) submits all senders as one IOSQE_IO_HARDLINK chain, i.e. a
+  // failing operation does not cancel its successors.
+  inline constexpr __io_uring::__link_t<IOSQE_IO_HARDLINK> io_uring_hardlink{};
+
+  // io_uring_link_timeout(sender, duration) cancels the operation of the sender if it does not
+  // complete within the given duration and completes with std::system_error(ETIMEDOUT) instead.
+  // The timeout is started by the kernel when the operation starts. The returned sender can be
+  // used as a child of an io_uring_link to impose a deadline on an individual operation.
+  inline constexpr __io_uring::__link_timeout_t io_uring_link_timeout{};
+}
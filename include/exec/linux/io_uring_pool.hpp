@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2023 Maikel Nadolski
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "./io_uring_context.hpp"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace exec {
+  namespace __io_uring {
+    // The setup parameters of an io_uring_pool.
+    //
+    // If `pin_threads` is true, the i-th thread of the pool is pinned to the i-th CPU (modulo the
+    // number of CPUs). If `attach_wq` is true, all rings share the async worker pool of the first
+    // ring via IORING_SETUP_ATTACH_WQ. Every ring is created with `context_params`.
+    struct __pool_params {
+      std::size_t n_threads = std::max(std::thread::hardware_concurrency(), 1u);
+      bool pin_threads = false;
+      bool attach_wq = false;
+      __params context_params{};
+    };
+
+    // An io_uring_pool owns one io_uring_context per thread and drives each context on its own
+    // thread.
+    //
+    // Senders of the pool's scheduler are submitted to the ring of the calling thread if it is a
+    // thread of the pool. Otherwise, the rings are selected in a round-robin fashion.
+    class __pool {
+     public:
+      explicit __pool(const __pool_params& __options = {})
+        : __contexts_(std::max(__options.n_threads, std::size_t{1})) {
+        __params __ctx_params = __options.context_params;
+        for (std::unique_ptr<__context>& __ctx: __contexts_) {
+          __ctx = std::make_unique<__context>(__ctx_params);
+          if (__options.attach_wq && __ctx_params.wq_fd < 0) {
+            __ctx_params.wq_fd = __contexts_.front()->native_handle();
+          }
+        }
+        __threads_.reserve(__contexts_.size());
+        try {
+          for (std::size_t __i = 0; __i < __contexts_.size(); ++__i) {
+            __threads_.emplace_back([this, __i, __pin = __options.pin_threads] {
+              if (__pin) {
+                __pin_to_cpu(__i);
+              }
+              __current_pool_ = this;
+              __current_context_ = __contexts_[__i].get();
+              __contexts_[__i]->run_until_stopped();
+            });
+          }
+        } catch (...) {
+          __stop_and_join();
+          throw;
+        }
+      }
+
+      explicit __pool(std::size_t __n_threads)
+        : __pool(__pool_params{.n_threads = __n_threads}) {
+      }
+
+      __pool(__pool&&) = delete;
+
+      ~__pool() {
+        __stop_and_join();
+      }
+
+      void request_stop() {
+        for (std::unique_ptr<__context>& __ctx: __contexts_) {
+          __ctx->request_stop();
+        }
+      }
+
+      // Registers the given buffers with every context of the pool, such that a buffer index is
+      // valid no matter on which context an operation runs.
+      void register_buffers(std::span<const ::iovec> __buffers) {
+        for (std::unique_ptr<__context>& __ctx: __contexts_) {
+          __ctx->register_buffers(__buffers);
+        }
+      }
+
+      void unregister_buffers() {
+        for (std::unique_ptr<__context>& __ctx: __contexts_) {
+          __ctx->unregister_buffers();
+        }
+      }
+
+      std::size_t size() const noexcept {
+        return __contexts_.size();
+      }
+
+      __context& context(std::size_t __index) noexcept {
+        return *__contexts_[__index];
+      }
+
+      class __scheduler;
+
+      __scheduler get_scheduler() noexcept;
+
+     private:
+      void __stop_and_join() {
+        request_stop();
+        for (std::thread& __thr: __threads_) {
+          if (__thr.joinable()) {
+            __thr.join();
+          }
+        }
+      }
+
+      static void __pin_to_cpu(std::size_t __index) noexcept {
+        const auto __n_cpus = std::max(std::thread::hardware_concurrency(), 1u);
+        ::cpu_set_t __cpus;
+        CPU_ZERO(&__cpus);
+        CPU_SET(__index % __n_cpus, &__cpus);
+        // Pinning is an optimization. We keep running unpinned if it fails.
+        ::pthread_setaffinity_np(::pthread_self(), sizeof(__cpus), &__cpus);
+      }
+
+      // Returns the context of the calling thread if it belongs to this pool and the next context
+      // in round-robin order otherwise.
+      __context& __select_context() noexcept {
+        if (__current_pool_ == this) {
+          return *__current_context_;
+        }
+        std::size_t __index = __next_.fetch_add(1, std::memory_order_relaxed);
+        return *__contexts_[__index % __contexts_.size()];
+      }
+
+      static inline thread_local const __pool* __current_pool_ = nullptr;
+      static inline thread_local __context* __current_context_ = nullptr;
+
+      std::vector<std::unique_ptr<__context>> __contexts_;
+      std::vector<std::thread> __threads_;
+      std::atomic<std::size_t> __next_{0};
+    };
+
+    template <class _Scheduler>
+    struct __pool_env {
+      _Scheduler __sched_;
+
+      friend _Scheduler tag_invoke(
+        stdexec::get_completion_scheduler_t<stdexec::set_value_t>,
+        const __pool_env& __env) noexcept {
+        return __env.__sched_;
+      }
+    };
+
+    // Wraps a sender of one of the pool's rings such that it reports the pool's scheduler as its
+    // completion scheduler.
+    template <class _Scheduler, class _Sender>
+    struct __pool_sender {
+      using is_sender = void;
+
+      _Scheduler __sched_;
+      _Sender __sndr_;
+
+      friend __pool_env<_Scheduler>
+        tag_invoke(stdexec::get_env_t, const __pool_sender& __self) noexcept {
+        return {__self.__sched_};
+      }
+
+      template <class _Env>
+      friend auto tag_invoke(stdexec::get_completion_signatures_t, const __pool_sender&, _Env)
+        -> stdexec::completion_signatures_of_t<const _Sender&, _Env> {
+        return {};
+      }
+
+      template <stdexec::receiver _Receiver>
+        requires stdexec::sender_to<const _Sender&, _Receiver>
+      friend auto
+        tag_invoke(stdexec::connect_t, const __pool_sender& __self, _Receiver&& __receiver)
+          -> stdexec::connect_result_t<const _Sender&, _Receiver> {
+        return stdexec::connect(__self.__sndr_, (_Receiver&&) __receiver);
+      }
+    };
+
+    class __pool::__scheduler {
+     public:
+      friend bool operator==(const __scheduler&, const __scheduler&) = default;
+
+     private:
+      friend class __pool;
+
+      explicit __scheduler(__pool* __pool) noexcept
+        : __pool_{__pool} {
+      }
+
+      __pool* __pool_;
+
+      io_uring_scheduler __select() const noexcept {
+        return __pool_->__select_context().get_scheduler();
+      }
+
+      template <class _Sender>
+      __pool_sender<__scheduler, _Sender> __wrap(_Sender __sndr) const {
+        return {*this, (_Sender&&) __sndr};
+      }
+
+      friend auto tag_invoke(stdexec::schedule_t, const __scheduler& __sched) {
+        return __sched.__wrap(stdexec::schedule(__sched.__select()));
+      }
+
+      friend std::chrono::time_point<std::chrono::steady_clock>
+        tag_invoke(exec::now_t, const __scheduler&) noexcept {
+        return std::chrono::steady_clock::now();
+      }
+
+      friend auto tag_invoke(
+        exec::schedule_after_t,
+        const __scheduler& __sched,
+        std::chrono::nanoseconds __duration) {
+        return __sched.__wrap(exec::schedule_after(__sched.__select(), __duration));
+      }
+
+      template <class _Clock, class _Duration>
+      friend auto tag_invoke(
+        exec::schedule_at_t,
+        const __scheduler& __sched,
+        const std::chrono::time_point<_Clock, _Duration>& __time_point) {
+        return __sched.__wrap(exec::schedule_at(__sched.__select(), __time_point));
+      }
+
+      template <
+        stdexec::__one_of<
+          async_read_t,
+          async_write_t,
+          async_writev_t,
+          async_poll_t,
+          async_read_direct_t,
+          async_write_direct_t,
+          async_send_zc_t,
+          async_splice_t,
+          async_tee_t,
+          async_openat_t,
+          async_statx_t,
+          async_close_t,
+          async_fsync_t,
+          async_fallocate_t,
+          async_fadvise_t,
+          async_renameat_t,
+          async_wait_signal_t,
+          async_eventfd_read_t,
+          async_eventfd_write_t> _Tag,
+        class... _Args>
+        requires stdexec::__callable<_Tag, io_uring_scheduler, _Args...>
+      friend auto tag_invoke(_Tag __tag, const __scheduler& __sched, _Args&&... __args) {
+        return __sched.__wrap(__tag(__sched.__select(), (_Args&&) __args...));
+      }
+    };
+
+    inline __pool::__scheduler __pool::get_scheduler() noexcept {
+      return __scheduler{this};
+    }
+  }
+
+  using io_uring_pool_params = __io_uring::__pool_params;
+  using io_uring_pool = __io_uring::__pool;
+  using io_uring_pool_scheduler = __io_uring::__pool::__scheduler;
+}
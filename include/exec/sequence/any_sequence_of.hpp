@@ -178,19 +178,24 @@ namespace exec {
           return *this;
         }
 
-        __immovable_operation_storage (*subscribe_)(void*, __receiver_ref_t);
+        __immovable_operation_storage (
+          *subscribe_)(void*, __receiver_ref_t, __operation_resource*);
 
         template <class _Sender>
           requires sequence_sender_to<_Sender, __receiver_ref_t>
         friend const __t* tag_invoke(__create_vtable_t, __mtype<__t>, __mtype<_Sender>) noexcept {
           static const __t __vtable_{
             {*__create_vtable(__mtype<__query_vtable_t>{}, __mtype<_Sender>{})},
-            [](void* __object_pointer, __receiver_ref_t __receiver)
-              -> __immovable_operation_storage {
+            [](void* __object_pointer,
+               __receiver_ref_t __receiver,
+               __operation_resource* __resource) -> __immovable_operation_storage {
               _Sender& __sender = *static_cast<_Sender*>(__object_pointer);
               using __op_state_t = subscribe_result_t<_Sender, __receiver_ref_t>;
               return __immovable_operation_storage{
-                std::in_place_type<__op_state_t>, __conv{[&] {
+                std::allocator_arg,
+                __operation_allocator<std::byte>{__resource},
+                std::in_place_type<__op_state_t>,
+                __conv{[&] {
                   return ::exec::subscribe(
                     static_cast<_Sender&&>(__sender), static_cast<__receiver_ref_t&&>(__receiver));
                 }}};
@@ -248,9 +253,10 @@ namespace exec {
           : __storage_{(_Sender&&) __sndr} {
         }
 
-        __immovable_operation_storage __connect(__receiver_ref_t __receiver) {
+        __immovable_operation_storage
+          __connect(__receiver_ref_t __receiver, __operation_resource* __resource) {
           return __storage_.__get_vtable()->subscribe_(
-            __storage_.__get_object_pointer(), __receiver);
+            __storage_.__get_object_pointer(), __receiver, __resource);
         }
 
         __unique_storage_t<__vtable_t> __storage_;
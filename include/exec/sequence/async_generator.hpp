@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../../stdexec/coroutine.hpp"
+#include "../../stdexec/execution.hpp"
+
+#include "../__detail/__frame_allocator.hpp"
+#include "../sequence_senders.hpp"
+
+#include <atomic>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace exec {
+  namespace __async_generator {
+    using namespace stdexec;
+
+    template <class _Ty>
+    struct __promise;
+
+    // The part of a subscription that the coroutine talks to. It does not depend on the type of
+    // the receiver, so that the coroutine frame does not either.
+    template <class _Ty>
+    struct __consumer {
+      // Hands a yielded value to the receiver and returns whether the coroutine stays suspended
+      bool (*__yield_)(__consumer*, _Ty*) noexcept;
+      // Completes the subscription after the coroutine has run to its end
+      void (*__complete_)(__consumer*, std::exception_ptr) noexcept;
+      // Completes the subscription after the coroutine has been stopped by an awaited sender
+      void (*__stopped_)(__consumer*) noexcept;
+      in_place_stop_token __stop_token_;
+    };
+
+    struct __env {
+      in_place_stop_token __stop_token_;
+
+      friend in_place_stop_token tag_invoke(get_stop_token_t, const __env& __self) noexcept {
+        return __self.__stop_token_;
+      }
+    };
+
+    template <class _Ty, class _Receiver>
+    struct __item_operation {
+      _Receiver __rcvr_;
+      _Ty* __value_;
+
+      friend void tag_invoke(start_t, __item_operation& __self) noexcept {
+        stdexec::set_value((_Receiver&&) __self.__rcvr_, (_Ty&&) *__self.__value_);
+      }
+    };
+
+    // Sends a yielded value. The value lives in the frame of the coroutine, which stays
+    // suspended until the sender that the receiver returned from set_next has completed.
+    template <class _Ty>
+    struct __item {
+      using is_sender = void;
+      using completion_signatures = stdexec::completion_signatures<set_value_t(_Ty)>;
+
+      _Ty* __value_;
+
+      template <receiver_of<completion_signatures> _Receiver>
+      friend __item_operation<_Ty, _Receiver>
+        tag_invoke(connect_t, __item __self, _Receiver __rcvr) noexcept(
+          __nothrow_decay_copyable<_Receiver>) {
+        return {(_Receiver&&) __rcvr, __self.__value_};
+      }
+    };
+
+    template <class _Ty, class _ReceiverId>
+    struct __operation;
+
+    template <class _Ty, class _ReceiverId>
+    struct __next_receiver {
+      using is_receiver = void;
+      using _Receiver = stdexec::__t<_ReceiverId>;
+      stdexec::__t<__operation<_Ty, _ReceiverId>>* __op_;
+
+      friend void tag_invoke(set_value_t, __next_receiver&& __self) noexcept {
+        __self.__op_->__next_completed_(false);
+      }
+
+      friend void tag_invoke(set_stopped_t, __next_receiver&& __self) noexcept {
+        __self.__op_->__next_completed_(true);
+      }
+
+      friend env_of_t<_Receiver> tag_invoke(get_env_t, const __next_receiver& __self) noexcept {
+        return stdexec::get_env(__self.__op_->__rcvr_);
+      }
+    };
+
+    struct __forward_stop_request {
+      in_place_stop_source& __stop_source_;
+
+      void operator()() noexcept {
+        __stop_source_.request_stop();
+      }
+    };
+
+    template <class _Ty, class _ReceiverId>
+    struct __operation {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t : __consumer<_Ty> {
+        using __next_receiver_t = __next_receiver<_Ty, _ReceiverId>;
+        using __next_operation_t =
+          connect_result_t<__next_sender_of_t<_Receiver, __item<_Ty>>, __next_receiver_t>;
+        using __stop_callback_t = typename stop_token_of_t<
+          env_of_t<_Receiver>>::template callback_type<__forward_stop_request>;
+
+        __coro::coroutine_handle<__promise<_Ty>> __coro_;
+        STDEXEC_NO_UNIQUE_ADDRESS _Receiver __rcvr_;
+        in_place_stop_source __stop_source_{};
+        std::optional<__stop_callback_t> __on_stop_{};
+        std::optional<__next_operation_t> __next_op_{};
+        // Set by whichever comes second of the yielding coroutine and the completion of the
+        // sender that was returned from set_next. That one continues the coroutine.
+        std::atomic<bool> __handshake_{false};
+        bool __break_{false};
+
+        static bool __yield(__consumer<_Ty>* __base, _Ty* __value) noexcept {
+          auto* __self = static_cast<__t*>(__base);
+          __self->__handshake_.store(false, std::memory_order_relaxed);
+          __self->__next_op_.reset();
+          try {
+            __self->__next_op_.emplace(__conv{[&] {
+              return stdexec::connect(
+                exec::set_next(__self->__rcvr_, __item<_Ty>{__value}), __next_receiver_t{__self});
+            }});
+          } catch (...) {
+            __self->__complete_with_(std::current_exception());
+            return true;
+          }
+          stdexec::start(*__self->__next_op_);
+          if (!__self->__handshake_.exchange(true, std::memory_order_acq_rel)) {
+            return true;
+          }
+          // The item has been consumed already, continue without suspending
+          if (__self->__break_) {
+            __self->__break_out_();
+            return true;
+          }
+          return false;
+        }
+
+        static void __complete(__consumer<_Ty>* __base, std::exception_ptr __eptr) noexcept {
+          static_cast<__t*>(__base)->__complete_with_((std::exception_ptr&&) __eptr);
+        }
+
+        static void __stopped(__consumer<_Ty>* __base) noexcept {
+          auto* __self = static_cast<__t*>(__base);
+          __self->__destroy_coro_();
+          stdexec::set_stopped((_Receiver&&) __self->__rcvr_);
+        }
+
+        void __next_completed_(bool __break) noexcept {
+          __break_ = __break;
+          if (__handshake_.exchange(true, std::memory_order_acq_rel)) {
+            if (__break_) {
+              __break_out_();
+            } else {
+              __coro_.resume();
+            }
+          }
+        }
+
+        void __destroy_coro_() noexcept {
+          __on_stop_.reset();
+          std::exchange(__coro_, {}).destroy();
+        }
+
+        void __complete_with_(std::exception_ptr __eptr) noexcept {
+          __destroy_coro_();
+          if (__eptr) {
+            stdexec::set_error((_Receiver&&) __rcvr_, (std::exception_ptr&&) __eptr);
+          } else {
+            stdexec::set_value((_Receiver&&) __rcvr_);
+          }
+        }
+
+        // The receiver does not want any more items. The sequence ends early, unless stop has
+        // been requested.
+        void __break_out_() noexcept {
+          __destroy_coro_();
+          auto __token = stdexec::get_stop_token(stdexec::get_env(__rcvr_));
+          if (__token.stop_requested()) {
+            stdexec::set_stopped((_Receiver&&) __rcvr_);
+          } else {
+            stdexec::set_value((_Receiver&&) __rcvr_);
+          }
+        }
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          __self.__on_stop_.emplace(
+            stdexec::get_stop_token(stdexec::get_env(__self.__rcvr_)),
+            __forward_stop_request{__self.__stop_source_});
+          __self.__coro_.promise().__consumer_ = &__self;
+          __self.__coro_.resume();
+        }
+
+        __t(__coro::coroutine_handle<__promise<_Ty>> __coro, _Receiver __rcvr) noexcept(
+          __nothrow_decay_copyable<_Receiver>)
+          : __consumer<_Ty>{&__yield, &__complete, &__stopped, {}}
+          , __coro_(__coro)
+          , __rcvr_((_Receiver&&) __rcvr) {
+          this->__stop_token_ = __stop_source_.get_token();
+        }
+
+        __t(__t&&) = delete;
+
+        ~__t() {
+          if (__coro_) {
+            __coro_.destroy();
+          }
+        }
+      };
+    };
+
+    template <class _Ty>
+    class async_generator;
+
+    template <class _Ty>
+    struct __promise
+      : with_awaitable_senders<__promise<_Ty>>
+      , __frame_allocator {
+      struct __yield_awaiter {
+        _Ty __value_;
+        __consumer<_Ty>* __consumer_;
+
+        static constexpr bool await_ready() noexcept {
+          return false;
+        }
+
+        bool await_suspend(__coro::coroutine_handle<>) noexcept {
+          return __consumer_->__yield_(__consumer_, &__value_);
+        }
+
+        static constexpr void await_resume() noexcept {
+        }
+      };
+
+      struct __final_awaiter {
+        static constexpr bool await_ready() noexcept {
+          return false;
+        }
+
+        static void await_suspend(__coro::coroutine_handle<__promise> __h) noexcept {
+          __promise& __self = __h.promise();
+          __self.__consumer_->__complete_(__self.__consumer_, std::move(__self.__exception_));
+        }
+
+        static constexpr void await_resume() noexcept {
+        }
+      };
+
+      __consumer<_Ty>* __consumer_ = nullptr;
+      std::exception_ptr __exception_{};
+
+      async_generator<_Ty> get_return_object() noexcept {
+        return async_generator<_Ty>{__coro::coroutine_handle<__promise>::from_promise(*this)};
+      }
+
+      __coro::suspend_always initial_suspend() noexcept {
+        return {};
+      }
+
+      __final_awaiter final_suspend() noexcept {
+        return {};
+      }
+
+      __yield_awaiter yield_value(_Ty __value) noexcept(__nothrow_decay_copyable<_Ty>) {
+        return {(_Ty&&) __value, __consumer_};
+      }
+
+      void return_void() noexcept {
+      }
+
+      void unhandled_exception() noexcept {
+        __exception_ = std::current_exception();
+      }
+
+      // An awaited sender has completed with set_stopped. The rest of the coroutine is skipped
+      // and the whole sequence completes with set_stopped.
+      __coro::coroutine_handle<> unhandled_stopped() noexcept {
+        __consumer_->__stopped_(__consumer_);
+        return __coro::noop_coroutine();
+      }
+
+      friend __env tag_invoke(get_env_t, const __promise& __self) noexcept {
+        return {__self.__consumer_->__stop_token_};
+      }
+    };
+
+    // A coroutine that produces its values with co_yield. It is a sequence sender: every value
+    // is passed to set_next of the subscribed receiver, and the coroutine is resumed only after
+    // the returned sender has completed. If that sender completes with set_stopped, the
+    // coroutine is destroyed and the sequence ends.
+    template <class _Ty>
+    class async_generator {
+     public:
+      using promise_type = __promise<_Ty>;
+      using is_sender = sequence_tag;
+      using completion_signatures = stdexec::completion_signatures<
+        set_value_t(_Ty),
+        set_error_t(std::exception_ptr),
+        set_stopped_t()>;
+
+      async_generator(async_generator&& __that) noexcept
+        : __coro_(std::exchange(__that.__coro_, {})) {
+      }
+
+      ~async_generator() {
+        if (__coro_) {
+          __coro_.destroy();
+        }
+      }
+
+     private:
+      friend promise_type;
+
+      explicit async_generator(__coro::coroutine_handle<promise_type> __coro) noexcept
+        : __coro_(__coro) {
+      }
+
+      template <class _Receiver>
+      using __operation_t = stdexec::__t<__operation<_Ty, stdexec::__id<_Receiver>>>;
+
+      template <receiver _Receiver>
+        requires sequence_receiver_of<_Receiver, completion_signatures>
+              && receiver_of<
+                   _Receiver,
+                   __sequence_completion_signatures_of_t<async_generator, env_of_t<_Receiver>>>
+      friend __operation_t<_Receiver>
+        tag_invoke(subscribe_t, async_generator&& __self, _Receiver __rcvr) noexcept(
+          __nothrow_decay_copyable<_Receiver>) {
+        return {std::exchange(__self.__coro_, {}), (_Receiver&&) __rcvr};
+      }
+
+      __coro::coroutine_handle<promise_type> __coro_;
+    };
+  } // namespace __async_generator
+
+  using __async_generator::async_generator;
+} // namespace exec
@@ -21,12 +21,14 @@
 #include "../stdexec/__detail/__intrusive_queue.hpp"
 #include "../stdexec/__detail/__meta.hpp"
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <exception>
 #include <mutex>
 #include <thread>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace exec {
@@ -448,6 +450,19 @@ namespace exec {
       return threadCount_;
     }
 
+    // Starts a batch on the calling thread. Until the matching end_batch(), the tasks that this
+    // thread schedules on the pool are collected instead of being enqueued one by one. Batches
+    // nest. While a batch of one pool is open, tasks of other pools are enqueued as usual.
+    //
+    // The collected tasks do not run before the outermost end_batch(). The calling thread must
+    // therefore not block on work that it schedules on the pool within its batch, e.g. with
+    // sync_wait. That would deadlock.
+    void begin_batch() noexcept;
+
+    // Ends the batch of the calling thread. The outermost end_batch() distributes the collected
+    // tasks over the threads of the pool with one push per thread.
+    void end_batch() noexcept;
+
    private:
     class thread_state {
      public:
@@ -455,6 +470,7 @@ namespace exec {
       task_base* pop();
       bool try_push(task_base* task);
       void push(task_base* task);
+      void push(__intrusive_queue<&task_base::next> tasks);
       void request_stop();
 
      private:
@@ -469,9 +485,21 @@ namespace exec {
 
     void enqueue(task_base* task) noexcept;
 
+    void enqueue_batch(__intrusive_queue<&task_base::next> tasks, std::uint32_t n_tasks) noexcept;
+
     template <std::derived_from<task_base> TaskT>
     void bulk_enqueue(TaskT* task, std::uint32_t n_threads) noexcept;
 
+    // The tasks of the current batch of the calling thread. Zero-initialized as thread_local.
+    struct batch {
+      static_thread_pool* pool_;
+      std::uint32_t depth_;
+      std::uint32_t size_;
+      __intrusive_queue<&task_base::next> tasks_;
+    };
+
+    static inline thread_local batch currentBatch_;
+
     std::uint32_t threadCount_;
     std::vector<std::thread> threads_;
     std::vector<thread_state> threadStates_;
@@ -573,7 +601,30 @@ namespace exec {
     threads_.clear();
   }
 
+  inline void static_thread_pool::begin_batch() noexcept {
+    if (currentBatch_.pool_ == nullptr) {
+      currentBatch_.pool_ = this;
+    }
+    if (currentBatch_.pool_ == this) {
+      ++currentBatch_.depth_;
+    }
+  }
+
+  inline void static_thread_pool::end_batch() noexcept {
+    if (currentBatch_.pool_ != this || --currentBatch_.depth_ != 0) {
+      return;
+    }
+    const std::uint32_t size = std::exchange(currentBatch_.size_, 0);
+    currentBatch_.pool_ = nullptr;
+    enqueue_batch(std::exchange(currentBatch_.tasks_, {}), size);
+  }
+
   inline void static_thread_pool::enqueue(task_base* task) noexcept {
+    if (currentBatch_.pool_ == this) {
+      currentBatch_.tasks_.push_back(task);
+      ++currentBatch_.size_;
+      return;
+    }
     const std::uint32_t threadCount = static_cast<std::uint32_t>(threads_.size());
     const std::uint32_t startIndex =
       nextThread_.fetch_add(1, std::memory_order_relaxed) % threadCount;
@@ -591,6 +642,28 @@ namespace exec {
     threadStates_[startIndex].push(task);
   }
 
+  inline void static_thread_pool::enqueue_batch(
+    __intrusive_queue<&task_base::next> tasks,
+    std::uint32_t n_tasks) noexcept {
+    if (n_tasks == 0) {
+      return;
+    }
+    const std::uint32_t threadCount = static_cast<std::uint32_t>(threads_.size());
+    const std::uint32_t n_chunks = std::min(threadCount, n_tasks);
+    const std::uint32_t startIndex =
+      nextThread_.fetch_add(n_chunks, std::memory_order_relaxed) % threadCount;
+
+    // Split the batch into one chunk per thread, such that all threads can pick up work.
+    for (std::uint32_t i = 0; i < n_chunks; ++i) {
+      __intrusive_queue<&task_base::next> chunk;
+      const std::uint32_t chunkSize = n_tasks / n_chunks + (i < n_tasks % n_chunks);
+      for (std::uint32_t j = 0; j < chunkSize; ++j) {
+        chunk.push_back(tasks.pop_front());
+      }
+      threadStates_[(startIndex + i) % threadCount].push(std::move(chunk));
+    }
+  }
+
   template <std::derived_from<task_base> TaskT>
   inline void static_thread_pool::bulk_enqueue(TaskT* task, std::uint32_t n_threads) noexcept {
     for (std::size_t i = 0; i < n_threads; ++i) {
@@ -639,6 +712,15 @@ namespace exec {
     }
   }
 
+  inline void static_thread_pool::thread_state::push(__intrusive_queue<&task_base::next> tasks) {
+    std::lock_guard lk{mut_};
+    const bool wasEmpty = queue_.empty();
+    queue_.append(std::move(tasks));
+    if (wasEmpty) {
+      cv_.notify_one();
+    }
+  }
+
   inline void static_thread_pool::thread_state::request_stop() {
     std::lock_guard lk{mut_};
     stopRequested_ = true;
@@ -25,10 +25,12 @@
 #include "../stdexec/execution.hpp"
 #include "../stdexec/__detail/__meta.hpp"
 
+#include "__detail/__frame_allocator.hpp"
 #include "any_sender_of.hpp"
 #include "at_coroutine_exit.hpp"
 #include "inline_scheduler.hpp"
 #include "scope.hpp"
+#include "variant_sender.hpp"
 
 STDEXEC_PRAGMA_PUSH()
 STDEXEC_PRAGMA_IGNORE("-Wundefined-inline")
@@ -312,6 +314,60 @@ namespace exec {
       }
     };
 
+    template <class _Tag, class _Sender, class _Scheduler>
+    concept __completion_scheduler_comparable_with = //
+      requires(const _Sender& __sndr, const _Scheduler& __sched) {
+        { get_completion_scheduler<_Tag>(get_env(__sndr)) == __sched } -> convertible_to<bool>;
+      };
+
+    template <class _Sender, class _Env>
+    concept __may_fail = //
+      !same_as<error_types_of_t<_Sender, _Env, __types>, __types<>>;
+
+    template <class _Sender>
+    using __value_completion_scheduler_t =
+      __call_result_t<get_completion_scheduler_t<set_value_t>, env_of_t<const _Sender&>>;
+
+    template <class _Sender>
+    concept __schedule_sender = //
+      __callable<get_completion_scheduler_t<set_value_t>, env_of_t<const _Sender&>>
+      && same_as<_Sender, __decay_t<schedule_result_t<__value_completion_scheduler_t<_Sender>>>>;
+
+    // Not every sender that reports a completion scheduler completes there. let_value, for
+    // instance, forwards the environment of its child but completes wherever the sender returned
+    // by its function does. The completion scheduler is trusted for the senders returned by
+    // schedule, and for then over such a sender.
+    template <class _SenderId>
+    inline constexpr bool __completion_scheduler_accurate_v =
+      __schedule_sender<stdexec::__t<_SenderId>>;
+
+    template <class _SenderId, class _Fun>
+    inline constexpr bool
+      __completion_scheduler_accurate_v<stdexec::__then::__sender<_SenderId, _Fun>> =
+        __completion_scheduler_accurate_v<_SenderId>;
+
+    // An awaited sender resumes the coroutine with its value and error completions. It is known
+    // at runtime whether they happen on a given scheduler if the sender reports the completion
+    // scheduler of both.
+    template <class _Sender, class _Env, class _Scheduler>
+    concept __completion_scheduler_known = //
+      __completion_scheduler_accurate_v<stdexec::__id<__decay_t<_Sender>>>
+      && __completion_scheduler_comparable_with<set_value_t, _Sender, _Scheduler>
+      && (!__may_fail<_Sender, _Env>
+          || __completion_scheduler_comparable_with<set_error_t, _Sender, _Scheduler>);
+
+    template <class _Env, class _Sender, class _Scheduler>
+      requires __completion_scheduler_known<_Sender, _Env, _Scheduler>
+    bool __completes_on(const _Sender& __sndr, const _Scheduler& __sched) noexcept {
+      auto&& __env = get_env(__sndr);
+      if constexpr (__may_fail<_Sender, _Env>) {
+        if (!(get_completion_scheduler_t<set_error_t>{}(__env) == __sched)) {
+          return false;
+        }
+      }
+      return get_completion_scheduler_t<set_value_t>{}(__env) == __sched;
+    }
+
     ////////////////////////////////////////////////////////////////////////////////
     // basic_task
     template <class _Ty, class _Context = default_task_context<_Ty>>
@@ -348,7 +404,8 @@ namespace exec {
 
       struct __promise
         : __promise_base<_Ty>
-        , with_awaitable_senders<__promise> {
+        , with_awaitable_senders<__promise>
+        , __frame_allocator {
         basic_task get_return_object() noexcept {
           return basic_task(__coro::coroutine_handle<__promise>::from_promise(*this));
         }
@@ -372,10 +429,20 @@ namespace exec {
         template <sender _Awaitable>
           requires __scheduler_provider<_Context>
         decltype(auto) await_transform(_Awaitable&& __awaitable) noexcept {
-          // TODO: If we have a complete-where-it-starts query then we can optimize
-          // this to avoid the reschedule
-          return as_awaitable(
-            transfer((_Awaitable&&) __awaitable, get_scheduler(__context_)), *this);
+          auto&& __sched = get_scheduler(__context_);
+          using __env_t = env_of_t<__promise>;
+          using __scheduler_t = __decay_t<decltype(__sched)>;
+          if constexpr (__completion_scheduler_known<_Awaitable, __env_t, __scheduler_t>) {
+            // Skip the transition back onto the scheduler if the sender completes there anyway
+            using __transfer_t = __call_result_t<transfer_t, _Awaitable, const __scheduler_t&>;
+            using __variant_t = variant_sender<_Awaitable, __transfer_t>;
+            if (__task::__completes_on<__env_t>(__awaitable, __sched)) {
+              return as_awaitable(__variant_t{(_Awaitable&&) __awaitable}, *this);
+            }
+            return as_awaitable(__variant_t{transfer((_Awaitable&&) __awaitable, __sched)}, *this);
+          } else {
+            return as_awaitable(transfer((_Awaitable&&) __awaitable, __sched), *this);
+          }
         }
 
         template <class _Scheduler>
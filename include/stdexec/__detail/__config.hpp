@@ -126,6 +126,15 @@
 #define STDEXEC_IMMOVABLE_NO_UNIQUE_ADDRESS [[no_unique_address]]
 #endif
 
+// BUG (gcc-12): -Wmismatched-new-delete fires when a coroutine frame that comes from a member
+// operator new template is freed with the usual operator delete of the same class. Inlining the
+// allocation function hides the call from the warning.
+#if STDEXEC_GCC()
+#define STDEXEC_INLINE_OPERATOR_NEW [[gnu::always_inline]]
+#else
+#define STDEXEC_INLINE_OPERATOR_NEW
+#endif
+
 #if STDEXEC_CLANG() && defined(__CUDACC__)
 #define STDEXEC_DETAIL_CUDACC_HOST_DEVICE __host__ __device__
 #else
@@ -0,0 +1,143 @@
+#include <catch2/catch.hpp>
+#include <exec/bounded_async_scope.hpp>
+#include <exec/static_thread_pool.hpp>
+#include "test_common/schedulers.hpp"
+#include "test_common/receivers.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace ex = stdexec;
+using exec::bounded_async_scope;
+using stdexec::sync_wait;
+
+TEST_CASE("bounded_async_scope admits spawned work in FIFO order", "[async_scope][bounded]") {
+  impulse_scheduler sch;
+  bounded_async_scope scope{2};
+  REQUIRE(scope.max_active() == 2);
+  std::vector<int> started;
+  std::vector<int> completed;
+  for (int i = 0; i < 5; ++i) {
+    scope.spawn(
+      ex::just() | ex::then([&, i] { started.push_back(i); })
+      | ex::let_value([&, i] {
+          return ex::schedule(sch) | ex::then([&, i] { completed.push_back(i); });
+        }));
+  }
+  // Only the first two are running, the others wait for a slot
+  REQUIRE(started == std::vector{0, 1});
+  sch.start_next();
+  REQUIRE(completed == std::vector{0});
+  REQUIRE(started == std::vector{0, 1, 2});
+  for (int i = 0; i < 4; ++i) {
+    sch.start_next();
+  }
+  REQUIRE(started == std::vector{0, 1, 2, 3, 4});
+  REQUIRE(completed == std::vector{0, 1, 2, 3, 4});
+  sync_wait(scope.on_empty());
+}
+
+TEST_CASE("bounded_async_scope on_empty waits for queued work", "[async_scope][bounded]") {
+  impulse_scheduler sch;
+  bounded_async_scope scope{1};
+  int n_completed = 0;
+  for (int i = 0; i < 3; ++i) {
+    scope.spawn(ex::on(sch, ex::just()) | ex::then([&] { ++n_completed; }));
+  }
+  bool is_empty{false};
+  auto op = ex::connect(
+    scope.on_empty() | ex::then([&] { is_empty = true; }), expect_void_receiver{});
+  ex::start(op);
+  for (int i = 0; i < 3; ++i) {
+    REQUIRE_FALSE(is_empty);
+    sch.start_next();
+  }
+  REQUIRE(n_completed == 3);
+  REQUIRE(is_empty);
+}
+
+TEST_CASE("bounded_async_scope limits the number of nested operations", "[async_scope][bounded]") {
+  exec::static_thread_pool pool{4};
+  bounded_async_scope scope{3};
+  std::atomic<int> n_active{0};
+  std::atomic<int> max_active{0};
+  auto work = [&] {
+    const int n = ++n_active;
+    int max = max_active.load();
+    while (n > max && !max_active.compare_exchange_weak(max, n)) {
+    }
+    --n_active;
+  };
+  auto nested = [&] {
+    return scope.nest(ex::schedule(pool.get_scheduler()) | ex::then(work));
+  };
+  sync_wait(ex::when_all(nested(), nested(), nested(), nested(), nested(), nested(), nested()));
+  REQUIRE(max_active.load() <= 3);
+  sync_wait(scope.on_empty());
+}
+
+TEST_CASE("bounded_async_scope async_spawn throttles the producer", "[async_scope][bounded]") {
+  impulse_scheduler sch;
+  bounded_async_scope scope{1};
+  int n_completed = 0;
+  auto first = scope.async_spawn(ex::on(sch, ex::just()) | ex::then([&] { ++n_completed; }));
+  REQUIRE(sync_wait(std::move(first)).has_value());
+
+  bool admitted{false};
+  auto second = scope.async_spawn(ex::on(sch, ex::just()) | ex::then([&] { ++n_completed; }))
+              | ex::then([&] { admitted = true; });
+  auto op = ex::connect(std::move(second), expect_void_receiver{});
+  ex::start(op);
+  // The producer waits until the first operation has completed
+  REQUIRE_FALSE(admitted);
+  sch.start_next();
+  REQUIRE(admitted);
+  sch.start_next();
+  REQUIRE(n_completed == 2);
+  sync_wait(scope.on_empty());
+}
+
+TEST_CASE("bounded_async_scope admits a long queue without recursion", "[async_scope][bounded]") {
+  impulse_scheduler sch;
+  bounded_async_scope scope{1};
+  int n_completed = 0;
+  scope.spawn(ex::on(sch, ex::just()));
+  for (int i = 0; i < 100'000; ++i) {
+    scope.spawn(ex::just() | ex::then([&] { ++n_completed; }));
+  }
+  REQUIRE(n_completed == 0);
+  sch.start_next();
+  REQUIRE(n_completed == 100'000);
+  sync_wait(scope.on_empty());
+}
+
+TEST_CASE("bounded_async_scope admitted work may block on other scopes", "[async_scope][bounded]") {
+  bounded_async_scope a{1};
+  bounded_async_scope b{1};
+  bool completed = false;
+  a.spawn(ex::just() | ex::then([&] {
+            sync_wait(b.nest(ex::just()));
+            completed = true;
+          }));
+  REQUIRE(completed);
+  sync_wait(a.on_empty());
+  sync_wait(b.on_empty());
+}
+
+TEST_CASE("bounded_async_scope completes before admitting a waiter", "[async_scope][bounded]") {
+  impulse_scheduler sch;
+  bounded_async_scope scope{1};
+  std::vector<int> order;
+  auto op = ex::connect(
+    scope.nest(ex::on(sch, ex::just())) | ex::then([&] { order.push_back(-1); }),
+    expect_void_receiver{});
+  ex::start(op);
+  for (int i = 0; i < 3; ++i) {
+    scope.spawn(ex::just() | ex::then([&, i] { order.push_back(i); }));
+  }
+  REQUIRE(order.empty());
+  sch.start_next();
+  REQUIRE(order == std::vector{-1, 0, 1, 2});
+  sync_wait(scope.on_empty());
+}
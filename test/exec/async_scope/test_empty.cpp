@@ -1,8 +1,13 @@
 #include <catch2/catch.hpp>
 #include <exec/async_scope.hpp>
+#include <exec/static_thread_pool.hpp>
 #include "test_common/schedulers.hpp"
 #include "test_common/receivers.hpp"
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 namespace ex = stdexec;
 using exec::async_scope;
 using stdexec::sync_wait;
@@ -173,3 +178,29 @@ TEST_CASE(
   REQUIRE(is_empty2);
 }
 #endif
+
+TEST_CASE(
+  "empty completes after work that is spawned from many threads",
+  "[async_scope][empty]") {
+  exec::static_thread_pool pool{4};
+  constexpr int n_threads = 4;
+  constexpr int n_tasks = 1000;
+  for (int round = 0; round < 20; ++round) {
+    std::atomic<int> n_completed{0};
+    // The scope is destroyed right after it has been observed empty
+    async_scope scope;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < n_threads; ++i) {
+      threads.emplace_back([&] {
+        for (int j = 0; j < n_tasks; ++j) {
+          scope.spawn(ex::schedule(pool.get_scheduler()) | ex::then([&] { ++n_completed; }));
+        }
+      });
+    }
+    for (std::thread& thread: threads) {
+      thread.join();
+    }
+    sync_wait(scope.on_empty());
+    REQUIRE(n_completed.load() == n_threads * n_tasks);
+  }
+}
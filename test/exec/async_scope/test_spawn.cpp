@@ -3,6 +3,7 @@
 #include "test_common/schedulers.hpp"
 #include "test_common/receivers.hpp"
 #include "test_common/type_helpers.hpp"
+#include "test_common/allocators.hpp"
 
 namespace ex = stdexec;
 using exec::async_scope;
@@ -231,3 +232,35 @@ TEST_CASE(
   // TODO: reenable this
   // REQUIRE(P2519::__scope::empty(scope));
 }
+
+TEST_CASE("spawn allocates with the allocator of the environment", "[async_scope][spawn]") {
+  impulse_scheduler sch;
+  allocation_counts counts{};
+  async_scope scope;
+  bool executed{false};
+  scope.spawn(
+    ex::on(sch, ex::just() | ex::then([&] { executed = true; })),
+    counting_allocator_env{&counts});
+  REQUIRE(counts.n_allocations == 1);
+  REQUIRE(counts.n_deallocations == 0);
+  sch.start_next();
+  REQUIRE(executed);
+  REQUIRE(counts.n_deallocations == 1);
+  sync_wait(scope.on_empty());
+}
+
+TEST_CASE("spawn allocates with an explicit allocator", "[async_scope][spawn]") {
+  allocation_counts counts{};
+  async_scope scope;
+  bool has_allocator{false};
+  // The allocator is also visible to the spawned sender
+  scope.spawn(
+    std::allocator_arg,
+    counting_allocator<int>{counts},
+    ex::read(ex::get_allocator)
+      | ex::then([&](auto alloc) { has_allocator = alloc.counts == &counts; }));
+  REQUIRE(has_allocator);
+  REQUIRE(counts.n_allocations == 1);
+  REQUIRE(counts.n_deallocations == 1);
+  sync_wait(scope.on_empty());
+}
@@ -1,8 +1,10 @@
 #include <catch2/catch.hpp>
 #include <exec/async_scope.hpp>
 #include <exec/env.hpp>
+#include <exec/static_thread_pool.hpp>
 #include "test_common/schedulers.hpp"
 #include "test_common/receivers.hpp"
+#include "test_common/allocators.hpp"
 #include "test_common/type_helpers.hpp"
 
 namespace ex = stdexec;
@@ -440,3 +442,58 @@ TEST_CASE(
   // ex::start(op);
   expect_empty(scope);
 }
+
+TEST_CASE(
+  "spawn_future allocates with the allocator of the environment",
+  "[async_scope][spawn_future]") {
+  impulse_scheduler sch;
+  allocation_counts counts{};
+  async_scope scope;
+  {
+    ex::sender auto snd =
+      scope.spawn_future(ex::on(sch, ex::just(42)), counting_allocator_env{&counts});
+    REQUIRE(counts.n_allocations == 1);
+    sch.start_next();
+    auto [value] = sync_wait(std::move(snd)).value();
+    REQUIRE(value == 42);
+  }
+  REQUIRE(counts.n_deallocations == 1);
+  // The shared state is released through the allocator when the future is dropped
+  (void) scope.spawn_future(ex::on(sch, ex::just()), counting_allocator_env{&counts});
+  REQUIRE(counts.n_allocations == 2);
+  REQUIRE(counts.n_deallocations == 1);
+  sch.start_next();
+  REQUIRE(counts.n_deallocations == 2);
+  expect_empty(scope);
+}
+
+TEST_CASE("spawn_future allocates with an explicit allocator", "[async_scope][spawn_future]") {
+  allocation_counts counts{};
+  async_scope scope;
+  {
+    ex::sender auto snd =
+      scope.spawn_future(std::allocator_arg, counting_allocator<int>{counts}, ex::just(42));
+    REQUIRE(counts.n_allocations == 1);
+    auto [value] = sync_wait(std::move(snd)).value();
+    REQUIRE(value == 42);
+  }
+  REQUIRE(counts.n_deallocations == 1);
+  expect_empty(scope);
+}
+
+TEST_CASE(
+  "spawn_future hands over results that race with the consumer",
+  "[async_scope][spawn_future]") {
+  exec::static_thread_pool pool{2};
+  async_scope scope;
+  for (int i = 0; i < 1000; ++i) {
+    auto work = ex::schedule(pool.get_scheduler()) | ex::then([i] { return i; });
+    ex::sender auto snd = scope.spawn_future(std::move(work));
+    if (i % 2 == 0) {
+      auto [value] = sync_wait(std::move(snd)).value();
+      REQUIRE(value == i);
+    }
+    // The odd futures are dropped while the spawned work might still be running
+  }
+  sync_wait(scope.on_empty());
+}
@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdexec/coroutine.hpp>
+
+#if !STDEXEC_STD_NO_COROUTINES_
+#include "exec/sequence/async_generator.hpp"
+#include "exec/sequence/ignore_all_values.hpp"
+#include "exec/static_thread_pool.hpp"
+#include "exec/variant_sender.hpp"
+
+#include <catch2/catch.hpp>
+#include "test_common/schedulers.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+  exec::async_generator<int> iota(int n) {
+    for (int i = 0; i < n; ++i) {
+      co_yield i;
+    }
+  }
+
+  template <class Receiver>
+  struct collect_item_receiver {
+    using is_receiver = void;
+    Receiver rcvr;
+    std::vector<int>* values;
+    std::size_t limit;
+
+    friend stdexec::env_of_t<Receiver>
+      tag_invoke(stdexec::get_env_t, const collect_item_receiver& self) noexcept {
+      return stdexec::get_env(self.rcvr);
+    }
+
+    friend void tag_invoke(stdexec::set_value_t, collect_item_receiver&& self, int value) noexcept {
+      self.values->push_back(value);
+      if (self.values->size() < self.limit) {
+        stdexec::set_value(static_cast<Receiver&&>(self.rcvr));
+      } else {
+        stdexec::set_stopped(static_cast<Receiver&&>(self.rcvr));
+      }
+    }
+  };
+
+  // Collects the items and asks for no more items once it has got limit many
+  template <class Item>
+  struct collect_sender {
+    using is_sender = void;
+    using completion_signatures =
+      stdexec::completion_signatures<stdexec::set_value_t(), stdexec::set_stopped_t()>;
+
+    Item item;
+    std::vector<int>* values;
+    std::size_t limit;
+
+    template <stdexec::receiver_of<completion_signatures> Receiver>
+    friend auto tag_invoke(stdexec::connect_t, collect_sender&& self, Receiver rcvr) {
+      return stdexec::connect(
+        static_cast<Item&&>(self.item),
+        collect_item_receiver<Receiver>{static_cast<Receiver&&>(rcvr), self.values, self.limit});
+    }
+  };
+
+  struct stop_token_env {
+    stdexec::in_place_stop_token stop_token;
+
+    friend stdexec::in_place_stop_token
+      tag_invoke(stdexec::get_stop_token_t, const stop_token_env& self) noexcept {
+      return self.stop_token;
+    }
+  };
+
+  struct collect_receiver {
+    using is_receiver = void;
+    std::vector<int>* values;
+    std::size_t limit = static_cast<std::size_t>(-1);
+    std::exception_ptr* error = nullptr;
+    bool* completed = nullptr;
+    bool* stopped = nullptr;
+    stdexec::in_place_stop_token stop_token{};
+
+    template <class Item>
+    friend collect_sender<stdexec::__decay_t<Item>>
+      tag_invoke(exec::set_next_t, collect_receiver& self, Item&& item) noexcept {
+      return {static_cast<Item&&>(item), self.values, self.limit};
+    }
+
+    friend void tag_invoke(stdexec::set_value_t, collect_receiver&& self) noexcept {
+      *self.completed = true;
+    }
+
+    friend void tag_invoke(stdexec::set_stopped_t, collect_receiver&& self) noexcept {
+      if (self.stopped == nullptr) {
+        FAIL("the sequence has not been stopped");
+      }
+      *self.stopped = true;
+    }
+
+    friend void
+      tag_invoke(stdexec::set_error_t, collect_receiver&& self, std::exception_ptr eptr) noexcept {
+      *self.error = eptr;
+      *self.completed = true;
+    }
+
+    friend stop_token_env tag_invoke(stdexec::get_env_t, const collect_receiver& self) noexcept {
+      return {self.stop_token};
+    }
+  };
+
+  // The completion of a subscription that completes on another thread
+  struct async_outcome {
+    std::vector<int> values;
+    bool stopped = false;
+    bool failed = false;
+    std::atomic<bool> done{false};
+
+    void wait() {
+      done.wait(false);
+    }
+  };
+
+  // The sender returned from set_next completes on a thread of the pool, with set_stopped once
+  // the receiver has got limit many items.
+  struct pool_receiver {
+    using is_receiver = void;
+    exec::static_thread_pool* pool;
+    async_outcome* outcome;
+    std::size_t limit = static_cast<std::size_t>(-1);
+
+    using continue_t =
+      exec::variant_sender<decltype(stdexec::just()), decltype(stdexec::just_stopped())>;
+
+    // The items do not fail, but the senders from set_next must not complete with an error
+    template <class Item>
+    friend auto tag_invoke(exec::set_next_t, pool_receiver& self, Item&& item) noexcept {
+      return stdexec::let_value(
+               static_cast<Item&&>(item),
+               [self](int value) {
+                 self.outcome->values.push_back(value);
+                 const bool stop = self.outcome->values.size() >= self.limit;
+                 return stdexec::schedule(self.pool->get_scheduler()) | stdexec::let_value([stop] {
+                          return stop ? continue_t{stdexec::just_stopped()}
+                                      : continue_t{stdexec::just()};
+                        });
+               })
+           | stdexec::upon_error([outcome = self.outcome](auto&&) noexcept {
+               outcome->failed = true;
+             });
+    }
+
+    void complete(bool stopped, bool failed) noexcept {
+      outcome->stopped = stopped;
+      outcome->failed = outcome->failed || failed;
+      outcome->done = true;
+      outcome->done.notify_one();
+    }
+
+    friend void tag_invoke(stdexec::set_value_t, pool_receiver&& self) noexcept {
+      self.complete(false, false);
+    }
+
+    friend void tag_invoke(stdexec::set_stopped_t, pool_receiver&& self) noexcept {
+      self.complete(true, false);
+    }
+
+    friend void
+      tag_invoke(stdexec::set_error_t, pool_receiver&& self, std::exception_ptr) noexcept {
+      self.complete(false, true);
+    }
+
+    friend stdexec::empty_env tag_invoke(stdexec::get_env_t, const pool_receiver&) noexcept {
+      return {};
+    }
+  };
+}
+
+TEST_CASE("async_generator - is a sequence sender", "[sequence_senders][async_generator]") {
+  using generator_t = exec::async_generator<int>;
+  STATIC_REQUIRE(exec::sequence_sender<generator_t>);
+  STATIC_REQUIRE(exec::sequence_sender_to<generator_t, collect_receiver>);
+}
+
+TEST_CASE("async_generator - yields every value", "[sequence_senders][async_generator]") {
+  std::vector<int> values;
+  bool completed = false;
+  auto op = exec::subscribe(iota(5), collect_receiver{&values, 100, nullptr, &completed});
+  CHECK(values.empty());
+  stdexec::start(op);
+  CHECK(completed);
+  CHECK(values == std::vector{0, 1, 2, 3, 4});
+}
+
+TEST_CASE(
+  "async_generator - a stopped item ends the sequence",
+  "[sequence_senders][async_generator]") {
+  std::vector<int> values;
+  bool completed = false;
+  bool destroyed = false;
+  auto generator = [](bool& destroyed) -> exec::async_generator<int> {
+    struct on_exit {
+      bool& destroyed;
+
+      ~on_exit() {
+        destroyed = true;
+      }
+    } guard{destroyed};
+    for (int i = 0;; ++i) {
+      co_yield i;
+    }
+  };
+  auto op =
+    exec::subscribe(generator(destroyed), collect_receiver{&values, 3, nullptr, &completed});
+  stdexec::start(op);
+  CHECK(completed);
+  CHECK(destroyed);
+  CHECK(values == std::vector{0, 1, 2});
+}
+
+TEST_CASE("async_generator - forwards exceptions", "[sequence_senders][async_generator]") {
+  std::vector<int> values;
+  std::exception_ptr error;
+  bool completed = false;
+  auto generator = []() -> exec::async_generator<int> {
+    co_yield 1;
+    throw std::runtime_error("test");
+  };
+  auto op = exec::subscribe(generator(), collect_receiver{&values, 100, &error, &completed});
+  stdexec::start(op);
+  CHECK(completed);
+  CHECK(values == std::vector{1});
+  CHECK_THROWS_AS(std::rethrow_exception(error), std::runtime_error);
+}
+
+TEST_CASE(
+  "async_generator - awaits senders between values",
+  "[sequence_senders][async_generator]") {
+  exec::static_thread_pool pool{2};
+  std::vector<int> values;
+  auto generator = [](auto sched, std::vector<int>& values) -> exec::async_generator<int> {
+    for (int i = 0; i < 100; ++i) {
+      int value = co_await (stdexec::schedule(sched) | stdexec::then([i] { return i * 2; }));
+      values.push_back(value);
+      co_yield value;
+    }
+  };
+  CHECK(stdexec::sync_wait(exec::ignore_all_values(generator(pool.get_scheduler(), values))));
+  REQUIRE(values.size() == 100);
+  CHECK(values.back() == 198);
+}
+
+TEST_CASE("async_generator - works with ignore_all_values", "[sequence_senders][async_generator]") {
+  CHECK(stdexec::sync_wait(exec::ignore_all_values(iota(100'000))));
+}
+#endif
+
+TEST_CASE(
+  "async_generator - items are consumed on another thread",
+  "[sequence_senders][async_generator]") {
+  exec::static_thread_pool pool{2};
+  async_outcome outcome;
+  auto op = exec::subscribe(iota(100), pool_receiver{&pool, &outcome});
+  stdexec::start(op);
+  outcome.wait();
+  CHECK_FALSE(outcome.stopped);
+  CHECK_FALSE(outcome.failed);
+  REQUIRE(outcome.values.size() == 100);
+  CHECK(outcome.values.back() == 99);
+}
+
+TEST_CASE(
+  "async_generator - a stopped item from another thread ends the sequence",
+  "[sequence_senders][async_generator]") {
+  exec::static_thread_pool pool{2};
+  async_outcome outcome;
+  bool destroyed = false;
+  auto generator = [](bool& destroyed) -> exec::async_generator<int> {
+    struct on_exit {
+      bool& destroyed;
+
+      ~on_exit() {
+        destroyed = true;
+      }
+    } guard{destroyed};
+    for (int i = 0;; ++i) {
+      co_yield i;
+    }
+  };
+  auto op = exec::subscribe(generator(destroyed), pool_receiver{&pool, &outcome, 3});
+  stdexec::start(op);
+  outcome.wait();
+  CHECK_FALSE(outcome.stopped);
+  CHECK_FALSE(outcome.failed);
+  CHECK(destroyed);
+  CHECK(outcome.values == std::vector{0, 1, 2});
+}
+
+TEST_CASE(
+  "async_generator - a stopped awaited sender stops the sequence",
+  "[sequence_senders][async_generator]") {
+  exec::static_thread_pool pool{2};
+  async_outcome outcome;
+  auto generator = [](auto sched) -> exec::async_generator<int> {
+    co_yield 1;
+    // Completes with set_stopped on a thread of the pool
+    co_await (stdexec::schedule(sched) | stdexec::let_value([] {
+                return pool_receiver::continue_t{stdexec::just_stopped()};
+              }));
+    co_yield 2;
+  };
+  auto op = exec::subscribe(generator(pool.get_scheduler()), pool_receiver{&pool, &outcome});
+  stdexec::start(op);
+  outcome.wait();
+  CHECK(outcome.stopped);
+  CHECK_FALSE(outcome.failed);
+  CHECK(outcome.values == std::vector{1});
+}
+
+TEST_CASE(
+  "async_generator - forwards a stop request to an awaited sender",
+  "[sequence_senders][async_generator]") {
+  impulse_scheduler sched;
+  stdexec::in_place_stop_source stop_source;
+  std::vector<int> values;
+  bool completed = false;
+  bool stopped = false;
+  auto generator = [](impulse_scheduler sched) -> exec::async_generator<int> {
+    co_yield 1;
+    co_await stdexec::schedule(sched);
+    co_yield 2;
+  };
+  auto op = exec::subscribe(
+    generator(sched),
+    collect_receiver{&values, 100, nullptr, &completed, &stopped, stop_source.get_token()});
+  stdexec::start(op);
+  // The generator is suspended in co_await
+  CHECK(values == std::vector{1});
+  stop_source.request_stop();
+  sched.start_next();
+  CHECK(stopped);
+  CHECK_FALSE(completed);
+  CHECK(values == std::vector{1});
+}
@@ -19,11 +19,15 @@
 #include <exec/when_any.hpp>
 #include <exec/static_thread_pool.hpp>
 
+#include <test_common/allocators.hpp>
 #include <test_common/schedulers.hpp>
 #include <test_common/receivers.hpp>
 
 #include <catch2/catch.hpp>
 
+#include <array>
+#include <atomic>
+
 
 using namespace stdexec;
 using namespace exec;
@@ -470,6 +474,70 @@ TEST_CASE(
   start(do_check);
 }
 
+struct allocator_receiver {
+  using is_receiver = void;
+  int* value;
+  counting_allocator_env env;
+
+  friend void tag_invoke(set_value_t, allocator_receiver&& self, int value) noexcept {
+    *self.value = value;
+  }
+
+  friend void tag_invoke(set_stopped_t, allocator_receiver&&) noexcept {
+  }
+
+  friend counting_allocator_env
+    tag_invoke(get_env_t, const allocator_receiver& self) noexcept {
+    return self.env;
+  }
+};
+
+template <std::size_t InlineSize, class... Ts>
+using inline_any_sender_of = typename any_receiver_ref<
+  completion_signatures<Ts...>>::template basic_any_sender<InlineSize>;
+
+auto make_large_sender() {
+  return just(21) | then([padding = std::array<char, 128>{}](int value) noexcept {
+           return value + value + padding[0];
+         });
+}
+
+TEST_CASE(
+  "any_sender allocates large operation states with the receiver's allocator",
+  "[types][any_sender]") {
+  int value = 0;
+  allocation_counts counts{};
+  counting_allocator_env env{&counts};
+  {
+    any_sender_of<set_value_t(int), set_stopped_t()> sender = make_large_sender();
+    auto op = connect(std::move(sender), allocator_receiver{&value, env});
+    CHECK(counts.n_allocations == 1);
+    start(op);
+  }
+  CHECK(value == 42);
+  CHECK(counts.n_deallocations == 1);
+}
+
+TEST_CASE(
+  "any_sender with a large inline size does not allocate operation states",
+  "[types][any_sender]") {
+  int value = 0;
+  allocation_counts counts{};
+  counting_allocator_env env{&counts};
+  using sender_t = inline_any_sender_of<512, set_value_t(int), set_stopped_t()>;
+  STATIC_REQUIRE(sender<sender_t>);
+  for (int i = 0; i < 3; ++i) {
+    sender_t sender = make_large_sender();
+    auto op = connect(std::move(sender), allocator_receiver{&value, env});
+    start(op);
+  }
+  CHECK(value == 42);
+  CHECK(counts.n_allocations == 0);
+  CHECK(counts.n_deallocations == 0);
+  sender_t sender = make_large_sender();
+  CHECK(sync_wait(std::move(sender)) == std::tuple{42});
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //                                                                any_scheduler
 
@@ -596,6 +664,60 @@ TEST_CASE("queryable any_scheduler with static_thread_pool", "[types][any_sender
   CHECK(called);
 }
 
+struct allocator_schedule_receiver {
+  using is_receiver = void;
+  std::atomic<bool>* done;
+  counting_allocator_env env;
+
+  friend void tag_invoke(set_value_t, allocator_schedule_receiver&& self) noexcept {
+    self.done->store(true);
+    self.done->notify_one();
+  }
+
+  friend void
+    tag_invoke(set_error_t, allocator_schedule_receiver&& self, std::exception_ptr) noexcept {
+    tag_invoke(set_value, (allocator_schedule_receiver&&) self);
+  }
+
+  friend void tag_invoke(set_stopped_t, allocator_schedule_receiver&& self) noexcept {
+    tag_invoke(set_value, (allocator_schedule_receiver&&) self);
+  }
+
+  friend counting_allocator_env
+    tag_invoke(get_env_t, const allocator_schedule_receiver& self) noexcept {
+    return self.env;
+  }
+};
+
+TEST_CASE(
+  "any_scheduler constructs schedule operations in place",
+  "[types][any_scheduler][any_sender]") {
+  allocation_counts counts{};
+  counting_allocator_env env{&counts};
+  using scheduler_t =
+    any_sender_of<set_error_t(std::exception_ptr), set_stopped_t()>::any_scheduler<>;
+  SECTION("run_loop") {
+    run_loop loop;
+    scheduler_t scheduler = loop.get_scheduler();
+    std::atomic<bool> done{false};
+    auto op = connect(schedule(scheduler), allocator_schedule_receiver{&done, env});
+    start(op);
+    loop.finish();
+    loop.run();
+    CHECK(done.load());
+  }
+  SECTION("static_thread_pool") {
+    exec::static_thread_pool pool{1};
+    scheduler_t scheduler = pool.get_scheduler();
+    std::atomic<bool> done{false};
+    auto op = connect(schedule(scheduler), allocator_schedule_receiver{&done, env});
+    start(op);
+    done.wait(false);
+  }
+  CHECK(counts.n_allocations == 0);
+  CHECK(counts.n_deallocations == 0);
+}
+
 TEST_CASE("Scheduler with error handling and set_stopped", "[types][any_scheduler][any_sender]") {
   using receiver_ref =
     any_receiver_ref<completion_signatures<set_stopped_t(), set_error_t(std::exception_ptr)>>;
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2023 Maikel Nadolski
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if __has_include(<linux/io_uring.h>)
+#include "exec/linux/async_read_chunks.hpp"
+#include "exec/linux/io_uring_context.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <sys/mman.h>
+
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <thread>
+
+using namespace stdexec;
+using namespace exec;
+
+namespace {
+  safe_file_descriptor make_temporary_file(const std::string& content) {
+    safe_file_descriptor file{::memfd_create("test_async_read_chunks", 0)};
+    REQUIRE(::pwrite(file, content.data(), content.size(), 0) == ::ssize_t(content.size()));
+    return file;
+  }
+
+  std::string make_content(std::size_t size) {
+    std::string content(size, '\0');
+    for (std::size_t i = 0; i < size; ++i) {
+      content[i] = static_cast<char>('a' + (i * 7) % 26);
+    }
+    return content;
+  }
+
+  // Drives an io_uring_context on a separate thread for the lifetime of this object
+  struct io_thread {
+    io_uring_context& context;
+    std::thread thread{[this] {
+      context.run_until_stopped();
+    }};
+
+    ~io_thread() {
+      context.request_stop();
+      thread.join();
+    }
+  };
+
+  enum class result_t {
+    none,
+    value,
+    error,
+    stopped
+  };
+
+  struct collector {
+    std::string data{};
+    std::size_t n_items{0};
+    std::size_t stop_after{~std::size_t{0}};
+    in_place_stop_source stop_source{};
+    std::atomic<result_t> result{result_t::none};
+
+    result_t wait() {
+      result.wait(result_t::none);
+      return result.load();
+    }
+  };
+
+  struct collecting_env {
+    collector* state;
+
+    friend in_place_stop_token tag_invoke(get_stop_token_t, const collecting_env& env) noexcept {
+      return env.state->stop_source.get_token();
+    }
+  };
+
+  struct collecting_receiver {
+    using is_receiver = void;
+    collector* state;
+
+    template <class Item>
+    friend auto tag_invoke(set_next_t, collecting_receiver& self, Item&& item) noexcept {
+      return (Item&&) item | then([state = self.state](std::span<const std::byte> chunk) noexcept {
+               state->data.append(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+               if (++state->n_items == state->stop_after) {
+                 state->stop_source.request_stop();
+               }
+             });
+    }
+
+    void complete(result_t result) noexcept {
+      state->result.store(result);
+      state->result.notify_all();
+    }
+
+    friend void tag_invoke(set_value_t, collecting_receiver&& self) noexcept {
+      self.complete(result_t::value);
+    }
+
+    friend void tag_invoke(set_error_t, collecting_receiver&& self, std::exception_ptr) noexcept {
+      self.complete(result_t::error);
+    }
+
+    friend void tag_invoke(set_stopped_t, collecting_receiver&& self) noexcept {
+      self.complete(result_t::stopped);
+    }
+
+    friend collecting_env tag_invoke(get_env_t, const collecting_receiver& self) noexcept {
+      return {self.state};
+    }
+  };
+
+  // Frees the operation on completion, so that the operation must not touch itself afterwards
+  struct heap_op_receiver : collecting_receiver {
+    std::function<void()> free_op;
+
+    void complete(result_t result) noexcept {
+      collecting_receiver last = *this;
+      std::function<void()> free = std::move(free_op);
+      free();
+      last.complete(result);
+    }
+
+    friend void tag_invoke(set_value_t, heap_op_receiver&& self) noexcept {
+      self.complete(result_t::value);
+    }
+
+    friend void tag_invoke(set_error_t, heap_op_receiver&& self, std::exception_ptr) noexcept {
+      self.complete(result_t::error);
+    }
+
+    friend void tag_invoke(set_stopped_t, heap_op_receiver&& self) noexcept {
+      self.complete(result_t::stopped);
+    }
+  };
+
+  template <class Sequence>
+  result_t read_all(Sequence&& sequence, collector& state) {
+    auto op = exec::subscribe((Sequence&&) sequence, collecting_receiver{&state});
+    stdexec::start(op);
+    return state.wait();
+  }
+}
+
+TEST_CASE("async_read_chunks reads a file in order", "[types][io_uring][async_read_chunks]") {
+  io_uring_context context;
+  io_thread thread{context};
+  const std::string content = make_content(100 * 1000 + 17);
+  safe_file_descriptor file = make_temporary_file(content);
+  collector state{};
+  CHECK(
+    read_all(async_read_chunks(context.get_scheduler(), file, 4096, 8), state)
+    == result_t::value);
+  CHECK(state.n_items == content.size() / 4096 + 1);
+  CHECK(state.data == content);
+}
+
+TEST_CASE(
+  "async_read_chunks with a window larger than the file",
+  "[types][io_uring][async_read_chunks]") {
+  io_uring_context context;
+  io_thread thread{context};
+  const std::string content = make_content(3 * 512);
+  safe_file_descriptor file = make_temporary_file(content);
+  collector state{};
+  CHECK(
+    read_all(async_read_chunks(context.get_scheduler(), file, 512, 16), state)
+    == result_t::value);
+  CHECK(state.n_items == 3);
+  CHECK(state.data == content);
+}
+
+TEST_CASE("async_read_chunks starts at an offset", "[types][io_uring][async_read_chunks]") {
+  io_uring_context context;
+  io_thread thread{context};
+  const std::string content = make_content(10 * 1000);
+  safe_file_descriptor file = make_temporary_file(content);
+  collector state{};
+  CHECK(
+    read_all(async_read_chunks(context.get_scheduler(), file, 1000, 2, 2500), state)
+    == result_t::value);
+  CHECK(state.data == content.substr(2500));
+}
+
+TEST_CASE("async_read_chunks of an empty file", "[types][io_uring][async_read_chunks]") {
+  io_uring_context context;
+  io_thread thread{context};
+  safe_file_descriptor file = make_temporary_file("");
+  collector state{};
+  CHECK(read_all(async_read_chunks(context.get_scheduler(), file, 512), state) == result_t::value);
+  CHECK(state.n_items == 0);
+}
+
+TEST_CASE("async_read_chunks completes with an error", "[types][io_uring][async_read_chunks]") {
+  io_uring_context context;
+  io_thread thread{context};
+  collector state{};
+  CHECK(read_all(async_read_chunks(context.get_scheduler(), -1, 512), state) == result_t::error);
+  CHECK(state.n_items == 0);
+}
+
+TEST_CASE("async_read_chunks is stopped by the receiver", "[types][io_uring][async_read_chunks]") {
+  io_uring_context context;
+  io_thread thread{context};
+  const std::string content = make_content(64 * 1024);
+  safe_file_descriptor file = make_temporary_file(content);
+  collector state{};
+  state.stop_after = 3;
+  CHECK(
+    read_all(async_read_chunks(context.get_scheduler(), file, 1024, 4), state)
+    == result_t::stopped);
+  CHECK(state.n_items == 3);
+  CHECK(state.data == content.substr(0, 3 * 1024));
+}
+
+TEST_CASE(
+  "async_read_chunks with a receiver that is already stopped",
+  "[types][io_uring][async_read_chunks]") {
+  io_uring_context context;
+  io_thread thread{context};
+  const std::string content = make_content(8 * 1024);
+  safe_file_descriptor file = make_temporary_file(content);
+  using op_t = subscribe_result_t<
+    decltype(async_read_chunks(context.get_scheduler(), 0, 1024)),
+    heap_op_receiver>;
+  collector state{};
+  state.stop_source.request_stop();
+  op_t* op = nullptr;
+  op = new op_t(exec::subscribe(
+    async_read_chunks(context.get_scheduler(), file, 1024, 4),
+    heap_op_receiver{{&state}, [&op] {
+                       delete op;
+                     }}));
+  stdexec::start(*op);
+  CHECK(state.wait() == result_t::stopped);
+  CHECK(state.n_items == 0);
+}
+
+TEST_CASE(
+  "async_read_chunks is stopped with the io context",
+  "[types][io_uring][async_read_chunks]") {
+  io_uring_context context;
+  std::optional<io_thread> thread{std::in_place, context};
+  int fds[2];
+  REQUIRE(::pipe(fds) == 0);
+  safe_file_descriptor read_end{fds[0]};
+  safe_file_descriptor write_end{fds[1]};
+  collector state{};
+  auto op = exec::subscribe(
+    async_read_chunks(context.get_scheduler(), read_end, 512, 2), collecting_receiver{&state});
+  stdexec::start(op);
+  // The reads from the empty pipe are cancelled instead of reporting the end of the file
+  thread.reset();
+  CHECK(state.wait() == result_t::stopped);
+  CHECK(state.n_items == 0);
+}
+
+#endif
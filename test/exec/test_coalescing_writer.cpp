@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2023 Maikel Nadolski
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if __has_include(<linux/io_uring.h>)
+#include "exec/linux/coalescing_writer.hpp"
+#include "exec/linux/io_uring_context.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <sys/mman.h>
+
+#include <atomic>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace stdexec;
+using namespace exec;
+
+namespace {
+  struct write_result {
+    std::size_t n_bytes{0};
+    bool is_error{false};
+    bool is_stopped{false};
+  };
+
+  struct write_receiver {
+    using is_receiver = void;
+    write_result* result;
+    std::atomic<int>* n_pending;
+
+    void complete() noexcept {
+      if (n_pending->fetch_sub(1) == 1) {
+        n_pending->notify_all();
+      }
+    }
+
+    friend void tag_invoke(set_value_t, write_receiver&& self, std::size_t n_bytes) noexcept {
+      self.result->n_bytes = n_bytes;
+      self.complete();
+    }
+
+    friend void tag_invoke(set_error_t, write_receiver&& self, std::exception_ptr) noexcept {
+      self.result->is_error = true;
+      self.complete();
+    }
+
+    friend void tag_invoke(set_stopped_t, write_receiver&& self) noexcept {
+      self.result->is_stopped = true;
+      self.complete();
+    }
+
+    friend empty_env tag_invoke(get_env_t, const write_receiver&) noexcept {
+      return {};
+    }
+  };
+
+  using writer_t = coalescing_writer<io_uring_scheduler>;
+  using write_op_t = connect_result_t<
+    decltype(std::declval<writer_t&>().async_write({})),
+    write_receiver>;
+
+  // Starts all writes before the context runs, such that all but the first one are queued
+  std::vector<write_result>
+    write_all(io_uring_context& context, writer_t& writer, const std::vector<std::string>& chunks) {
+    std::vector<write_result> results(chunks.size());
+    std::vector<std::optional<write_op_t>> ops(chunks.size());
+    std::atomic<int> n_pending{static_cast<int>(chunks.size())};
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+      ops[i].emplace(__conv{[&] {
+        return stdexec::connect(
+          writer.async_write(std::as_bytes(std::span{chunks[i]})),
+          write_receiver{&results[i], &n_pending});
+      }});
+      start(*ops[i]);
+    }
+    std::thread io_thread{[&] {
+      context.run_until_stopped();
+    }};
+    for (int n = n_pending.load(); n != 0; n = n_pending.load()) {
+      n_pending.wait(n);
+    }
+    context.request_stop();
+    io_thread.join();
+    return results;
+  }
+
+  std::vector<std::string> make_chunks(std::size_t n_chunks) {
+    std::vector<std::string> chunks;
+    for (std::size_t i = 0; i < n_chunks; ++i) {
+      std::string chunk = std::to_string(i);
+      chunk.append(i % 7, '.');
+      chunk += ';';
+      chunks.push_back(std::move(chunk));
+    }
+    return chunks;
+  }
+
+  // Pretends that the file accepts no more data
+  struct zero_write_scheduler {
+    friend auto tag_invoke(
+      async_writev_t,
+      const zero_write_scheduler&,
+      int,
+      std::span<const ::iovec>,
+      std::int64_t) noexcept {
+      return just(std::size_t{0});
+    }
+  };
+
+  std::string read_file(int fd) {
+    std::string content(::lseek(fd, 0, SEEK_END), '\0');
+    REQUIRE(::pread(fd, content.data(), content.size(), 0) == ::ssize_t(content.size()));
+    return content;
+  }
+}
+
+TEST_CASE(
+  "coalescing_writer gathers queued writes in order",
+  "[types][io_uring][coalescing_writer]") {
+  io_uring_context_params params{};
+  params.enable_metrics = true;
+  io_uring_context context{params};
+  safe_file_descriptor file{::memfd_create("test_coalescing_writer", 0)};
+  writer_t writer{context.get_scheduler(), file, 0};
+  const std::vector<std::string> chunks = make_chunks(500);
+  std::vector<write_result> results = write_all(context, writer, chunks);
+  std::string expected{};
+  for (std::size_t i = 0; i < chunks.size(); ++i) {
+    CHECK(results[i].n_bytes == chunks[i].size());
+    CHECK_FALSE(results[i].is_error);
+    CHECK_FALSE(results[i].is_stopped);
+    expected += chunks[i];
+  }
+  CHECK(read_file(file) == expected);
+  // Two vectored writes, the other submissions wake up the context
+  CHECK(context.metrics().n_submitted < 10);
+}
+
+TEST_CASE(
+  "coalescing_writer splits batches at the maximum batch size",
+  "[types][io_uring][coalescing_writer]") {
+  io_uring_context_params params{};
+  params.enable_metrics = true;
+  io_uring_context context{params};
+  safe_file_descriptor file{::memfd_create("test_coalescing_writer", 0)};
+  writer_t writer{context.get_scheduler(), file, 0, 16};
+  const std::vector<std::string> chunks = make_chunks(64);
+  std::vector<write_result> results = write_all(context, writer, chunks);
+  std::string expected{};
+  for (std::size_t i = 0; i < chunks.size(); ++i) {
+    CHECK(results[i].n_bytes == chunks[i].size());
+    expected += chunks[i];
+  }
+  CHECK(read_file(file) == expected);
+  // The first write and then 63 queued writes in batches of 16
+  CHECK(context.metrics().n_submitted >= 5);
+  CHECK(context.metrics().n_submitted < 10);
+}
+
+TEST_CASE(
+  "coalescing_writer fails all queued writes on an error",
+  "[types][io_uring][coalescing_writer]") {
+  io_uring_context context;
+  writer_t writer{context.get_scheduler(), -1};
+  const std::vector<std::string> chunks = make_chunks(10);
+  std::vector<write_result> results = write_all(context, writer, chunks);
+  for (const write_result& result: results) {
+    CHECK(result.is_error);
+  }
+}
+
+TEST_CASE(
+  "coalescing_writer completes queued writes with stopped",
+  "[types][io_uring][coalescing_writer]") {
+  io_uring_context context;
+  context.request_stop();
+  context.run_until_stopped();
+  safe_file_descriptor file{::memfd_create("test_coalescing_writer", 0)};
+  writer_t writer{context.get_scheduler(), file};
+  const std::vector<std::string> chunks = make_chunks(10);
+  std::vector<write_result> results = write_all(context, writer, chunks);
+  for (const write_result& result: results) {
+    CHECK(result.is_stopped);
+  }
+}
+
+TEST_CASE(
+  "coalescing_writer fails writes that make no progress",
+  "[types][io_uring][coalescing_writer]") {
+  coalescing_writer<zero_write_scheduler> writer{zero_write_scheduler{}, 0};
+  const std::string data = "data";
+  write_result empty{};
+  write_result non_empty{};
+  std::atomic<int> n_pending{2};
+  auto empty_op = stdexec::connect(writer.async_write({}), write_receiver{&empty, &n_pending});
+  auto non_empty_op = stdexec::connect(
+    writer.async_write(std::as_bytes(std::span{data})), write_receiver{&non_empty, &n_pending});
+  start(empty_op);
+  start(non_empty_op);
+  CHECK(n_pending == 0);
+  CHECK(empty.n_bytes == 0);
+  CHECK_FALSE(empty.is_error);
+  CHECK(non_empty.is_error);
+}
+
+#endif
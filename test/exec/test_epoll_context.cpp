@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2023 Maikel Nadolski
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if __has_include(<sys/epoll.h>)
+#include "exec/linux/epoll_context.hpp"
+#include "exec/when_any.hpp"
+#include "exec/async_scope.hpp"
+
+#if __has_include(<linux/io_uring.h>)
+#include "exec/linux/io_uring_context.hpp"
+#endif
+
+#include "catch2/catch.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace stdexec;
+using namespace exec;
+using namespace std::chrono_literals;
+
+namespace {
+  // Drives a context on a separate thread for the lifetime of this object
+  template <class Context>
+  struct driver {
+    Context& context;
+    std::thread thread{[this] {
+      context.run_until_stopped();
+    }};
+
+    ~driver() {
+      context.request_stop();
+      thread.join();
+    }
+  };
+
+  struct pipe_fds {
+    safe_file_descriptor read_end;
+    safe_file_descriptor write_end;
+  };
+
+  pipe_fds make_pipe() {
+    int fds[2];
+    REQUIRE(::pipe2(fds, O_CLOEXEC | O_NONBLOCK) == 0);
+    return {safe_file_descriptor{fds[0]}, safe_file_descriptor{fds[1]}};
+  }
+
+  // This sender code is shared by the io_uring and the epoll tests
+  template <class Scheduler>
+  std::string echo_through_pipe(Scheduler sched, const std::string& message) {
+    pipe_fds pipe = make_pipe();
+    auto [revents] = sync_wait(async_poll(sched, pipe.write_end, POLLOUT)).value();
+    CHECK((revents & POLLOUT));
+    std::string received(message.size(), '\0');
+    auto read = async_read(sched, pipe.read_end, std::as_writable_bytes(std::span{received}));
+    auto write = schedule_after(sched, 1ms)
+               | let_value([&] {
+                   return async_write(sched, pipe.write_end, std::as_bytes(std::span{message}));
+                 });
+    auto [n_read, n_written] = sync_wait(when_all(read, write)).value();
+    CHECK(n_read == message.size());
+    CHECK(n_written == message.size());
+    return received;
+  }
+
+  struct listening_socket {
+    safe_file_descriptor fd;
+    ::sockaddr_in address;
+  };
+
+  listening_socket make_listening_socket() {
+    safe_file_descriptor fd{::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0)};
+    REQUIRE(fd);
+    ::sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    REQUIRE(::bind(fd, reinterpret_cast<const ::sockaddr*>(&address), sizeof(address)) == 0);
+    REQUIRE(::listen(fd, 1) == 0);
+    ::socklen_t length = sizeof(address);
+    REQUIRE(::getsockname(fd, reinterpret_cast<::sockaddr*>(&address), &length) == 0);
+    return {std::move(fd), address};
+  }
+
+  safe_file_descriptor make_client_socket() {
+    safe_file_descriptor fd{::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0)};
+    REQUIRE(fd);
+    return fd;
+  }
+
+  template <class Scheduler>
+  std::string echo_through_socket(Scheduler sched, const std::string& message) {
+    listening_socket listener = make_listening_socket();
+    safe_file_descriptor client = make_client_socket();
+    auto* address = reinterpret_cast<const ::sockaddr*>(&listener.address);
+    auto [fd] = sync_wait(when_all(
+                  async_accept(sched, listener.fd, SOCK_CLOEXEC | SOCK_NONBLOCK),
+                  async_connect(sched, client, address, sizeof(listener.address))))
+                  .value();
+    safe_file_descriptor server{fd};
+    std::string received(message.size(), '\0');
+    auto [n_received, n_sent] =
+      sync_wait(when_all(
+                  async_recv(sched, server, std::as_writable_bytes(std::span{received})),
+                  async_send(sched, client, std::as_bytes(std::span{message}), MSG_NOSIGNAL)))
+        .value();
+    CHECK(n_received == message.size());
+    CHECK(n_sent == message.size());
+    return received;
+  }
+}
+
+TEST_CASE("epoll_context schedules on its thread", "[types][epoll]") {
+  epoll_context context;
+  driver<epoll_context> io_thread{context};
+  epoll_scheduler sched = context.get_scheduler();
+  std::thread::id id{};
+  sync_wait(schedule(sched) | then([&] { id = std::this_thread::get_id(); }));
+  CHECK(id == io_thread.thread.get_id());
+  CHECK(context.is_running());
+  CHECK(sched == context.get_scheduler());
+  CHECK(get_completion_scheduler<set_value_t>(get_env(schedule(sched))) == sched);
+}
+
+TEST_CASE("epoll_context timers complete in the order of their deadlines", "[types][epoll]") {
+  epoll_context context;
+  driver<epoll_context> io_thread{context};
+  epoll_scheduler sched = context.get_scheduler();
+  std::vector<int> order{};
+  auto timer = [&](std::chrono::milliseconds duration, int id) {
+    return schedule_after(sched, duration) | then([&order, id] { order.push_back(id); });
+  };
+  const auto start = std::chrono::steady_clock::now();
+  sync_wait(when_all(timer(30ms, 3), timer(10ms, 1), timer(20ms, 2), timer(0ms, 0)));
+  CHECK(std::chrono::steady_clock::now() - start >= 30ms);
+  CHECK(order == std::vector<int>{0, 1, 2, 3});
+  sync_wait(schedule_at(sched, std::chrono::steady_clock::now() + 1ms));
+}
+
+TEST_CASE("epoll_context cancels a timer", "[types][epoll]") {
+  epoll_context context;
+  driver<epoll_context> io_thread{context};
+  epoll_scheduler sched = context.get_scheduler();
+  const auto start = std::chrono::steady_clock::now();
+  CHECK(sync_wait(when_any(
+    schedule_after(sched, 10s) | then([] { return false; }),
+    schedule_after(sched, 1ms) | then([] { return true; }))));
+  CHECK(std::chrono::steady_clock::now() - start < 10s);
+}
+
+TEST_CASE("epoll_context reads and writes a pipe", "[types][epoll]") {
+  epoll_context context;
+  driver<epoll_context> io_thread{context};
+  CHECK(echo_through_pipe(context.get_scheduler(), "Hello, epoll!") == "Hello, epoll!");
+}
+
+TEST_CASE("epoll_context polls a file descriptor", "[types][epoll]") {
+  epoll_context context;
+  driver<epoll_context> io_thread{context};
+  epoll_scheduler sched = context.get_scheduler();
+  pipe_fds pipe = make_pipe();
+  auto [revents] = sync_wait(async_poll(sched, pipe.write_end, POLLOUT)).value();
+  CHECK((revents & POLLOUT));
+  CHECK(sync_wait(when_any(
+    async_poll(sched, pipe.read_end, POLLIN) | then([](short) { return false; }),
+    schedule_after(sched, 1ms) | then([] { return true; }))));
+  REQUIRE(::write(pipe.write_end, "x", 1) == 1);
+  auto [readable] = sync_wait(async_poll(sched, pipe.read_end, POLLIN)).value();
+  CHECK((readable & POLLIN));
+}
+
+TEST_CASE("epoll_context connects and transfers data over sockets", "[types][epoll]") {
+  epoll_context context;
+  driver<epoll_context> io_thread{context};
+  epoll_scheduler sched = context.get_scheduler();
+  CHECK(echo_through_socket(sched, "Hello, socket!") == "Hello, socket!");
+
+  // A refused connection is reported by the connect sender
+  ::sockaddr_in address = make_listening_socket().address;
+  safe_file_descriptor client = make_client_socket();
+  CHECK_THROWS_AS(
+    sync_wait(async_connect(
+      sched, client, reinterpret_cast<const ::sockaddr*>(&address), sizeof(address))),
+    std::system_error);
+}
+
+TEST_CASE("epoll_context waits for an eventfd", "[types][epoll]") {
+  epoll_context context;
+  driver<epoll_context> io_thread{context};
+  epoll_scheduler sched = context.get_scheduler();
+  safe_file_descriptor efd{::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)};
+  auto notify = schedule_after(sched, 1ms) | let_value([&] {
+                  return async_eventfd_write(sched, efd, 7);
+                });
+  auto [counter] = sync_wait(when_all(async_eventfd_read(sched, efd), notify)).value();
+  CHECK(counter == 7);
+}
+
+TEST_CASE("epoll_context performs io on regular files synchronously", "[types][epoll]") {
+  epoll_context context;
+  driver<epoll_context> io_thread{context};
+  epoll_scheduler sched = context.get_scheduler();
+  safe_file_descriptor file{::memfd_create("test_epoll_context", 0)};
+  const std::string content = "regular file";
+  auto [n_written] =
+    sync_wait(async_write(sched, file, std::as_bytes(std::span{content}), 0)).value();
+  CHECK(n_written == content.size());
+  std::string buffer(content.size(), '\0');
+  auto [n_read] =
+    sync_wait(async_read(sched, file, std::as_writable_bytes(std::span{buffer}), 0)).value();
+  CHECK(n_read == content.size());
+  CHECK(buffer == content);
+  CHECK_THROWS_AS(
+    sync_wait(async_read(sched, -1, std::as_writable_bytes(std::span{buffer}))),
+    std::system_error);
+}
+
+TEST_CASE("epoll_context stops pending operations", "[types][epoll]") {
+  epoll_context context;
+  epoll_scheduler sched = context.get_scheduler();
+  pipe_fds pipe = make_pipe();
+  std::byte buffer[8];
+  auto read = async_read(sched, pipe.read_end, buffer);
+  std::optional<std::thread> io_thread{};
+  auto stop = schedule_after(sched, 1ms) | then([&] { context.request_stop(); });
+  io_thread.emplace([&] {
+    context.run_until_stopped();
+  });
+  CHECK_FALSE(sync_wait(when_all(read, schedule_after(sched, 10s), stop)).has_value());
+  io_thread->join();
+  // A stopped context completes new operations with set_stopped
+  CHECK_FALSE(sync_wait(schedule(sched)).has_value());
+  CHECK_FALSE(sync_wait(schedule_after(sched, 1ms)).has_value());
+}
+
+TEST_CASE("epoll_context runs until it is empty", "[types][epoll]") {
+  epoll_context context;
+  epoll_scheduler sched = context.get_scheduler();
+  exec::async_scope scope;
+  int n_completed = 0;
+  for (int i = 0; i < 10; ++i) {
+    scope.spawn(schedule_after(sched, 1ms) | then([&] { ++n_completed; }));
+  }
+  context.run_until_empty();
+  CHECK(n_completed == 10);
+  CHECK_FALSE(context.stop_requested());
+}
+
+#if __has_include(<linux/io_uring.h>)
+TEST_CASE("The same senders run on an io_uring_context and an epoll_context", "[types][epoll]") {
+  epoll_context epoll;
+  driver<epoll_context> epoll_thread{epoll};
+  CHECK(echo_through_pipe(epoll.get_scheduler(), "epoll") == "epoll");
+  CHECK(echo_through_socket(epoll.get_scheduler(), "epoll") == "epoll");
+  if (io_uring_is_supported()) {
+    io_uring_context io_uring;
+    driver<io_uring_context> io_uring_thread{io_uring};
+    CHECK(echo_through_pipe(io_uring.get_scheduler(), "io_uring") == "io_uring");
+    CHECK(echo_through_socket(io_uring.get_scheduler(), "io_uring") == "io_uring");
+  }
+}
+#endif
+
+#endif
@@ -17,13 +17,24 @@
 
 #if __has_include(<linux/io_uring.h>)
 #include "exec/linux/io_uring_context.hpp"
+#include "exec/linux/aligned_buffer_pool.hpp"
 #include "exec/scope.hpp"
 #include "exec/single_thread_context.hpp"
 #include "exec/finally.hpp"
 #include "exec/when_any.hpp"
+#include "exec/async_scope.hpp"
+#include "exec/static_thread_pool.hpp"
 
 #include "catch2/catch.hpp"
 
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+
 using namespace stdexec;
 using namespace exec;
 using namespace std::chrono_literals;
@@ -56,6 +67,10 @@ class jthread {
   std::thread::id get_id() const noexcept {
     return thread_.get_id();
   }
+
+  void join() {
+    thread_.join();
+  }
 };
 
 TEST_CASE("io_uring_context Satisfy concepts", "[types][io_uring][schedulers]") {
@@ -317,4 +332,741 @@ TEST_CASE("io_uring_context schedule_after -1s", "[types][io_uring][schedulers]"
   }
 }
 
+TEST_CASE("io_uring_context with custom completion queue size", "[types][io_uring][schedulers]") {
+  io_uring_context context{io_uring_context_params{.entries = 16, .cq_entries = 64}};
+  io_uring_scheduler scheduler = context.get_scheduler();
+  bool is_called = false;
+  start_detached(schedule_after(scheduler, 1ms) | then([&] { is_called = true; }));
+  context.run_until_empty();
+  CHECK(is_called);
+}
+
+TEST_CASE("io_uring_context with SQPOLL", "[types][io_uring][schedulers]") {
+  io_uring_context context{
+    io_uring_context_params{.flags = IORING_SETUP_SQPOLL, .sq_thread_idle = 1}};
+  io_uring_scheduler scheduler = context.get_scheduler();
+  jthread io_thread{[&] {
+    context.run_until_stopped();
+  }};
+  {
+    scope_guard guard{[&]() noexcept {
+      context.request_stop();
+    }};
+    for (int i = 0; i < 10; ++i) {
+      bool is_called = false;
+      // Sleep longer than sq_thread_idle such that the kernel thread needs a wakeup
+      sync_wait(schedule_after(scheduler, 2ms) | then([&] {
+                  CHECK(io_thread.get_id() == std::this_thread::get_id());
+                  is_called = true;
+                }));
+      CHECK(is_called);
+    }
+  }
+}
+
+#ifdef IORING_SETUP_DEFER_TASKRUN
+TEST_CASE(
+  "io_uring_context with SINGLE_ISSUER and DEFER_TASKRUN",
+  "[types][io_uring][schedulers]") {
+  io_uring_context context{io_uring_context_params{.flags = IORING_SETUP_DEFER_TASKRUN}};
+  io_uring_scheduler scheduler = context.get_scheduler();
+  // The ring is created on this thread but driven by another one
+  jthread io_thread{[&] {
+    context.run_until_stopped();
+  }};
+  {
+    scope_guard guard{[&]() noexcept {
+      context.request_stop();
+    }};
+    bool is_called = false;
+    sync_wait(when_all(
+      schedule(scheduler),
+      schedule_after(scheduler, 1ms) | then([&] {
+        CHECK(io_thread.get_id() == std::this_thread::get_id());
+        is_called = true;
+      })));
+    CHECK(is_called);
+  }
+}
+#endif
+
+TEST_CASE("io_uring_context with COOP_TASKRUN", "[types][io_uring][schedulers]") {
+  io_uring_context context{
+    io_uring_context_params{.flags = IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG}};
+  io_uring_scheduler scheduler = context.get_scheduler();
+  bool is_called = false;
+  start_detached(schedule_after(scheduler, 1ms) | then([&] { is_called = true; }));
+  context.run_until_empty();
+  CHECK(is_called);
+}
+
+TEST_CASE("io_uring_context async_read and async_write", "[types][io_uring][schedulers]") {
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  jthread io_thread{[&] {
+    context.run_until_stopped();
+  }};
+  {
+    scope_guard guard{[&]() noexcept {
+      context.request_stop();
+    }};
+    int fds[2];
+    REQUIRE(::pipe(fds) == 0);
+    safe_file_descriptor read_end{fds[0]};
+    safe_file_descriptor write_end{fds[1]};
+    const std::string message = "Hello, io_uring!";
+    std::string buffer(message.size(), '\0');
+    auto [n_read, n_written] =
+      sync_wait(when_all(
+                  async_read(scheduler, read_end, std::as_writable_bytes(std::span{buffer})),
+                  async_write(scheduler, write_end, std::as_bytes(std::span{message}))))
+        .value();
+    CHECK(n_read == message.size());
+    CHECK(n_written == message.size());
+    CHECK(buffer == message);
+
+    write_end.reset();
+    auto [n_eof] =
+      sync_wait(async_read(scheduler, read_end, std::as_writable_bytes(std::span{buffer}))).value();
+    CHECK(n_eof == 0);
+
+    CHECK_THROWS_AS(
+      sync_wait(async_read(scheduler, -1, std::as_writable_bytes(std::span{buffer}))),
+      std::system_error);
+  }
+}
+
+TEST_CASE("io_uring_context wakes up other contexts", "[types][io_uring][schedulers]") {
+  io_uring_context context1;
+  io_uring_context context2;
+  io_uring_scheduler scheduler1 = context1.get_scheduler();
+  io_uring_scheduler scheduler2 = context2.get_scheduler();
+  jthread io_thread1{[&] {
+    context1.run_until_stopped();
+  }};
+  jthread io_thread2{[&] {
+    context2.run_until_stopped();
+  }};
+  {
+    scope_guard guard{[&]() noexcept {
+      context1.request_stop();
+      context2.request_stop();
+    }};
+    async_scope scope;
+    constexpr int n_tasks = 1000;
+    std::atomic<int> n_hops{0};
+    for (int i = 0; i < n_tasks; ++i) {
+      scope.spawn(
+        schedule(scheduler1) //
+        | let_value([&] {
+            CHECK(io_thread1.get_id() == std::this_thread::get_id());
+            return schedule(scheduler2);
+          })
+        | let_value([&] {
+            CHECK(io_thread2.get_id() == std::this_thread::get_id());
+            return schedule(scheduler1);
+          })
+        | then([&] {
+            CHECK(io_thread1.get_id() == std::this_thread::get_id());
+            n_hops.fetch_add(1, std::memory_order_relaxed);
+          }));
+    }
+    sync_wait(scope.on_empty());
+    CHECK(n_hops == n_tasks);
+  }
+}
+
+#ifdef IORING_SETUP_DEFER_TASKRUN
+TEST_CASE(
+  "io_uring_context wakes up other contexts when it is polled",
+  "[types][io_uring][schedulers]") {
+  // Completions are only posted when we enter the kernel to reap them. Thus the completion below
+  // runs in the last step of poll() and its wakeup message is left to the end of poll().
+  io_uring_context context1{io_uring_context_params{.flags = IORING_SETUP_DEFER_TASKRUN}};
+  io_uring_scheduler scheduler1 = context1.get_scheduler();
+  std::atomic<bool> is_woken{false};
+  {
+    io_uring_context context2;
+    io_uring_scheduler scheduler2 = context2.get_scheduler();
+    jthread io_thread2{[&] {
+      context2.run_until_stopped();
+    }};
+    scope_guard guard{[&]() noexcept {
+      context2.request_stop();
+    }};
+    // Let context2 block in the kernel
+    sync_wait(schedule(scheduler2));
+    std::this_thread::sleep_for(10ms);
+    start_detached(schedule_after(scheduler1, 1ms) | then([&] {
+                     start_detached(schedule(scheduler2) | then([&] { is_woken = true; }));
+                   }));
+    CHECK(context1.poll() == 0);
+    std::this_thread::sleep_for(10ms);
+    context1.poll();
+    // context1 is not polled again until context2 has been woken up
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (!is_woken && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(1ms);
+    }
+    CHECK(is_woken);
+  }
+  // The wakeup message of the destroyed context2 is completed by context1
+  context1.run_until_empty();
+}
+#endif
+
+TEST_CASE("io_uring_context poll does not block", "[types][io_uring][schedulers]") {
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  CHECK(context.poll() == 0);
+  bool is_called = false;
+  start_detached(schedule(scheduler) | then([&] {
+                   CHECK(context.is_running());
+                   is_called = true;
+                 }));
+  CHECK(context.poll() == 1);
+  CHECK(is_called);
+  CHECK(!context.is_running());
+}
+
+TEST_CASE("io_uring_context run_one blocks for one completion", "[types][io_uring][schedulers]") {
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  int n_called = 0;
+  start_detached(schedule_after(scheduler, 1ms) | then([&] { ++n_called; }));
+  start_detached(schedule_after(scheduler, 50ms) | then([&] { ++n_called; }));
+  CHECK(context.run_one() == 1);
+  CHECK(n_called == 1);
+  CHECK(context.run_one() == 1);
+  CHECK(n_called == 2);
+}
+
+TEST_CASE("io_uring_context run_for returns after the duration", "[types][io_uring][schedulers]") {
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  auto start = std::chrono::steady_clock::now();
+  CHECK(context.run_for(5ms) == 0);
+  CHECK(std::chrono::steady_clock::now() - start >= 5ms);
+
+  int n_called = 0;
+  start_detached(schedule_after(scheduler, 1ms) | then([&] { ++n_called; }));
+  start_detached(schedule_after(scheduler, 200ms) | then([&] { ++n_called; }));
+  CHECK(context.run_for(50ms) == 1);
+  CHECK(n_called == 1);
+  while (n_called < 2) {
+    context.run_for(1ms);
+  }
+  CHECK(context.poll() == 0);
+}
+
+TEST_CASE("io_uring_context run_for returns when stopped", "[types][io_uring][schedulers]") {
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  start_detached(schedule_after(scheduler, 1ms) | then([&] { context.request_stop(); }));
+  auto start = std::chrono::steady_clock::now();
+  CHECK(context.run_for(10s) == 1);
+  CHECK(std::chrono::steady_clock::now() - start < 10s);
+  CHECK(context.stop_requested());
+}
+
+TEST_CASE("io_uring_context with busy polling", "[types][io_uring][schedulers]") {
+  io_uring_context context{io_uring_context_params{.busy_poll_us = 1000}};
+  io_uring_scheduler scheduler = context.get_scheduler();
+  jthread io_thread{[&] {
+    context.run_until_stopped();
+  }};
+  {
+    scope_guard guard{[&]() noexcept {
+      context.request_stop();
+    }};
+    for (int i = 0; i < 10; ++i) {
+      bool is_called = false;
+      sync_wait(schedule_after(scheduler, 100us) | then([&] {
+                  CHECK(io_thread.get_id() == std::this_thread::get_id());
+                  is_called = true;
+                }));
+      CHECK(is_called);
+      std::this_thread::sleep_for(2ms);
+    }
+  }
+}
+
+TEST_CASE("io_uring_context with IOPOLL", "[types][io_uring][schedulers]") {
+  io_uring_context context{io_uring_context_params{.flags = IORING_SETUP_IOPOLL}};
+  io_uring_scheduler scheduler = context.get_scheduler();
+  CHECK(context.poll() == 0);
+  jthread io_thread{[&] {
+    context.run_until_stopped();
+  }};
+  {
+    scope_guard guard{[&]() noexcept {
+      context.request_stop();
+    }};
+    for (int i = 0; i < 10; ++i) {
+      bool is_called = false;
+      sync_wait(schedule(scheduler) | then([&] {
+                  CHECK(io_thread.get_id() == std::this_thread::get_id());
+                  is_called = true;
+                }));
+      CHECK(is_called);
+    }
+  }
+}
+
+TEST_CASE("io_uring_context async_splice and async_tee", "[types][io_uring][schedulers]") {
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  jthread io_thread{[&] {
+    context.run_until_stopped();
+  }};
+  {
+    scope_guard guard{[&]() noexcept {
+      context.request_stop();
+    }};
+    const std::string message = "Hello, splice!";
+    safe_file_descriptor file{::memfd_create("test_io_uring_splice", 0)};
+    REQUIRE(::pwrite(file, message.data(), message.size(), 0) == (ssize_t) message.size());
+    int fds1[2];
+    int fds2[2];
+    REQUIRE(::pipe(fds1) == 0);
+    REQUIRE(::pipe(fds2) == 0);
+    safe_file_descriptor read_end1{fds1[0]};
+    safe_file_descriptor write_end1{fds1[1]};
+    safe_file_descriptor read_end2{fds2[0]};
+    safe_file_descriptor write_end2{fds2[1]};
+
+    auto [n_spliced] =
+      sync_wait(async_splice(scheduler, file, 0, write_end1, -1, message.size())).value();
+    CHECK(n_spliced == message.size());
+    auto [n_teed] = sync_wait(async_tee(scheduler, read_end1, write_end2, message.size())).value();
+    CHECK(n_teed == message.size());
+
+    std::string buffer(message.size(), '\0');
+    CHECK(::read(read_end1, buffer.data(), buffer.size()) == (ssize_t) message.size());
+    CHECK(buffer == message);
+    buffer.assign(message.size(), '\0');
+    CHECK(::read(read_end2, buffer.data(), buffer.size()) == (ssize_t) message.size());
+    CHECK(buffer == message);
+
+    CHECK_THROWS_AS(
+      sync_wait(async_splice(scheduler, file, 0, -1, -1, message.size())), std::system_error);
+  }
+}
+
+TEST_CASE("io_uring_context async_send_zc", "[types][io_uring][schedulers]") {
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  jthread io_thread{[&] {
+    context.run_until_stopped();
+  }};
+  {
+    scope_guard guard{[&]() noexcept {
+      context.request_stop();
+    }};
+    safe_file_descriptor listener{::socket(AF_INET, SOCK_STREAM, 0)};
+    REQUIRE(listener);
+    ::sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ::socklen_t address_size = sizeof(address);
+    REQUIRE(::bind(listener, (::sockaddr*) &address, sizeof(address)) == 0);
+    REQUIRE(::listen(listener, 1) == 0);
+    REQUIRE(::getsockname(listener, (::sockaddr*) &address, &address_size) == 0);
+    safe_file_descriptor client{::socket(AF_INET, SOCK_STREAM, 0)};
+    REQUIRE(::connect(client, (::sockaddr*) &address, sizeof(address)) == 0);
+    safe_file_descriptor server{::accept(listener, nullptr, nullptr)};
+    REQUIRE(server);
+
+    const std::string message(1 << 16, 'x');
+    auto [n_sent] =
+      sync_wait(async_send_zc(scheduler, client, std::as_bytes(std::span{message}))).value();
+    CHECK(n_sent == message.size());
+    std::string buffer(message.size(), '\0');
+    std::size_t n_received = 0;
+    while (n_received < n_sent) {
+      ssize_t n = ::recv(server, buffer.data() + n_received, buffer.size() - n_received, 0);
+      REQUIRE(n > 0);
+      n_received += static_cast<std::size_t>(n);
+    }
+    CHECK(buffer == message);
+
+    CHECK_THROWS_AS(
+      sync_wait(async_send_zc(scheduler, -1, std::as_bytes(std::span{message}))),
+      std::system_error);
+  }
+}
+
+TEST_CASE("aligned_buffer_pool hands out aligned buffers", "[types][io_uring][direct_io]") {
+  aligned_buffer_pool pool{2, 1000, 512};
+  CHECK(pool.size() == 2);
+  CHECK(pool.buffer_size() == 1024);
+  aligned_buffer first = pool.try_acquire();
+  aligned_buffer second = pool.try_acquire();
+  REQUIRE(first);
+  REQUIRE(second);
+  CHECK(first.index() != second.index());
+  CHECK(reinterpret_cast<std::uintptr_t>(first.data().data()) % 512 == 0);
+  CHECK(first.data().size() == 1024);
+  CHECK_FALSE(pool.try_acquire());
+  second = aligned_buffer{};
+  aligned_buffer third = pool.try_acquire();
+  CHECK(third);
+  CHECK_THROWS_AS(aligned_buffer_pool(1, 512, 1000), std::invalid_argument);
+}
+
+TEST_CASE(
+  "io_uring_context async_read_direct and async_write_direct",
+  "[types][io_uring][direct_io]") {
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  aligned_buffer_pool pool{2, 4096};
+  context.register_buffers(pool.iovecs());
+  jthread io_thread{[&] {
+    context.run_until_stopped();
+  }};
+  {
+    scope_guard guard{[&]() noexcept {
+      context.request_stop();
+    }};
+    safe_file_descriptor file{::memfd_create("test_io_uring_direct_io", 0)};
+    REQUIRE(file);
+    aligned_buffer out = pool.try_acquire();
+    aligned_buffer in = pool.try_acquire();
+    std::ranges::fill(out.data(), std::byte{42});
+
+    auto [n_written] =
+      sync_wait(async_write_direct(scheduler, file, out.data(), 4096, 4096, out.index())).value();
+    CHECK(n_written == 4096);
+    auto [n_read] =
+      sync_wait(async_read_direct(scheduler, file, in.data(), 4096, 4096, in.index())).value();
+    CHECK(n_read == 4096);
+    CHECK(std::ranges::equal(in.data(), out.data()));
+
+    std::ranges::fill(in.data(), std::byte{0});
+    auto [n_read_unregistered] =
+      sync_wait(async_read_direct(scheduler, file, in.data(), 4096)).value();
+    CHECK(n_read_unregistered == 4096);
+    CHECK(std::ranges::equal(in.data(), out.data()));
+  }
+}
+
+TEST_CASE(
+  "io_uring_context async_read_direct validates the alignment",
+  "[types][io_uring][direct_io]") {
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  jthread io_thread{[&] {
+    context.run_until_stopped();
+  }};
+  {
+    scope_guard guard{[&]() noexcept {
+      context.request_stop();
+    }};
+    safe_file_descriptor file{::memfd_create("test_io_uring_direct_io", 0)};
+    aligned_buffer_pool pool{1, 8192};
+    aligned_buffer buffer = pool.try_acquire();
+    auto error_of = [](auto sender) {
+      try {
+        sync_wait(std::move(sender));
+      } catch (const std::system_error& error) {
+        return error.code();
+      }
+      return std::error_code{};
+    };
+    const std::error_code einval{EINVAL, std::system_category()};
+    CHECK(error_of(async_read_direct(scheduler, file, buffer.data(), 100)) == einval);
+    std::span<std::byte> misaligned = buffer.data().subspan(1, 4096);
+    CHECK(error_of(async_read_direct(scheduler, file, misaligned, 0)) == einval);
+    CHECK(error_of(async_read_direct(scheduler, file, buffer.data().first(4000), 0)) == einval);
+    CHECK(error_of(async_read_direct(scheduler, file, buffer.data(), 0, 3000)) == einval);
+    CHECK(error_of(async_read_direct(scheduler, file, buffer.data(), 0)) == std::error_code{});
+  }
+}
+
+TEST_CASE("io_uring_context async_read_direct with O_DIRECT", "[types][io_uring][direct_io]") {
+  // Not every file system supports O_DIRECT, e.g. tmpfs does not.
+  safe_file_descriptor file{::open(".", O_TMPFILE | O_RDWR | O_DIRECT, 0600)};
+  if (!file) {
+    return;
+  }
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  jthread io_thread{[&] {
+    context.run_until_stopped();
+  }};
+  {
+    scope_guard guard{[&]() noexcept {
+      context.request_stop();
+    }};
+    aligned_buffer_pool pool{2, 1 << 16};
+    aligned_buffer out = pool.try_acquire();
+    aligned_buffer in = pool.try_acquire();
+    std::ranges::fill(out.data(), std::byte{7});
+    auto [n_written] = sync_wait(async_write_direct(scheduler, file, out.data(), 0)).value();
+    CHECK(n_written == out.data().size());
+    auto [n_read] = sync_wait(async_read_direct(scheduler, file, in.data(), 0)).value();
+    CHECK(n_read == in.data().size());
+    CHECK(std::ranges::equal(in.data(), out.data()));
+  }
+}
+
+TEST_CASE("io_uring_context file lifecycle", "[types][io_uring][filesystem]") {
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  jthread io_thread{[&] {
+    context.run_until_stopped();
+  }};
+  {
+    scope_guard guard{[&]() noexcept {
+      context.request_stop();
+    }};
+    char directory_template[] = "/tmp/test_io_uring_XXXXXX";
+    REQUIRE(::mkdtemp(directory_template) != nullptr);
+    const std::string directory = directory_template;
+    safe_file_descriptor dirfd{::open(directory.c_str(), O_DIRECTORY | O_RDONLY)};
+    REQUIRE(dirfd);
+    scope_guard remove_directory{[&]() noexcept {
+      ::unlinkat(dirfd, "a", 0);
+      ::unlinkat(dirfd, "b", 0);
+      ::rmdir(directory.c_str());
+    }};
+
+    auto [fd] =
+      sync_wait(async_openat(scheduler, dirfd, "a", O_CREAT | O_RDWR | O_EXCL, 0600)).value();
+    REQUIRE(fd >= 0);
+    const std::string message = "Hello, file system!";
+    sync_wait(
+      async_write(scheduler, fd, std::as_bytes(std::span{message}), 0)
+      | let_value([&](std::size_t) { return async_fallocate(scheduler, fd, 0, 0, 4096); })
+      | let_value([&] { return async_fsync(scheduler, fd, IORING_FSYNC_DATASYNC); })
+      | let_value([&] { return async_fadvise(scheduler, fd, 0, 0, POSIX_FADV_DONTNEED); })
+      | let_value([&] { return async_close(scheduler, fd); }));
+    CHECK(::fcntl(fd, F_GETFD) == -1);
+
+    struct ::statx stat{};
+    sync_wait(async_renameat(scheduler, dirfd, "a", dirfd, "b"));
+    sync_wait(async_statx(scheduler, dirfd, "b", 0, STATX_SIZE, &stat));
+    CHECK(stat.stx_size == 4096);
+
+    auto [fd2] = sync_wait(async_openat(scheduler, dirfd, "b", O_RDONLY)).value();
+    // Lengths that do not fit into the submission queue entry are rejected
+    CHECK(sync_wait(async_fadvise(scheduler, fd2, 0, 4096, POSIX_FADV_WILLNEED)));
+    CHECK_THROWS_AS(
+      sync_wait(async_fadvise(scheduler, fd2, 0, std::int64_t{1} << 32, POSIX_FADV_WILLNEED)),
+      std::system_error);
+    CHECK_THROWS_AS(
+      sync_wait(async_fadvise(scheduler, fd2, 0, -1, POSIX_FADV_WILLNEED)), std::system_error);
+    std::string buffer(message.size(), '\0');
+    auto [n_read] = sync_wait(
+                      async_read(scheduler, fd2, std::as_writable_bytes(std::span{buffer}), 0)
+                      | let_value([&](std::size_t n) {
+                          return async_close(scheduler, fd2) | then([n] { return n; });
+                        }))
+                      .value();
+    CHECK(n_read == message.size());
+    CHECK(buffer == message);
+
+    CHECK_THROWS_AS(sync_wait(async_openat(scheduler, dirfd, "a", O_RDONLY)), std::system_error);
+    CHECK_THROWS_AS(
+      sync_wait(async_statx(scheduler, dirfd, "a", 0, STATX_SIZE, &stat)), std::system_error);
+  }
+}
+
+TEST_CASE("io_uring_context hands completions to a pool in batches", "[types][io_uring][batch]") {
+  static_thread_pool pool{2};
+  {
+    // Tasks of a batch are only enqueued at its end.
+    std::atomic<int> n_executed{0};
+    pool.begin_batch();
+    for (int i = 0; i < 10; ++i) {
+      start_detached(schedule(pool.get_scheduler()) | then([&] { ++n_executed; }));
+    }
+    std::this_thread::sleep_for(10ms);
+    CHECK(n_executed == 0);
+    pool.end_batch();
+    while (n_executed != 10) {
+      std::this_thread::yield();
+    }
+  }
+
+  {
+    // All completions of one pass are handed to the pool at once.
+    struct recording_target {
+      static_thread_pool& pool;
+      int depth = 0;
+      int n_scheduled = 0;
+      std::vector<int> handoffs{};
+
+      void begin_batch() noexcept {
+        ++depth;
+        pool.begin_batch();
+      }
+
+      void end_batch() noexcept {
+        pool.end_batch();
+        if (--depth == 0 && n_scheduled > 0) {
+          handoffs.push_back(std::exchange(n_scheduled, 0));
+        }
+      }
+    };
+
+    recording_target target{pool};
+    io_uring_context context;
+    context.batch_completions_for(target);
+    io_uring_scheduler scheduler = context.get_scheduler();
+    std::atomic<int> n_on_pool{0};
+    exec::async_scope scope;
+    for (int i = 0; i < 100; ++i) {
+      scope.spawn(
+        schedule(scheduler) | then([&]() noexcept { target.n_scheduled += target.depth > 0; })
+        | transfer(pool.get_scheduler()) | then([&]() noexcept { ++n_on_pool; }));
+    }
+    context.run_until_empty();
+    sync_wait(scope.on_empty());
+    CHECK(target.handoffs == std::vector<int>{100});
+    CHECK(n_on_pool == 100);
+  }
+
+  io_uring_context context;
+  context.batch_completions_for(pool);
+  io_uring_scheduler scheduler = context.get_scheduler();
+  jthread io_thread{[&] {
+    context.run_until_stopped();
+  }};
+  {
+    scope_guard guard{[&]() noexcept {
+      context.request_stop();
+    }};
+    auto [io_thread_id] =
+      sync_wait(schedule(scheduler) | then([] { return std::this_thread::get_id(); })).value();
+    std::atomic<int> n_on_pool{0};
+    exec::async_scope scope;
+    for (int i = 0; i < 100; ++i) {
+      scope.spawn(
+        schedule_after(scheduler, 1ms) | transfer(pool.get_scheduler()) | then([&]() noexcept {
+          n_on_pool += std::this_thread::get_id() != io_thread_id;
+        }));
+    }
+    sync_wait(scope.on_empty());
+    CHECK(n_on_pool == 100);
+  }
+}
+
+TEST_CASE("io_uring_context metrics", "[types][io_uring][metrics]") {
+  SECTION("are zero by default") {
+    io_uring_context context;
+    io_uring_scheduler scheduler = context.get_scheduler();
+    jthread io_thread{[&] {
+      context.run_until_stopped();
+    }};
+    scope_guard guard{[&]() noexcept {
+      context.request_stop();
+    }};
+    sync_wait(schedule_after(scheduler, 1ms));
+    io_uring_context_metrics metrics = context.metrics();
+    CHECK(metrics.n_enter_calls == 0);
+    CHECK(metrics.n_submitted == 0);
+  }
+
+  SECTION("count submissions, completions and deferrals") {
+    io_uring_context_params params{};
+    params.entries = 8;
+    params.enable_metrics = true;
+    io_uring_context context{params};
+    io_uring_scheduler scheduler = context.get_scheduler();
+    jthread io_thread{[&] {
+      context.run_until_stopped();
+    }};
+    scope_guard guard{[&]() noexcept {
+      context.request_stop();
+    }};
+    constexpr int n_timers = 100;
+    exec::async_scope scope;
+    for (int i = 0; i < n_timers; ++i) {
+      scope.spawn(schedule_after(scheduler, 1ms));
+    }
+    sync_wait(scope.on_empty());
+    // The counters of a reap are updated after its completions have run
+    context.request_stop();
+    io_thread.join();
+    io_uring_context_metrics metrics = context.metrics();
+    CHECK(metrics.n_submitted >= n_timers);
+    CHECK(metrics.n_completed >= n_timers);
+    CHECK(metrics.n_enter_calls > 0);
+    CHECK(metrics.n_sq_full_deferrals > 0);
+    CHECK(metrics.n_cq_overflows == 0);
+    CHECK(metrics.n_cq_dropped == 0);
+    CHECK(metrics.max_in_flight >= 8);
+    CHECK(metrics.max_in_flight <= 16);
+    std::uint64_t n_batched = 0;
+    std::uint64_t n_reaped = 0;
+    for (std::size_t i = 0; i < io_uring_context_metrics::n_buckets; ++i) {
+      n_batched += metrics.submit_batch_sizes[i] << i;
+      n_reaped += metrics.completions_per_reap[i] << i;
+    }
+    CHECK(n_batched > 0);
+    CHECK(n_batched <= metrics.n_submitted);
+    CHECK(n_reaped > 0);
+    CHECK(n_reaped <= metrics.n_completed);
+  }
+}
+
+TEST_CASE("io_uring_context waits for eventfds and signals", "[types][io_uring][events]") {
+  SECTION("eventfd") {
+    io_uring_context context;
+    io_uring_scheduler scheduler = context.get_scheduler();
+    jthread io_thread{[&] {
+      context.run_until_stopped();
+    }};
+    scope_guard guard{[&]() noexcept {
+      context.request_stop();
+    }};
+    safe_file_descriptor efd{::eventfd(0, EFD_CLOEXEC)};
+    REQUIRE(efd);
+    sync_wait(async_eventfd_write(scheduler, efd, 3));
+    auto [counter] = sync_wait(async_eventfd_read(scheduler, efd)).value();
+    CHECK(counter == 3);
+    auto notify = [&] {
+      return async_eventfd_write(scheduler, efd, 5);
+    };
+    auto wait = async_eventfd_read(scheduler, efd);
+    auto later = schedule_after(scheduler, 1ms) | let_value(notify);
+    auto [waited] = sync_wait(when_all(wait, later)).value();
+    CHECK(waited == 5);
+    // A pending wait is cancelled on stop requests
+    CHECK(sync_wait(when_any(
+      async_eventfd_read(scheduler, efd) | then([](std::uint64_t) { return false; }),
+      schedule_after(scheduler, 1ms) | then([] { return true; }))));
+  }
+
+  SECTION("signalfd") {
+    ::sigset_t signals{};
+    ::sigset_t old_signals{};
+    ::sigemptyset(&signals);
+    ::sigaddset(&signals, SIGUSR1);
+    REQUIRE(::pthread_sigmask(SIG_BLOCK, &signals, &old_signals) == 0);
+    scope_guard restore{[&]() noexcept {
+      ::pthread_sigmask(SIG_SETMASK, &old_signals, nullptr);
+    }};
+    safe_file_descriptor sfd{::signalfd(-1, &signals, SFD_CLOEXEC)};
+    REQUIRE(sfd);
+    io_uring_context context;
+    io_uring_scheduler scheduler = context.get_scheduler();
+    jthread io_thread{[&] {
+      context.run_until_stopped();
+    }};
+    scope_guard guard{[&]() noexcept {
+      context.request_stop();
+    }};
+    auto raise = [] {
+      ::kill(::getpid(), SIGUSR1);
+    };
+    auto [info] =
+      sync_wait(
+        when_all(async_wait_signal(scheduler, sfd), schedule_after(scheduler, 1ms) | then(raise)))
+        .value();
+    CHECK(info.ssi_signo == SIGUSR1);
+  }
+}
+
 #endif
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2023 Maikel Nadolski
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if __has_include(<linux/io_uring.h>)
+#include "exec/linux/io_uring_link.hpp"
+#include "exec/scope.hpp"
+#include "exec/when_any.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <sys/mman.h>
+
+using namespace stdexec;
+using namespace exec;
+using namespace std::chrono_literals;
+
+namespace {
+  safe_file_descriptor make_temporary_file() {
+    return safe_file_descriptor{::memfd_create("test_io_uring_link", 0)};
+  }
+
+  struct pipe_fds {
+    safe_file_descriptor read_end;
+    safe_file_descriptor write_end;
+  };
+
+  pipe_fds make_pipe() {
+    int fds[2];
+    REQUIRE(::pipe(fds) == 0);
+    return pipe_fds{safe_file_descriptor{fds[0]}, safe_file_descriptor{fds[1]}};
+  }
+
+  // Drives an io_uring_context on a separate thread for the lifetime of this object
+  struct io_thread {
+    io_uring_context& context;
+    std::thread thread{[this] {
+      context.run_until_stopped();
+    }};
+
+    ~io_thread() {
+      context.request_stop();
+      thread.join();
+    }
+  };
+
+  template <class Sender>
+  std::error_code error_of(Sender&& sender) {
+    try {
+      sync_wait((Sender&&) sender);
+    } catch (const std::system_error& error) {
+      return error.code();
+    }
+    return {};
+  }
+}
+
+TEST_CASE("io_uring_link write then read", "[types][io_uring][link]") {
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  io_thread thread{context};
+  safe_file_descriptor file = make_temporary_file();
+  REQUIRE(file);
+  const std::string message = "Hello, linked world!";
+  std::string buffer(message.size(), '\0');
+  auto [n_written, n_read] =
+    sync_wait(io_uring_link(
+                async_write(scheduler, file, std::as_bytes(std::span{message}), 0),
+                async_read(scheduler, file, std::as_writable_bytes(std::span{buffer}), 0)))
+      .value();
+  CHECK(n_written == message.size());
+  CHECK(n_read == message.size());
+  CHECK(buffer == message);
+}
+
+TEST_CASE("io_uring_link cancels successors of a failed operation", "[types][io_uring][link]") {
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  io_thread thread{context};
+  safe_file_descriptor file = make_temporary_file();
+  const std::string message = "abcd";
+  REQUIRE(::pwrite(file, message.data(), message.size(), 0) == 4);
+  std::string buffer(message.size(), '\0');
+  std::error_code ec = error_of(io_uring_link(
+    async_write(scheduler, -1, std::as_bytes(std::span{buffer})),
+    async_read(scheduler, file, std::as_writable_bytes(std::span{buffer}), 0)));
+  CHECK(ec == std::error_code(EBADF, std::system_category()));
+  CHECK(buffer != message);
+}
+
+TEST_CASE("io_uring_hardlink does not cancel successors", "[types][io_uring][link]") {
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  io_thread thread{context};
+  safe_file_descriptor file = make_temporary_file();
+  const std::string message = "abcd";
+  std::error_code ec = error_of(io_uring_hardlink(
+    async_write(scheduler, -1, std::as_bytes(std::span{message})),
+    async_write(scheduler, file, std::as_bytes(std::span{message}), 0)));
+  CHECK(ec == std::error_code(EBADF, std::system_category()));
+  std::string buffer(message.size(), '\0');
+  CHECK(::pread(file, buffer.data(), buffer.size(), 0) == 4);
+  CHECK(buffer == message);
+}
+
+TEST_CASE("io_uring_link that does not fit into the submission queue", "[types][io_uring][link]") {
+  io_uring_context context{io_uring_context_params{.entries = 2}};
+  io_uring_scheduler scheduler = context.get_scheduler();
+  io_thread thread{context};
+  REQUIRE(context.submission_queue_size() < 4);
+  safe_file_descriptor file = make_temporary_file();
+  std::array<std::byte, 4> buffer{};
+  auto read = [&] {
+    return async_read(scheduler, file, std::span{buffer});
+  };
+  std::error_code ec = error_of(io_uring_link(read(), read(), read(), read()));
+  CHECK(ec == std::errc::invalid_argument);
+  // The context keeps submitting other tasks
+  CHECK(sync_wait(read()));
+}
+
+TEST_CASE("io_uring_link_timeout times out an operation", "[types][io_uring][link]") {
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  io_thread thread{context};
+  pipe_fds pipe = make_pipe();
+  std::array<std::byte, 4> buffer{};
+  std::error_code ec = error_of(
+    io_uring_link_timeout(async_read(scheduler, pipe.read_end, std::span{buffer}), 1ms));
+  CHECK(ec == std::error_code(ETIMEDOUT, std::system_category()));
+}
+
+TEST_CASE("io_uring_link_timeout completes an operation in time", "[types][io_uring][link]") {
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  io_thread thread{context};
+  pipe_fds pipe = make_pipe();
+  std::array<std::byte, 4> buffer{};
+  auto [n_written, n_read] =
+    sync_wait(io_uring_link(
+                async_write(scheduler, pipe.write_end, std::span<const std::byte>{buffer}),
+                io_uring_link_timeout(async_read(scheduler, pipe.read_end, std::span{buffer}), 1s)))
+      .value();
+  CHECK(n_written == buffer.size());
+  CHECK(n_read == buffer.size());
+}
+
+TEST_CASE("io_uring_link is stopped with the receiver", "[types][io_uring][link]") {
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  io_thread thread{context};
+  pipe_fds pipe = make_pipe();
+  std::array<std::byte, 4> buffer{};
+  bool is_stopped = false;
+  sync_wait(when_any(
+    io_uring_link(
+      async_read(scheduler, pipe.read_end, std::span{buffer}),
+      async_read(scheduler, pipe.read_end, std::span{buffer}))
+      | then([](std::size_t, std::size_t) {}) | upon_stopped([&] { is_stopped = true; }),
+    schedule_after(scheduler, 1ms)));
+  CHECK(is_stopped);
+}
+
+TEST_CASE("io_uring_link on a stopped context", "[types][io_uring][link]") {
+  io_uring_context context;
+  io_uring_scheduler scheduler = context.get_scheduler();
+  context.request_stop();
+  context.run_until_stopped();
+  pipe_fds pipe = make_pipe();
+  std::array<std::byte, 4> buffer{};
+  bool is_stopped = false;
+  sync_wait(
+    io_uring_link(
+      async_read(scheduler, pipe.read_end, std::span{buffer}),
+      async_read(scheduler, pipe.read_end, std::span{buffer}))
+    | then([](std::size_t, std::size_t) {}) | upon_stopped([&] { is_stopped = true; }));
+  CHECK(is_stopped);
+}
+
+#endif
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2023 Maikel Nadolski
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if __has_include(<linux/io_uring.h>)
+#include "exec/linux/io_uring_pool.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <set>
+
+using namespace stdexec;
+using namespace exec;
+using namespace std::chrono_literals;
+
+TEST_CASE("io_uring_pool satisfies the scheduler concepts", "[types][io_uring][pool]") {
+  io_uring_pool pool{2};
+  io_uring_pool_scheduler scheduler = pool.get_scheduler();
+  STATIC_REQUIRE(timed_scheduler<io_uring_pool_scheduler>);
+  CHECK(scheduler == pool.get_scheduler());
+  CHECK(pool.size() == 2);
+}
+
+TEST_CASE("io_uring_pool runs work on its threads", "[types][io_uring][pool]") {
+  io_uring_pool pool{2};
+  io_uring_pool_scheduler scheduler = pool.get_scheduler();
+  auto [id] = sync_wait(schedule(scheduler) | then([] { return std::this_thread::get_id(); }))
+                .value();
+  CHECK(id != std::this_thread::get_id());
+  sync_wait(schedule_after(scheduler, 1ms));
+}
+
+TEST_CASE("io_uring_pool distributes work from outside threads", "[types][io_uring][pool]") {
+  io_uring_pool pool{4};
+  io_uring_pool_scheduler scheduler = pool.get_scheduler();
+  std::set<std::thread::id> ids;
+  for (std::size_t i = 0; i < pool.size(); ++i) {
+    auto [id] = sync_wait(schedule(scheduler) | then([] { return std::this_thread::get_id(); }))
+                  .value();
+    ids.insert(id);
+  }
+  CHECK(ids.size() == pool.size());
+}
+
+TEST_CASE("io_uring_pool keeps work on the local ring", "[types][io_uring][pool]") {
+  io_uring_pool pool{4};
+  io_uring_pool_scheduler scheduler = pool.get_scheduler();
+  auto [ids] = sync_wait(schedule(scheduler) | let_value([=] {
+                           std::thread::id outer = std::this_thread::get_id();
+                           return schedule(scheduler) | then([outer] {
+                                    return std::pair{outer, std::this_thread::get_id()};
+                                  });
+                         }))
+                 .value();
+  auto [outer, inner] = ids;
+  CHECK(outer == inner);
+}
+
+TEST_CASE("io_uring_pool with pinned threads and a shared work queue", "[types][io_uring][pool]") {
+  io_uring_pool pool{io_uring_pool_params{.n_threads = 2, .pin_threads = true, .attach_wq = true}};
+  io_uring_pool_scheduler scheduler = pool.get_scheduler();
+  std::array<std::byte, 4> buffer{};
+  int fds[2];
+  REQUIRE(::pipe(fds) == 0);
+  safe_file_descriptor read_end{fds[0]};
+  safe_file_descriptor write_end{fds[1]};
+  auto [n_written, n_read] =
+    sync_wait(when_all(
+                async_write(scheduler, write_end, std::span<const std::byte>{buffer}),
+                async_read(scheduler, read_end, std::span{buffer})))
+      .value();
+  CHECK(n_written == buffer.size());
+  CHECK(n_read == buffer.size());
+}
+
+TEST_CASE("io_uring_pool stops its rings", "[types][io_uring][pool]") {
+  io_uring_pool pool{2};
+  io_uring_pool_scheduler scheduler = pool.get_scheduler();
+  pool.request_stop();
+  bool is_stopped = false;
+  sync_wait(schedule(scheduler) | upon_stopped([&] { is_stopped = true; }));
+  CHECK(is_stopped);
+}
+
+#endif
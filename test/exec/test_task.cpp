@@ -23,7 +23,9 @@
 #include <exec/async_scope.hpp>
 
 #include <catch2/catch.hpp>
+#include "test_common/allocators.hpp"
 
+#include <optional>
 #include <thread>
 
 using namespace exec;
@@ -233,4 +235,159 @@ TEST_CASE("task - stop token is forwarded", "[types][task]") {
   CHECK(stdexec::sync_wait(scope.on_empty()));
 }
 
+namespace {
+  task<int> allocated_task(std::allocator_arg_t, counting_allocator<int>, int value) {
+    co_return value;
+  }
+
+  task<int> allocated_chain(std::allocator_arg_t, counting_allocator<int> alloc, int depth) {
+    if (depth == 0) {
+      co_return 0;
+    }
+    int value = co_await allocated_chain(std::allocator_arg, alloc, depth - 1);
+    co_return value + co_await allocated_task(std::allocator_arg, alloc, 1);
+  }
+
+  struct allocated_member {
+    int value;
+
+    task<int> get(std::allocator_arg_t, counting_allocator<int>) const {
+      co_return value;
+    }
+  };
+
+  task<int> pooled_chain(int depth) {
+    if (depth == 0) {
+      co_return 0;
+    }
+    co_return 1 + co_await pooled_chain(depth - 1);
+  }
+}
+
+namespace {
+  // Completes inline and counts the operations that have been scheduled on it
+  struct counting_scheduler {
+    int* n_scheduled;
+
+    template <class Receiver>
+    struct operation {
+      Receiver rcvr;
+      int* n_scheduled;
+
+      friend void tag_invoke(start_t, operation& self) noexcept {
+        ++*self.n_scheduled;
+        set_value((Receiver&&) self.rcvr);
+      }
+    };
+
+    struct env {
+      int* n_scheduled;
+
+      template <__one_of<set_value_t, set_error_t, set_stopped_t> Tag>
+      friend counting_scheduler
+        tag_invoke(get_completion_scheduler_t<Tag>, const env& self) noexcept {
+        return {self.n_scheduled};
+      }
+    };
+
+    struct sender {
+      using is_sender = void;
+      using completion_signatures = stdexec::completion_signatures<set_value_t()>;
+      int* n_scheduled;
+
+      template <class Receiver>
+      friend operation<Receiver> tag_invoke(connect_t, sender self, Receiver rcvr) {
+        return {(Receiver&&) rcvr, self.n_scheduled};
+      }
+
+      friend env tag_invoke(get_env_t, const sender& self) noexcept {
+        return {self.n_scheduled};
+      }
+    };
+
+    friend sender tag_invoke(schedule_t, counting_scheduler self) noexcept {
+      return {self.n_scheduled};
+    }
+
+    friend bool operator==(counting_scheduler, counting_scheduler) noexcept = default;
+  };
+
+  task<void> await_on_own_scheduler(counting_scheduler sched) {
+    co_await reschedule_coroutine_on(sched);
+    CHECK(*sched.n_scheduled == 1);
+    // Completes on the scheduler of the task, no transition back is needed
+    co_await schedule(sched);
+    CHECK(*sched.n_scheduled == 2);
+    co_await (schedule(sched) | then([] {}));
+    CHECK(*sched.n_scheduled == 3);
+    // The completion scheduler is unknown, the task transitions back onto its scheduler
+    co_await just();
+    CHECK(*sched.n_scheduled == 4);
+  }
+}
+
+TEST_CASE("task - no transition when a sender completes on the scheduler", "[types][task]") {
+  int n_scheduled = 0;
+  stdexec::sync_wait(await_on_own_scheduler(counting_scheduler{&n_scheduled}));
+  CHECK(n_scheduled == 4);
+}
+
+namespace {
+  task<void> await_let_value_on_other_context(auto scheduler1, auto scheduler2) {
+    co_await reschedule_coroutine_on(scheduler1);
+    CHECK(get_id() == 1);
+    // The sender reports the completion scheduler of its child, but completes in context2
+    co_await (schedule(scheduler1) | let_value([=] { return schedule(scheduler2); }));
+    CHECK(get_id() == 1);
+  }
+}
+
+TEST_CASE("task - transition when let_value completes on another scheduler", "[types][task]") {
+  single_thread_context context1;
+  single_thread_context context2;
+  scheduler auto scheduler1 = context1.get_scheduler();
+  scheduler auto scheduler2 = context2.get_scheduler();
+  sync_wait(when_all(
+    schedule(scheduler1) | then([] { __thread_id = 1; }),
+    schedule(scheduler2) | then([] { __thread_id = 2; })));
+  sync_wait(await_let_value_on_other_context(scheduler1, scheduler2));
+}
+
+TEST_CASE("task - frames are allocated with an allocator argument", "[types][task]") {
+  allocation_counts counts{};
+  auto chain = allocated_chain(std::allocator_arg, counting_allocator<int>{counts}, 8);
+  CHECK(counts.n_allocations == 1);
+  auto [value] = stdexec::sync_wait(std::move(chain)).value();
+  CHECK(value == 8);
+  CHECK(counts.n_allocations == 17);
+  CHECK(counts.n_deallocations == 17);
+
+  allocated_member object{42};
+  auto [member] =
+    stdexec::sync_wait(object.get(std::allocator_arg, counting_allocator<int>{counts})).value();
+  CHECK(member == 42);
+  CHECK(counts.n_allocations == 18);
+  CHECK(counts.n_deallocations == 18);
+}
+
+TEST_CASE("task - frames are recycled by the calling thread", "[types][task]") {
+  exec::__frame_pool pool;
+  void* frame = pool.__allocate(100);
+  pool.__deallocate(frame, 100);
+  CHECK(pool.__allocate(90) == frame);
+  pool.__deallocate(frame, 90);
+
+  auto [value] = stdexec::sync_wait(pooled_chain(100)).value();
+  CHECK(value == 100);
+}
+
+TEST_CASE("task - frames may outlive the pool of their thread", "[types][task]") {
+  std::thread thread{[] {
+    // Constructed before the pool of the thread, and thus destroyed after it
+    thread_local std::optional<task<int>> held{};
+    held.emplace(pooled_chain(1));
+  }};
+  thread.join();
+}
+
 #endif
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdexec/execution.hpp>
+
+#include <atomic>
+#include <memory>
+
+struct allocation_counts {
+  std::atomic<int> n_allocations{0};
+  std::atomic<int> n_deallocations{0};
+};
+
+//! Allocator that counts its allocations and deallocations
+template <class T>
+struct counting_allocator {
+  using value_type = T;
+  allocation_counts* counts;
+
+  explicit counting_allocator(allocation_counts& counts) noexcept
+    : counts{&counts} {
+  }
+
+  template <class U>
+  counting_allocator(const counting_allocator<U>& other) noexcept
+    : counts{other.counts} {
+  }
+
+  T* allocate(std::size_t n) {
+    ++counts->n_allocations;
+    return std::allocator<T>{}.allocate(n);
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    ++counts->n_deallocations;
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  friend bool operator==(const counting_allocator&, const counting_allocator&) = default;
+};
+
+//! Environment that provides a counting allocator
+struct counting_allocator_env {
+  allocation_counts* counts;
+
+  friend counting_allocator<std::byte>
+    tag_invoke(stdexec::get_allocator_t, const counting_allocator_env& self) noexcept {
+    return counting_allocator<std::byte>{*self.counts};
+  }
+};